@@ -0,0 +1,691 @@
+/*
+ * Throughput and latency benchmark of the PosCmd Client and Server over the simulated mesh.
+ *
+ * A client on element 0 drives a server on element 1. The server applies every target at once,
+ * and publishes its Status to the client. Every scenario runs the same number of position
+ * updates and reports, in simulated time, the updates completed per second and the latency
+ * percentiles, and the estimated bytes on air per update. The host time per update measures the
+ * CPU cost of the model code and the simulation together.
+ *
+ * Set:            acknowledged Sets, keeping the transaction window full. Latency is from the call
+ *                 to the first Status reporting the target.
+ * Set Unreliable: unacknowledged Sets at a fixed interval. Latency is from the call to the server
+ *                 applying the target.
+ *
+ * Updates not completed once the scenario stalls for STALL_TIMEOUT_US are reported as failed.
+ * Get:            one Get at a time. Latency is from the call to the Status.
+ *
+ * Mesh:           a client in the corner of a grid of nodes sends unreliable Sets to a group,
+ *                 which every other node subscribes to with a server publishing its Status to the
+ *                 client. Every node relays, and only hears its neighbours in the grid. Frames
+ *                 that overlap at a node collide. Latency is from the call to each server applying
+ *                 the target. Reports the share of the targets applied, the targets applied per
+ *                 second over all servers, the latency per hop, and the channel utilization: the
+ *                 time spent sending summed over the nodes, over the time the run took. Several
+ *                 runs with consecutive seeds can run in parallel, each in a process of its own as
+ *                 the models keep global state.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "nrf_mesh_assert.h"
+#include "host_mesh.h"
+#include "pos_cmd_client.h"
+#include "pos_cmd_server.h"
+
+#define UPDATES_MAX     (20000)
+#define CLIENT_ELEMENT  (0)
+#define SERVER_ELEMENT  (1)
+/** Group the servers of the mesh scenario subscribe to. */
+#define MESH_GROUP      (0xC000)
+/** Number of mesh runs that can be asked for. */
+#define MESH_RUNS_MAX   (64)
+/** Simulated time without a completed update before a scenario gives up on the rest, longer than
+ * an acknowledged transaction may take. */
+#define STALL_TIMEOUT_US (2 * POS_CMD_CLIENT_ACKED_TRANSACTION_TIMEOUT)
+
+typedef struct
+{
+    uint32_t updates;        /**< Updates to run. */
+    uint32_t interval_us;    /**< Interval between unreliable Sets. */
+    uint8_t repeats;         /**< Copies per unreliable Set. */
+    host_mesh_config_t mesh; /**< Simulation parameters. */
+    uint16_t nodes;          /**< Nodes of the mesh scenario, 0 to skip it. */
+    uint16_t width;          /**< Nodes per row of the grid. */
+    uint16_t runs;           /**< Mesh runs, one per seed. */
+    uint16_t jobs;           /**< Mesh runs at the same time. */
+} bench_config_t;
+
+typedef struct
+{
+    const char * p_name;
+    uint32_t completed;
+    uint32_t failed;
+    timestamp_t start;
+    timestamp_t end;
+    uint32_t latency_count;
+    uint32_t latencies[UPDATES_MAX];
+    uint64_t bytes_on_air;
+    double host_seconds;
+} bench_result_t;
+
+/** Outcome of one run of the mesh scenario. */
+typedef struct
+{
+    uint32_t seed;
+    uint32_t applied;
+    uint32_t expected;
+    double seconds;
+    double p50_ms;
+    double p90_ms;
+    double p99_ms;
+    double hop_ms;
+    double utilization;
+    uint32_t relayed;
+    uint32_t collisions;
+    double host_seconds;
+} mesh_result_t;
+
+static bench_config_t m_config;
+static pos_cmd_client_t m_client;
+static pos_cmd_server_t m_server;
+static struct position_t m_present;
+
+/** Time each update was issued, indexed by the x coordinate of its target. */
+static timestamp_t m_issued[UPDATES_MAX];
+/** Set once the update has completed. */
+static bool m_done[UPDATES_MAX];
+static uint32_t m_issued_count;
+/** Cleared while the scenario is torn down, so cancellations do not start new requests. */
+static bool m_running;
+static bench_result_t m_result;
+
+static pos_cmd_server_t m_servers[HOST_MESH_NODES_MAX];
+/** Last target applied by each server of the mesh scenario. */
+static int32_t m_applied[HOST_MESH_NODES_MAX];
+/** Latency of every target applied in the mesh scenario. */
+static uint32_t * mp_mesh_latencies;
+static uint32_t m_mesh_latency_count;
+
+/*****************************************************************************
+ * Model callbacks
+ *****************************************************************************/
+
+static struct position_t server_get_cb(const pos_cmd_server_t * p_self)
+{
+    return m_present;
+}
+
+static struct position_t server_set_cb(const pos_cmd_server_t * p_self, struct position_t target)
+{
+    m_present = target;
+    return m_present;
+}
+
+/** Completes an update the first time its target is reported. */
+static void update_complete(uint16_t index)
+{
+    if (index < m_issued_count && !m_done[index])
+    {
+        m_done[index] = true;
+        m_result.completed++;
+        m_result.latencies[m_result.latency_count++] = TIMER_DIFF(timer_now(), m_issued[index]);
+        m_result.end = timer_now();
+    }
+}
+
+static struct position_t server_set_unreliable_cb(const pos_cmd_server_t * p_self, struct position_t target)
+{
+    update_complete((uint16_t) target.x);
+    return server_set_cb(p_self, target);
+}
+
+static struct position_t server_set_mesh_cb(const pos_cmd_server_t * p_self, struct position_t target)
+{
+    uint32_t index = (uint32_t) (p_self - m_servers);
+    if (target.x > m_applied[index] && target.x < (int32_t) m_issued_count)
+    {
+        m_applied[index] = target.x;
+        mp_mesh_latencies[m_mesh_latency_count++] = TIMER_DIFF(timer_now(), m_issued[target.x]);
+        m_result.end = timer_now();
+    }
+    return target;
+}
+
+static void set_issue(void);
+
+static void set_status_cb(const pos_cmd_client_t * p_self,
+                          pos_cmd_status_t status,
+                          const struct position_t * p_present,
+                          uint16_t src)
+{
+    if (status == POS_CMD_STATUS_PRESENT)
+    {
+        /* The server applies the targets in order, a report of a later target completes the
+         * updates whose own Status was lost. */
+        for (int32_t i = 0; i <= p_present->x; ++i)
+        {
+            update_complete((uint16_t) i);
+        }
+    }
+    /* Refill the window, a transaction slot may have been freed. */
+    set_issue();
+}
+
+static void get_issue(void);
+
+static void get_status_cb(const pos_cmd_client_t * p_self,
+                          pos_cmd_status_t status,
+                          const struct position_t * p_present,
+                          uint16_t src)
+{
+    if (status == POS_CMD_STATUS_PRESENT)
+    {
+        update_complete((uint16_t) (m_issued_count - 1));
+    }
+    get_issue();
+}
+
+static void idle_status_cb(const pos_cmd_client_t * p_self,
+                           pos_cmd_status_t status,
+                           const struct position_t * p_present,
+                           uint16_t src)
+{
+}
+
+/*****************************************************************************
+ * Scenarios
+ *****************************************************************************/
+
+static void set_issue(void)
+{
+    while (m_running && m_issued_count < m_config.updates)
+    {
+        struct position_t target = {(int16_t) m_issued_count, 0};
+        m_issued[m_issued_count] = timer_now();
+        if (pos_cmd_client_set(&m_client, target) != NRF_SUCCESS)
+        {
+            /* Window full, continue from the next reply. */
+            return;
+        }
+        m_issued_count++;
+    }
+}
+
+static void get_issue(void)
+{
+    if (m_running && m_issued_count < m_config.updates)
+    {
+        m_issued[m_issued_count] = timer_now();
+        if (pos_cmd_client_get(&m_client) == NRF_SUCCESS)
+        {
+            m_issued_count++;
+        }
+    }
+}
+
+static void scenario_setup(pos_cmd_status_cb_t status_cb, pos_cmd_set_cb_t set_cb)
+{
+    host_mesh_reset(&m_config.mesh);
+
+    memset(&m_client, 0, sizeof(m_client));
+    m_client.status_cb = status_cb;
+    NRF_MESH_ASSERT(pos_cmd_client_init(&m_client, CLIENT_ELEMENT) == NRF_SUCCESS);
+
+    memset(&m_server, 0, sizeof(m_server));
+    m_server.get_cb = server_get_cb;
+    m_server.set_cb = set_cb;
+    NRF_MESH_ASSERT(pos_cmd_server_init(&m_server, SERVER_ELEMENT) == NRF_SUCCESS);
+
+    NRF_MESH_ASSERT(host_mesh_publish_address_set(m_client.model_handle,
+                                                  host_mesh_element_address_get(SERVER_ELEMENT)) == NRF_SUCCESS);
+    NRF_MESH_ASSERT(host_mesh_publish_address_set(m_server.model_handle,
+                                                  host_mesh_element_address_get(CLIENT_ELEMENT)) == NRF_SUCCESS);
+
+    /* Start from a known position, so the first update moves the server. */
+    m_present.x = -1;
+    m_present.y = -1;
+
+    memset(m_done, 0, sizeof(m_done));
+    m_issued_count = 0;
+    memset(&m_result, 0, sizeof(m_result));
+    m_result.start = timer_now();
+    m_result.end = m_result.start;
+}
+
+static void scenario_run(const char * p_name, void (*start)(void))
+{
+    struct timespec begin;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    m_result.p_name = p_name;
+    m_running = true;
+    start();
+
+    /* Run until every update has completed, or nothing has completed for a while. */
+    while (m_result.completed < m_config.updates &&
+           TIMER_DIFF(timer_now(), m_result.end) < STALL_TIMEOUT_US)
+    {
+        host_mesh_run_for(MS_TO_US(10));
+    }
+    m_result.failed = m_config.updates - m_result.completed;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    m_result.host_seconds = (double) (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    host_mesh_stats_t stats;
+    host_mesh_stats_get(&stats);
+    m_result.bytes_on_air = stats.bytes_on_air;
+
+    /* Release anything the model still holds, the next scenario starts from scratch. */
+    m_running = false;
+    pos_cmd_client_pending_msg_cancel(&m_client);
+}
+
+static void set_start(void)
+{
+    set_issue();
+}
+
+static void set_unreliable_start(void)
+{
+    for (uint32_t i = 0; i < m_config.updates; ++i)
+    {
+        struct position_t target = {(int16_t) i, 0};
+        m_issued[i] = timer_now();
+        m_issued_count = i + 1;
+        (void) pos_cmd_client_set_unreliable(&m_client, target, m_config.repeats);
+        host_mesh_run_for(m_config.interval_us);
+    }
+}
+
+static void get_start(void)
+{
+    get_issue();
+}
+
+static int latency_compare(const void * p_a, const void * p_b);
+
+static void mesh_link_add(uint16_t a, uint16_t b)
+{
+    NRF_MESH_ASSERT(host_mesh_link_set(a, b, m_config.mesh.loss_permille) == NRF_SUCCESS);
+    NRF_MESH_ASSERT(host_mesh_link_set(b, a, m_config.mesh.loss_permille) == NRF_SUCCESS);
+}
+
+static void mesh_setup(uint32_t seed)
+{
+    host_mesh_config_t config = m_config.mesh;
+    config.seed = seed;
+    host_mesh_reset(&config);
+
+    /* Every node hears the nodes next to it in the grid. */
+    host_mesh_topology_clear();
+    for (uint16_t i = 0; i < m_config.nodes; ++i)
+    {
+        if ((i + 1) % m_config.width != 0 && i + 1 < m_config.nodes)
+        {
+            mesh_link_add(i, i + 1);
+        }
+        if (i + m_config.width < m_config.nodes)
+        {
+            mesh_link_add(i, i + m_config.width);
+        }
+        NRF_MESH_ASSERT(host_mesh_relay_set(i, true) == NRF_SUCCESS);
+    }
+
+    memset(&m_client, 0, sizeof(m_client));
+    m_client.status_cb = idle_status_cb;
+    NRF_MESH_ASSERT(pos_cmd_client_init(&m_client, CLIENT_ELEMENT) == NRF_SUCCESS);
+    NRF_MESH_ASSERT(host_mesh_publish_address_set(m_client.model_handle, MESH_GROUP) == NRF_SUCCESS);
+
+    for (uint16_t i = 1; i < m_config.nodes; ++i)
+    {
+        pos_cmd_server_t * p_server = &m_servers[i];
+        memset(p_server, 0, sizeof(*p_server));
+        p_server->get_cb = server_get_cb;
+        p_server->set_cb = server_set_mesh_cb;
+        NRF_MESH_ASSERT(pos_cmd_server_init(p_server, i) == NRF_SUCCESS);
+        NRF_MESH_ASSERT(host_mesh_subscription_add(p_server->model_handle, MESH_GROUP) == NRF_SUCCESS);
+        NRF_MESH_ASSERT(host_mesh_publish_address_set(p_server->model_handle,
+                                                      host_mesh_element_address_get(CLIENT_ELEMENT)) == NRF_SUCCESS);
+        m_applied[i] = -1;
+    }
+
+    m_issued_count = 0;
+    m_mesh_latency_count = 0;
+    memset(&m_result, 0, sizeof(m_result));
+    m_result.start = timer_now();
+    m_result.end = m_result.start;
+}
+
+static double mesh_percentile_ms(uint32_t permille)
+{
+    if (m_mesh_latency_count == 0)
+    {
+        return 0.0;
+    }
+    uint32_t index = (uint32_t) (((uint64_t) (m_mesh_latency_count - 1) * permille + 500) / 1000);
+    return mp_mesh_latencies[index] / 1000.0;
+}
+
+static void mesh_run(uint32_t seed, mesh_result_t * p_result)
+{
+    struct timespec begin;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    mesh_setup(seed);
+    for (uint32_t i = 0; i < m_config.updates; ++i)
+    {
+        struct position_t target = {(int16_t) i, 0};
+        m_issued[i] = timer_now();
+        m_issued_count = i + 1;
+        (void) pos_cmd_client_set_unreliable(&m_client, target, m_config.repeats);
+        host_mesh_run_for(m_config.interval_us);
+    }
+
+    /* Let the last frames settle, the relays may still hold some. */
+    while (!host_mesh_idle() && TIMER_DIFF(timer_now(), m_result.end) < STALL_TIMEOUT_US)
+    {
+        host_mesh_run_for(MS_TO_US(10));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    host_mesh_stats_t stats;
+    host_mesh_stats_get(&stats);
+    qsort(mp_mesh_latencies, m_mesh_latency_count, sizeof(mp_mesh_latencies[0]), latency_compare);
+    if (stats.dropped > 0)
+    {
+        fprintf(stderr, "mesh run with seed %u: %u frames dropped, the simulation ran out of events\n",
+                seed, stats.dropped);
+    }
+
+    uint32_t elapsed = TIMER_DIFF(timer_now(), m_result.start);
+    memset(p_result, 0, sizeof(*p_result));
+    p_result->seed = seed;
+    p_result->applied = m_mesh_latency_count;
+    p_result->expected = m_config.updates * (m_config.nodes - 1);
+    p_result->seconds = elapsed / 1e6;
+    p_result->p50_ms = mesh_percentile_ms(500);
+    p_result->p90_ms = mesh_percentile_ms(900);
+    p_result->p99_ms = mesh_percentile_ms(990);
+    p_result->hop_ms = (stats.hops > 0) ? (double) stats.latency_us / stats.hops / 1000.0 : 0.0;
+    p_result->utilization = (elapsed > 0) ? (double) stats.airtime_us / elapsed : 0.0;
+    p_result->relayed = stats.relayed;
+    p_result->collisions = stats.collisions;
+    p_result->host_seconds = (double) (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    pos_cmd_client_pending_msg_cancel(&m_client);
+}
+
+/*****************************************************************************
+ * Reporting
+ *****************************************************************************/
+
+static int latency_compare(const void * p_a, const void * p_b)
+{
+    uint32_t a = *(const uint32_t *) p_a;
+    uint32_t b = *(const uint32_t *) p_b;
+    return (a > b) - (a < b);
+}
+
+static double percentile_ms(uint32_t permille)
+{
+    if (m_result.latency_count == 0)
+    {
+        return 0.0;
+    }
+    uint32_t index = (uint32_t) (((uint64_t) (m_result.latency_count - 1) * permille + 500) / 1000);
+    return m_result.latencies[index] / 1000.0;
+}
+
+static void result_print(void)
+{
+    qsort(m_result.latencies, m_result.latency_count, sizeof(m_result.latencies[0]), latency_compare);
+
+    double seconds = TIMER_DIFF(m_result.end, m_result.start) / 1e6;
+    printf("%-16s %8u %8u %10.1f %8.1f %8.1f %8.1f %10.1f %10.2f\n",
+           m_result.p_name,
+           m_result.completed,
+           m_result.failed,
+           (seconds > 0) ? m_result.completed / seconds : 0.0,
+           percentile_ms(500),
+           percentile_ms(900),
+           percentile_ms(990),
+           (m_result.completed > 0) ? (double) m_result.bytes_on_air / m_result.completed : 0.0,
+           (m_config.updates > 0) ? m_result.host_seconds * 1e6 / m_config.updates : 0.0);
+}
+
+static void mesh_result_print(const char * p_name, const mesh_result_t * p_result)
+{
+    printf("%-10s %10u %9.1f %10.1f %8.1f %8.1f %8.1f %8.2f %9.1f %9u %9u %8.2f\n",
+           p_name,
+           p_result->seed,
+           (p_result->expected > 0) ? 100.0 * p_result->applied / p_result->expected : 0.0,
+           (p_result->seconds > 0) ? p_result->applied / p_result->seconds : 0.0,
+           p_result->p50_ms,
+           p_result->p90_ms,
+           p_result->p99_ms,
+           p_result->hop_ms,
+           100.0 * p_result->utilization,
+           p_result->relayed,
+           p_result->collisions,
+           p_result->host_seconds);
+}
+
+/** Runs the mesh scenario once per seed, up to @c jobs runs at a time in child processes. */
+static void mesh_runs(mesh_result_t * p_results)
+{
+    if (m_config.jobs <= 1)
+    {
+        for (uint16_t i = 0; i < m_config.runs; ++i)
+        {
+            mesh_run(m_config.mesh.seed + i, &p_results[i]);
+        }
+        return;
+    }
+
+    for (uint16_t first = 0; first < m_config.runs; first += m_config.jobs)
+    {
+        int pipes[MESH_RUNS_MAX];
+        pid_t pids[MESH_RUNS_MAX];
+        uint16_t count = (m_config.runs - first < m_config.jobs) ? m_config.runs - first : m_config.jobs;
+
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            int fds[2];
+            NRF_MESH_ASSERT(pipe(fds) == 0);
+            fflush(stdout);
+            pids[i] = fork();
+            NRF_MESH_ASSERT(pids[i] >= 0);
+            if (pids[i] == 0)
+            {
+                mesh_result_t result;
+                close(fds[0]);
+                mesh_run(m_config.mesh.seed + first + i, &result);
+                _exit(write(fds[1], &result, sizeof(result)) == (ssize_t) sizeof(result) ? 0 : 1);
+            }
+            close(fds[1]);
+            pipes[i] = fds[0];
+        }
+
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            int status;
+            mesh_result_t * p_result = &p_results[first + i];
+            if (read(pipes[i], p_result, sizeof(*p_result)) != (ssize_t) sizeof(*p_result))
+            {
+                memset(p_result, 0, sizeof(*p_result));
+                p_result->seed = m_config.mesh.seed + first + i;
+                fprintf(stderr, "mesh run with seed %u failed\n", p_result->seed);
+            }
+            close(pipes[i]);
+            (void) waitpid(pids[i], &status, 0);
+        }
+    }
+}
+
+static void mesh_report(void)
+{
+    static mesh_result_t results[MESH_RUNS_MAX];
+    mesh_result_t mean;
+
+    printf("\nmesh: %u nodes, %u per row, relay delay %u us + up to %u us, TTL %u, collisions %s\n",
+           m_config.nodes, m_config.width, m_config.mesh.relay_delay_us, m_config.mesh.relay_jitter_us,
+           m_config.mesh.ttl, m_config.mesh.collisions ? "on" : "off");
+    printf("%-10s %10s %9s %10s %8s %8s %8s %8s %9s %9s %9s %8s\n",
+           "run", "seed", "applied %", "applied/s", "p50 ms", "p90 ms", "p99 ms", "ms/hop", "channel %",
+           "relayed", "collided", "host s");
+
+    mesh_runs(results);
+
+    memset(&mean, 0, sizeof(mean));
+    for (uint16_t i = 0; i < m_config.runs; ++i)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "mesh %u", i);
+        mesh_result_print(name, &results[i]);
+
+        mean.applied += results[i].applied;
+        mean.expected += results[i].expected;
+        mean.seconds += results[i].seconds;
+        mean.p50_ms += results[i].p50_ms / m_config.runs;
+        mean.p90_ms += results[i].p90_ms / m_config.runs;
+        mean.p99_ms += results[i].p99_ms / m_config.runs;
+        mean.hop_ms += results[i].hop_ms / m_config.runs;
+        mean.utilization += results[i].utilization / m_config.runs;
+        mean.relayed += results[i].relayed / m_config.runs;
+        mean.collisions += results[i].collisions / m_config.runs;
+        mean.host_seconds += results[i].host_seconds / m_config.runs;
+    }
+    if (m_config.runs > 1)
+    {
+        mean.seed = m_config.mesh.seed;
+        mesh_result_print("mean", &mean);
+    }
+}
+
+static void usage(const char * p_program)
+{
+    fprintf(stderr,
+            "usage: %s [-n updates] [-l loss_permille] [-d latency_us] [-r repeats] [-i interval_us] [-s seed]\n"
+            "       [-N mesh_nodes] [-w mesh_width] [-c collisions] [-D relay_delay_us] [-t ttl] [-R runs] [-j jobs]\n",
+            p_program);
+}
+
+int main(int argc, char ** argv)
+{
+    m_config.updates = 1000;
+    m_config.interval_us = MS_TO_US(20);
+    m_config.repeats = 3;
+    host_mesh_config_default(&m_config.mesh);
+    m_config.mesh.collisions = true;
+    m_config.nodes = 16;
+    m_config.runs = 1;
+    m_config.jobs = 1;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:l:d:r:i:s:N:w:c:D:t:R:j:h")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                m_config.updates = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'l':
+                m_config.mesh.loss_permille = (uint16_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                m_config.mesh.latency_us = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                m_config.repeats = (uint8_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'i':
+                m_config.interval_us = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                m_config.mesh.seed = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'N':
+                m_config.nodes = (uint16_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                m_config.width = (uint16_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                m_config.mesh.collisions = (strtoul(optarg, NULL, 0) != 0);
+                break;
+            case 'D':
+                m_config.mesh.relay_delay_us = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                m_config.mesh.ttl = (uint8_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'R':
+                m_config.runs = (uint16_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'j':
+                m_config.jobs = (uint16_t) strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (m_config.updates == 0 || m_config.updates > UPDATES_MAX ||
+        m_config.mesh.loss_permille > 1000 || m_config.repeats == 0 || m_config.mesh.seed == 0 ||
+        m_config.nodes == 1 || m_config.nodes > HOST_MESH_NODES_MAX || m_config.mesh.ttl == 0 ||
+        m_config.runs == 0 || m_config.runs > MESH_RUNS_MAX || m_config.jobs > MESH_RUNS_MAX)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (m_config.width == 0)
+    {
+        /* As square as it gets. */
+        while ((uint32_t) m_config.width * m_config.width < m_config.nodes)
+        {
+            m_config.width++;
+        }
+    }
+
+    printf("PosCmd host benchmark: %u updates, latency %u us, loss %u permille, %u repeats every %u us\n",
+           m_config.updates, m_config.mesh.latency_us, m_config.mesh.loss_permille,
+           m_config.repeats, m_config.interval_us);
+    printf("%-16s %8s %8s %10s %8s %8s %8s %10s %10s\n",
+           "scenario", "done", "failed", "updates/s", "p50 ms", "p90 ms", "p99 ms", "air B/upd", "host us/upd");
+
+    scenario_setup(set_status_cb, server_set_cb);
+    scenario_run("set", set_start);
+    result_print();
+
+    scenario_setup(idle_status_cb, server_set_unreliable_cb);
+    scenario_run("set_unreliable", set_unreliable_start);
+    result_print();
+
+    scenario_setup(get_status_cb, server_set_cb);
+    scenario_run("get", get_start);
+    result_print();
+
+    if (m_config.nodes > 0)
+    {
+        mp_mesh_latencies = malloc((size_t) m_config.updates * (m_config.nodes - 1) * sizeof(mp_mesh_latencies[0]));
+        NRF_MESH_ASSERT(mp_mesh_latencies != NULL);
+        mesh_report();
+        free(mp_mesh_latencies);
+    }
+
+    return 0;
+}
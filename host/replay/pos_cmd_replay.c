@@ -0,0 +1,459 @@
+/*
+ * Replays a PosCmd capture through the models on the host, and diffs what they send against the
+ * capture.
+ *
+ * The capture is memory mapped and walked in place with pos_cmd_capture_record_next. Every message
+ * the capturing node received is handed to a PosCmd Server and Client on the simulated mesh at its
+ * original time, or compressed by the speed factor. The models are built with capture enabled, so
+ * every message they send in reply is captured as on the node. The sent messages are then matched
+ * to those in the capture by opcode and transaction number, in order, and compared:
+ *
+ *   missing: sent on the node but not in the replay
+ *   extra:   sent in the replay but not on the node
+ *   payload: matched, with different parameters, e.g. another present position
+ *   timing:  offset from the start of the replay against that from the first record of the
+ *            capture, in simulated time
+ *
+ * Only captures of a server node can be replayed. The replayed client answers nothing and sends
+ * no requests of its own, so a capture with requests sent by a client node is rejected rather than
+ * reported as all missing.
+ *
+ * The application behind the replayed server reaches every target at once. Where the node's
+ * actuator was still moving, its Status messages report other positions than the replay.
+ *
+ * The replayed traffic, received and sent messages both, can be written to a new capture with -o.
+ * Replaying that capture reproduces it exactly.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nrf_mesh_assert.h"
+#include "host_mesh.h"
+#include "pos_cmd_capture.h"
+#include "pos_cmd_client.h"
+#include "pos_cmd_common.h"
+#include "pos_cmd_server.h"
+
+#if !POS_CMD_CAPTURE_ENABLED
+#error "The replay needs the models built with POS_CMD_CAPTURE_ENABLED."
+#endif
+
+/** Number of records searched ahead for the match of a sent message. */
+#define MATCH_WINDOW    (16)
+/** Time the replay runs on after the last received message, for held back publications. */
+#define DRAIN_TIME_US   (SEC_TO_US(2))
+#define SERVER_ELEMENT  (0)
+#define CLIENT_ELEMENT  (1)
+
+typedef struct
+{
+    uint32_t speed;           /**< Time compression factor. */
+    uint16_t publish_address; /**< Publish address of the replayed server. */
+    const char * p_output;    /**< File to write the replayed traffic to, or NULL. */
+    bool verbose;             /**< Print every difference. */
+} replay_config_t;
+
+/** Growing buffer of captured records. */
+typedef struct
+{
+    uint8_t * p_data;
+    size_t length;
+    size_t size;
+} replay_buffer_t;
+
+typedef struct
+{
+    uint32_t injected;
+    uint32_t skipped;
+    uint32_t matched;
+    uint32_t missing;
+    uint32_t extra;
+    uint32_t payload;
+    int64_t timing_sum;
+    int32_t timing_max;
+} replay_diff_t;
+
+static replay_config_t m_config;
+static replay_buffer_t m_replayed;
+static pos_cmd_server_t m_server;
+static pos_cmd_client_t m_client;
+static struct position_t m_present;
+static timestamp_t m_replay_start;
+
+/*****************************************************************************
+ * Model callbacks
+ *****************************************************************************/
+
+static struct position_t server_get_cb(const pos_cmd_server_t * p_self)
+{
+    return m_present;
+}
+
+static struct position_t server_set_cb(const pos_cmd_server_t * p_self, struct position_t target)
+{
+    m_present = target;
+    return m_present;
+}
+
+static void client_status_cb(const pos_cmd_client_t * p_self,
+                             pos_cmd_status_t status,
+                             const struct position_t * p_present,
+                             uint16_t src)
+{
+}
+
+static void capture_sink(const uint8_t * p_record, uint16_t length)
+{
+    if (m_replayed.length + length > m_replayed.size)
+    {
+        m_replayed.size = (m_replayed.size == 0) ? 4096 : 2 * m_replayed.size;
+        m_replayed.p_data = realloc(m_replayed.p_data, m_replayed.size);
+        NRF_MESH_ASSERT(m_replayed.p_data != NULL);
+    }
+    memcpy(&m_replayed.p_data[m_replayed.length], p_record, length);
+    m_replayed.length += length;
+}
+
+/*****************************************************************************
+ * Replay
+ *****************************************************************************/
+
+static void models_setup(void)
+{
+    host_mesh_config_t config;
+    host_mesh_config_default(&config);
+    host_mesh_reset(&config);
+
+    m_server.get_cb = server_get_cb;
+    m_server.set_cb = server_set_cb;
+    NRF_MESH_ASSERT(pos_cmd_server_init(&m_server, SERVER_ELEMENT) == NRF_SUCCESS);
+    if (m_config.publish_address != NRF_MESH_ADDR_UNASSIGNED)
+    {
+        NRF_MESH_ASSERT(host_mesh_publish_address_set(m_server.model_handle, m_config.publish_address) == NRF_SUCCESS);
+    }
+
+    /* Receives the Status messages of the server, if it publishes to the client element. */
+    m_client.status_cb = client_status_cb;
+    NRF_MESH_ASSERT(pos_cmd_client_init(&m_client, CLIENT_ELEMENT) == NRF_SUCCESS);
+}
+
+/** Feeds every received message of a capture to the models at its time, scaled by the speed factor. */
+static void replay_run(const uint8_t * p_capture, size_t length, replay_diff_t * p_diff)
+{
+    const uint8_t * p_cursor = p_capture;
+    const pos_cmd_capture_record_t * p_first = NULL;
+    const pos_cmd_capture_record_t * p_record;
+
+    m_replay_start = timer_now();
+    while ((p_record = pos_cmd_capture_record_next(&p_cursor, p_capture + length)) != NULL)
+    {
+        if (p_first == NULL)
+        {
+            p_first = p_record;
+        }
+
+        if (p_record->flags & POS_CMD_CAPTURE_FLAG_TX)
+        {
+            continue;
+        }
+        else if (p_record->flags & POS_CMD_CAPTURE_FLAG_TRUNCATED)
+        {
+            /* Part of the message is missing, the models would drop it for its length. */
+            p_diff->skipped++;
+            continue;
+        }
+
+        uint32_t offset = (p_record->timestamp - p_first->timestamp) / m_config.speed;
+        host_mesh_run_until(m_replay_start + offset);
+
+        access_opcode_t opcode = {p_record->opcode, POS_CMD_COMPANY_ID};
+        if (host_mesh_inject(p_record->src, p_record->dst, opcode, p_record->payload, p_record->length) == NRF_SUCCESS)
+        {
+            p_diff->injected++;
+        }
+        else
+        {
+            p_diff->skipped++;
+        }
+    }
+
+    host_mesh_run_for(DRAIN_TIME_US);
+}
+
+/** Lists the sent messages in a capture, with their time relative to @p origin. */
+static uint32_t sent_list(const uint8_t * p_capture,
+                          size_t length,
+                          timestamp_t origin,
+                          const pos_cmd_capture_record_t ** pp_records,
+                          uint32_t * p_offsets,
+                          uint32_t scale)
+{
+    const uint8_t * p_cursor = p_capture;
+    const pos_cmd_capture_record_t * p_record;
+    uint32_t count = 0;
+
+    while ((p_record = pos_cmd_capture_record_next(&p_cursor, p_capture + length)) != NULL)
+    {
+        if (p_record->flags & POS_CMD_CAPTURE_FLAG_TX)
+        {
+            pp_records[count] = p_record;
+            p_offsets[count] = (p_record->timestamp - origin) * scale;
+            count++;
+        }
+    }
+    return count;
+}
+
+static uint32_t record_count(const uint8_t * p_capture, size_t length)
+{
+    const uint8_t * p_cursor = p_capture;
+    uint32_t count = 0;
+    while (pos_cmd_capture_record_next(&p_cursor, p_capture + length) != NULL)
+    {
+        count++;
+    }
+    return count;
+}
+
+/** Checks whether a capture holds requests sent by the node, which only a client sends. */
+static bool capture_is_client(const uint8_t * p_capture, size_t length)
+{
+    const uint8_t * p_cursor = p_capture;
+    const pos_cmd_capture_record_t * p_record;
+    while ((p_record = pos_cmd_capture_record_next(&p_cursor, p_capture + length)) != NULL)
+    {
+        if ((p_record->flags & POS_CMD_CAPTURE_FLAG_TX) &&
+            p_record->opcode != POS_CMD_OPCODE_STATUS &&
+            p_record->opcode != POS_CMD_OPCODE_STATS_STATUS &&
+            p_record->opcode != POS_CMD_OPCODE_AXIS_STATUS &&
+            p_record->opcode != POS_CMD_OPCODE_PATH_ACK)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void record_print(const char * p_prefix, const pos_cmd_capture_record_t * p_record, uint32_t offset)
+{
+    printf("%s %10u us op 0x%02x tid %3u dst 0x%04x:", p_prefix, offset, p_record->opcode, p_record->tid, p_record->dst);
+    for (uint16_t i = 0; i < p_record->length; ++i)
+    {
+        printf(" %02x", p_record->payload[i]);
+    }
+    printf("\n");
+}
+
+/** Matches the sent messages of the replay to those of the capture, and compares them. */
+static void replay_diff(const uint8_t * p_capture, size_t length, replay_diff_t * p_diff)
+{
+    uint32_t captured_max = record_count(p_capture, length);
+    uint32_t replayed_max = record_count(m_replayed.p_data, m_replayed.length);
+    const pos_cmd_capture_record_t ** pp_captured = calloc(captured_max + 1, sizeof(*pp_captured));
+    const pos_cmd_capture_record_t ** pp_replayed = calloc(replayed_max + 1, sizeof(*pp_replayed));
+    uint32_t * p_captured_offsets = calloc(captured_max + 1, sizeof(uint32_t));
+    uint32_t * p_replayed_offsets = calloc(replayed_max + 1, sizeof(uint32_t));
+    NRF_MESH_ASSERT(pp_captured != NULL && pp_replayed != NULL &&
+                    p_captured_offsets != NULL && p_replayed_offsets != NULL);
+
+    /* The first record of the capture, received or sent, was replayed at the start of the replay. */
+    const uint8_t * p_cursor = p_capture;
+    const pos_cmd_capture_record_t * p_first = pos_cmd_capture_record_next(&p_cursor, p_capture + length);
+    NRF_MESH_ASSERT(p_first != NULL);
+    uint32_t captured = sent_list(p_capture, length, p_first->timestamp, pp_captured, p_captured_offsets, 1);
+    uint32_t replayed = sent_list(m_replayed.p_data, m_replayed.length, m_replay_start, pp_replayed,
+                                  p_replayed_offsets, m_config.speed);
+
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < captured; ++i)
+    {
+        const pos_cmd_capture_record_t * p_captured = pp_captured[i];
+
+        uint32_t match = replayed;
+        for (uint32_t k = j; k < replayed && k < j + MATCH_WINDOW; ++k)
+        {
+            if (pp_replayed[k]->opcode == p_captured->opcode && pp_replayed[k]->tid == p_captured->tid)
+            {
+                match = k;
+                break;
+            }
+        }
+
+        if (match == replayed)
+        {
+            p_diff->missing++;
+            if (m_config.verbose)
+            {
+                record_print("missing ", p_captured, p_captured_offsets[i]);
+            }
+            continue;
+        }
+
+        for (; j < match; ++j)
+        {
+            p_diff->extra++;
+            if (m_config.verbose)
+            {
+                record_print("extra   ", pp_replayed[j], p_replayed_offsets[j]);
+            }
+        }
+
+        const pos_cmd_capture_record_t * p_replayed = pp_replayed[j];
+        p_diff->matched++;
+        if (p_replayed->length != p_captured->length ||
+            memcmp(p_replayed->payload, p_captured->payload, p_captured->length) != 0)
+        {
+            p_diff->payload++;
+            if (m_config.verbose)
+            {
+                record_print("captured", p_captured, p_captured_offsets[i]);
+                record_print("replayed", p_replayed, p_replayed_offsets[j]);
+            }
+        }
+
+        int32_t timing = (int32_t) (p_replayed_offsets[j] - p_captured_offsets[i]);
+        int32_t magnitude = (timing < 0) ? -timing : timing;
+        p_diff->timing_sum += magnitude;
+        if (magnitude > p_diff->timing_max)
+        {
+            p_diff->timing_max = magnitude;
+        }
+        j++;
+    }
+
+    for (; j < replayed; ++j)
+    {
+        p_diff->extra++;
+        if (m_config.verbose)
+        {
+            record_print("extra   ", pp_replayed[j], p_replayed_offsets[j]);
+        }
+    }
+
+    free(pp_captured);
+    free(pp_replayed);
+    free(p_captured_offsets);
+    free(p_replayed_offsets);
+}
+
+/*****************************************************************************
+ * Main
+ *****************************************************************************/
+
+static void usage(const char * p_program)
+{
+    fprintf(stderr, "usage: %s [-x speed] [-p publish_address] [-o output] [-v] capture\n", p_program);
+}
+
+int main(int argc, char ** argv)
+{
+    m_config.speed = 1;
+    m_config.publish_address = NRF_MESH_ADDR_UNASSIGNED;
+
+    int option;
+    while ((option = getopt(argc, argv, "x:p:o:vh")) != -1)
+    {
+        switch (option)
+        {
+            case 'x':
+                m_config.speed = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                m_config.publish_address = (uint16_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                m_config.p_output = optarg;
+                break;
+            case 'v':
+                m_config.verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if (optind != argc - 1 || m_config.speed == 0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int fd = open(argv[optind], O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        perror(argv[optind]);
+        return 2;
+    }
+
+    size_t length = (size_t) info.st_size;
+    const uint8_t * p_capture = NULL;
+    if (length > 0)
+    {
+        p_capture = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p_capture == MAP_FAILED)
+        {
+            perror("mmap");
+            return 2;
+        }
+    }
+
+    if (length > 0 && capture_is_client(p_capture, length))
+    {
+        fprintf(stderr, "%s: requests sent by a client node, only server captures can be replayed\n",
+                argv[optind]);
+        munmap((void *) p_capture, length);
+        close(fd);
+        return 2;
+    }
+
+    models_setup();
+    pos_cmd_capture_sink_set(capture_sink);
+
+    replay_diff_t diff;
+    memset(&diff, 0, sizeof(diff));
+    if (length > 0)
+    {
+        replay_run(p_capture, length, &diff);
+    }
+    pos_cmd_capture_sink_set(NULL);
+
+    if (length > 0)
+    {
+        replay_diff(p_capture, length, &diff);
+    }
+
+    if (m_config.p_output != NULL)
+    {
+        FILE * p_file = fopen(m_config.p_output, "wb");
+        if (p_file == NULL || fwrite(m_replayed.p_data, 1, m_replayed.length, p_file) != m_replayed.length ||
+            fclose(p_file) != 0)
+        {
+            perror(m_config.p_output);
+            return 2;
+        }
+    }
+
+    printf("replayed %u messages at %ux, skipped %u\n", diff.injected, m_config.speed, diff.skipped);
+    printf("sent: %u matched, %u missing, %u extra, %u with other parameters\n",
+           diff.matched, diff.missing, diff.extra, diff.payload);
+    printf("timing: mean %.1f us, max %d us\n",
+           (diff.matched > 0) ? (double) diff.timing_sum / diff.matched : 0.0, diff.timing_max);
+
+    if (p_capture != NULL)
+    {
+        munmap((void *) p_capture, length);
+    }
+    close(fd);
+    free(m_replayed.p_data);
+    return (diff.missing == 0 && diff.extra == 0 && diff.payload == 0) ? 0 : 1;
+}
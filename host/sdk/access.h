@@ -0,0 +1,178 @@
+#ifndef ACCESS_H__
+#define ACCESS_H__
+
+/* Host stand-in for the mesh access layer API, implemented by host_mesh.c. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "nrf_mesh.h"
+
+/** Company ID of Nordic Semiconductor. */
+#define ACCESS_COMPANY_ID_NORDIC  (0x0059)
+/** Company ID of SIG models. */
+#define ACCESS_COMPANY_ID_NONE    (0xFFFF)
+
+/** Largest access message parameter length. */
+#define ACCESS_MESSAGE_LENGTH_MAX (380)
+
+/** Initializer of a vendor opcode. */
+#define ACCESS_OPCODE_VENDOR(opcode, company) {(opcode), (company)}
+
+/** Model handle. */
+typedef uint16_t access_model_handle_t;
+
+/** Device state manager handle. */
+typedef uint16_t dsm_handle_t;
+
+/** Invalid device state manager handle. */
+#define DSM_HANDLE_INVALID (0xFFFF)
+
+/** Access layer opcode. */
+typedef struct
+{
+    uint16_t opcode;     /**< Opcode. */
+    uint16_t company_id; /**< Company ID, @ref ACCESS_COMPANY_ID_NONE for SIG opcodes. */
+} access_opcode_t;
+
+/** Model ID. */
+typedef struct
+{
+    uint16_t model_id;   /**< Model ID. */
+    uint16_t company_id; /**< Company ID. */
+} access_model_id_t;
+
+/** Metadata of a received message. */
+typedef struct
+{
+    nrf_mesh_address_t src; /**< Source address. */
+    nrf_mesh_address_t dst; /**< Destination address. */
+    uint8_t ttl;            /**< Time to live. */
+} access_message_rx_meta_t;
+
+/** Received message. */
+typedef struct
+{
+    access_opcode_t opcode;             /**< Opcode. */
+    const uint8_t * p_data;             /**< Message parameters. */
+    uint16_t length;                    /**< Length of the parameters. */
+    access_message_rx_meta_t meta_data; /**< Message metadata. */
+} access_message_rx_t;
+
+/** Message to send. */
+typedef struct
+{
+    access_opcode_t opcode;                 /**< Opcode. */
+    const uint8_t * p_buffer;               /**< Message parameters. */
+    uint16_t length;                        /**< Length of the parameters. */
+    bool force_segmented;                   /**< Send segmented even if the message fits one PDU. */
+    nrf_mesh_transmic_size_t transmic_size; /**< Transport MIC size. */
+    nrf_mesh_tx_token_t access_token;       /**< TX token. */
+} access_message_tx_t;
+
+/**
+ * Opcode handler callback type.
+ *
+ * @param[in] handle    Model handle.
+ * @param[in] p_message Received message.
+ * @param[in] p_args    Arguments given when the model was added.
+ */
+typedef void (*access_opcode_handler_cb_t)(access_model_handle_t handle,
+                                           const access_message_rx_t * p_message,
+                                           void * p_args);
+
+/** Opcode handler. */
+typedef struct
+{
+    access_opcode_t opcode;             /**< Opcode handled. */
+    access_opcode_handler_cb_t handler; /**< Handler callback. */
+} access_opcode_handler_t;
+
+/**
+ * Publish timeout callback type.
+ *
+ * @param[in] handle Model handle.
+ * @param[in] p_args Arguments given when the model was added.
+ */
+typedef void (*access_publish_timeout_cb_t)(access_model_handle_t handle, void * p_args);
+
+/** Parameters of @ref access_model_add. */
+typedef struct
+{
+    access_model_id_t model_id;                  /**< Model ID. */
+    uint16_t element_index;                      /**< Element to add the model to. */
+    const access_opcode_handler_t * p_opcode_handlers; /**< Opcode handlers. */
+    uint32_t opcode_count;                       /**< Number of opcode handlers. */
+    void * p_args;                               /**< Arguments passed to the callbacks. */
+    access_publish_timeout_cb_t publish_timeout_cb; /**< Periodic publication callback, unused on the host. */
+} access_model_add_params_t;
+
+/**
+ * Adds a model to an element.
+ *
+ * @param[in]  p_init_params  Model parameters.
+ * @param[out] p_model_handle Handle of the added model.
+ *
+ * @retval NRF_SUCCESS         Model added.
+ * @retval NRF_ERROR_NULL      NULL pointer supplied to function.
+ * @retval NRF_ERROR_NO_MEM    No more models can be added.
+ * @retval NRF_ERROR_FORBIDDEN The element already holds a model with this ID.
+ */
+uint32_t access_model_add(const access_model_add_params_t * p_init_params,
+                          access_model_handle_t * p_model_handle);
+
+/**
+ * Publishes a message to the publish address of a model.
+ *
+ * @param[in] handle    Model handle.
+ * @param[in] p_message Message to publish.
+ *
+ * @retval NRF_SUCCESS              Message queued.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle.
+ * @retval NRF_ERROR_INVALID_PARAM  Publish address not set.
+ * @retval NRF_ERROR_INVALID_LENGTH Message larger than @ref ACCESS_MESSAGE_LENGTH_MAX.
+ * @retval NRF_ERROR_NO_MEM         TX queue full.
+ */
+uint32_t access_model_publish(access_model_handle_t handle, const access_message_tx_t * p_message);
+
+/**
+ * Replies to a received message.
+ *
+ * @param[in] handle    Model handle.
+ * @param[in] p_message Message replied to.
+ * @param[in] p_reply   Reply.
+ *
+ * @retval NRF_SUCCESS              Reply queued.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle.
+ * @retval NRF_ERROR_INVALID_LENGTH Message larger than @ref ACCESS_MESSAGE_LENGTH_MAX.
+ * @retval NRF_ERROR_NO_MEM         TX queue full.
+ */
+uint32_t access_model_reply(access_model_handle_t handle,
+                            const access_message_rx_t * p_message,
+                            const access_message_tx_t * p_reply);
+
+/**
+ * Allocates a subscription list for a model.
+ *
+ * @param[in] handle Model handle.
+ *
+ * @retval NRF_SUCCESS         List allocated.
+ * @retval NRF_ERROR_NOT_FOUND Invalid model handle.
+ */
+uint32_t access_model_subscription_list_alloc(access_model_handle_t handle);
+
+/**
+ * Gets the publish address of a model.
+ *
+ * @param[in]  handle           Model handle.
+ * @param[out] p_address_handle Device state manager handle of the publish address.
+ *
+ * @retval NRF_SUCCESS         Handle returned.
+ * @retval NRF_ERROR_NULL      NULL pointer supplied to function.
+ * @retval NRF_ERROR_NOT_FOUND Invalid model handle.
+ */
+uint32_t access_model_publish_address_get(access_model_handle_t handle, dsm_handle_t * p_address_handle);
+
+#endif /* ACCESS_H__ */
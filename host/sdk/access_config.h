@@ -0,0 +1,8 @@
+#ifndef ACCESS_CONFIG_H__
+#define ACCESS_CONFIG_H__
+
+/* Host stand-in, the model configuration is set through host_mesh.h instead. */
+
+#include "access.h"
+
+#endif /* ACCESS_CONFIG_H__ */
@@ -0,0 +1,19 @@
+#ifndef ACCESS_RELIABLE_H__
+#define ACCESS_RELIABLE_H__
+
+/*
+ * Host stand-in. The PosCmd Client runs its own transaction window and only uses the status
+ * values of the reliable transfer API.
+ */
+
+#include "access.h"
+
+/** Reliable transfer status. */
+typedef enum
+{
+    ACCESS_RELIABLE_TRANSFER_SUCCESS,   /**< Reply received. */
+    ACCESS_RELIABLE_TRANSFER_TIMEOUT,   /**< No reply before the timeout. */
+    ACCESS_RELIABLE_TRANSFER_CANCELLED  /**< Transfer cancelled. */
+} access_reliable_status_t;
+
+#endif /* ACCESS_RELIABLE_H__ */
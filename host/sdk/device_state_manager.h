@@ -0,0 +1,22 @@
+#ifndef DEVICE_STATE_MANAGER_H__
+#define DEVICE_STATE_MANAGER_H__
+
+/* Host stand-in for the device state manager, reduced to address lookup. */
+
+#include <stdint.h>
+#include "access.h"
+#include "nrf_mesh.h"
+
+/**
+ * Gets the address behind a device state manager handle.
+ *
+ * @param[in]  address_handle Handle.
+ * @param[out] p_address      Address.
+ *
+ * @retval NRF_SUCCESS         Address returned.
+ * @retval NRF_ERROR_NULL      NULL pointer supplied to function.
+ * @retval NRF_ERROR_NOT_FOUND Invalid handle.
+ */
+uint32_t dsm_address_get(dsm_handle_t address_handle, nrf_mesh_address_t * p_address);
+
+#endif /* DEVICE_STATE_MANAGER_H__ */
@@ -0,0 +1,29 @@
+#ifndef LOG_H__
+#define LOG_H__
+
+/* Host stand-in for the mesh logging module, printing to stdout up to HOST_LOG_LEVEL. */
+
+#include <stdio.h>
+
+#define LOG_SRC_APP (1 << 0)
+
+#define LOG_LEVEL_ASSERT (0)
+#define LOG_LEVEL_ERROR  (1)
+#define LOG_LEVEL_WARN   (2)
+#define LOG_LEVEL_REPORT (3)
+#define LOG_LEVEL_INFO   (4)
+#define LOG_LEVEL_DBG1   (5)
+
+#ifndef HOST_LOG_LEVEL
+#define HOST_LOG_LEVEL LOG_LEVEL_WARN
+#endif
+
+#define __LOG(source, level, ...)       \
+    do {                                \
+        if ((level) <= HOST_LOG_LEVEL)  \
+        {                               \
+            printf(__VA_ARGS__);        \
+        }                               \
+    } while (0)
+
+#endif /* LOG_H__ */
@@ -0,0 +1,73 @@
+#ifndef NRF_MESH_H__
+#define NRF_MESH_H__
+
+/* Host stand-in for the nRF5 SDK for Mesh core API, reduced to what the PosCmd models use. */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define NRF_SUCCESS                 (0)
+#define NRF_ERROR_INTERNAL          (3)
+#define NRF_ERROR_NO_MEM            (4)
+#define NRF_ERROR_NOT_FOUND         (5)
+#define NRF_ERROR_NOT_SUPPORTED     (6)
+#define NRF_ERROR_INVALID_PARAM     (7)
+#define NRF_ERROR_INVALID_STATE     (8)
+#define NRF_ERROR_INVALID_LENGTH    (9)
+#define NRF_ERROR_NULL              (14)
+#define NRF_ERROR_FORBIDDEN         (15)
+#define NRF_ERROR_INVALID_ADDR      (16)
+#define NRF_ERROR_BUSY              (17)
+
+#define NRF_MESH_ADDR_UNASSIGNED    (0x0000)
+
+#define SEC_TO_US(t) ((t) * 1000000)
+#define MS_TO_US(t)  ((t) * 1000)
+#define US_TO_MS(t)  ((t) / 1000)
+
+/** Size of the transport MIC. */
+typedef enum
+{
+    NRF_MESH_TRANSMIC_SIZE_SMALL,
+    NRF_MESH_TRANSMIC_SIZE_LARGE,
+    NRF_MESH_TRANSMIC_SIZE_DEFAULT,
+    NRF_MESH_TRANSMIC_SIZE_INVALID
+} nrf_mesh_transmic_size_t;
+
+/** Address types. */
+typedef enum
+{
+    NRF_MESH_ADDRESS_TYPE_INVALID,
+    NRF_MESH_ADDRESS_TYPE_UNICAST,
+    NRF_MESH_ADDRESS_TYPE_VIRTUAL,
+    NRF_MESH_ADDRESS_TYPE_GROUP
+} nrf_mesh_address_type_t;
+
+/** Mesh address. */
+typedef struct
+{
+    nrf_mesh_address_type_t type;   /**< Address type. */
+    uint16_t value;                 /**< Address value. */
+    const uint8_t * p_virtual_uuid; /**< Label UUID of a virtual address, unused on the host. */
+} nrf_mesh_address_t;
+
+/** TX token, identifies a message in TX complete events. */
+typedef uint32_t nrf_mesh_tx_token_t;
+
+/**
+ * Gets a unique TX token.
+ *
+ * @returns A token not returned before.
+ */
+nrf_mesh_tx_token_t nrf_mesh_unique_token_get(void);
+
+/**
+ * Gets the type of an address.
+ *
+ * @param[in] address Address value.
+ *
+ * @returns Type of the address.
+ */
+nrf_mesh_address_type_t nrf_mesh_address_type_get(uint16_t address);
+
+#endif /* NRF_MESH_H__ */
@@ -0,0 +1,20 @@
+#ifndef NRF_MESH_ASSERT_H__
+#define NRF_MESH_ASSERT_H__
+
+/* Host stand-in: failed assertions print their location and abort. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NRF_MESH_ASSERT(cond)                                                           \
+    do {                                                                                \
+        if (!(cond))                                                                    \
+        {                                                                               \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #cond); \
+            abort();                                                                    \
+        }                                                                               \
+    } while (0)
+
+#define NRF_MESH_STATIC_ASSERT(...) _Static_assert(__VA_ARGS__, #__VA_ARGS__)
+
+#endif /* NRF_MESH_ASSERT_H__ */
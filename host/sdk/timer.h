@@ -0,0 +1,25 @@
+#ifndef TIMER_H__
+#define TIMER_H__
+
+/* Host stand-in for the mesh timer, backed by the simulated clock of host_mesh.c. */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Timestamp in microseconds. */
+typedef uint32_t timestamp_t;
+
+/** Whether @p time is before @p ref, accounting for wraparound. */
+#define TIMER_OLDER_THAN(time, ref) (((uint32_t) (time)) - ((uint32_t) (ref)) > UINT32_MAX / 2)
+
+/** Time from @p ref to @p time, accounting for wraparound. */
+#define TIMER_DIFF(time, ref) (((uint32_t) (time)) - ((uint32_t) (ref)))
+
+/**
+ * Gets the current time.
+ *
+ * @returns The simulated time in microseconds.
+ */
+timestamp_t timer_now(void);
+
+#endif /* TIMER_H__ */
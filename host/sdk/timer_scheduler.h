@@ -0,0 +1,57 @@
+#ifndef TIMER_SCHEDULER_H__
+#define TIMER_SCHEDULER_H__
+
+/* Host stand-in for the mesh timer scheduler, driven by host_mesh_run_until(). */
+
+#include <stdint.h>
+#include "timer.h"
+
+/**
+ * Timer callback type.
+ *
+ * @param[in] timestamp Time the event was scheduled to fire at.
+ * @param[in] p_context Context of the event.
+ */
+typedef void (*timer_sch_callback_t)(timestamp_t timestamp, void * p_context);
+
+/** Timer event states. */
+typedef enum
+{
+    TIMER_EVENT_STATE_UNUSED, /**< Not scheduled. */
+    TIMER_EVENT_STATE_ADDED   /**< Scheduled. */
+} timer_event_state_t;
+
+/** Timer event. */
+typedef struct timer_event
+{
+    volatile timer_event_state_t state; /**< Scheduler state, do not modify. */
+    timestamp_t timestamp;              /**< Time to fire at. */
+    timer_sch_callback_t cb;            /**< Callback called when the event fires. */
+    uint32_t interval;                  /**< Period of a periodic event, 0 for a single shot. */
+    void * p_context;                   /**< Context passed to @c cb. */
+    struct timer_event * p_next;        /**< Next event in the schedule, do not modify. */
+} timer_event_t;
+
+/**
+ * Schedules an event at its timestamp. An event that is already scheduled is moved.
+ *
+ * @param[in,out] p_timer_evt Event.
+ */
+void timer_sch_schedule(timer_event_t * p_timer_evt);
+
+/**
+ * Aborts a scheduled event. Aborting an event that is not scheduled has no effect.
+ *
+ * @param[in,out] p_timer_evt Event.
+ */
+void timer_sch_abort(timer_event_t * p_timer_evt);
+
+/**
+ * Moves a scheduled event to a new timestamp.
+ *
+ * @param[in,out] p_timer_evt   Event.
+ * @param[in]     new_timestamp Time to fire at.
+ */
+void timer_sch_reschedule(timer_event_t * p_timer_evt, timestamp_t new_timestamp);
+
+#endif /* TIMER_SCHEDULER_H__ */
@@ -0,0 +1,14 @@
+#ifndef TOOLCHAIN_H__
+#define TOOLCHAIN_H__
+
+/*
+ * Host stand-in. The simulation runs every model, timer and opcode handler from one thread, so
+ * there are no interrupts to mask.
+ */
+
+#include <stdint.h>
+
+#define _DISABLE_IRQS(_was_masked) do { (_was_masked) = 0; } while (0)
+#define _ENABLE_IRQS(_was_masked)  do { (void) (_was_masked); } while (0)
+
+#endif /* TOOLCHAIN_H__ */
@@ -0,0 +1,1002 @@
+#include "host_mesh.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "access.h"
+#include "device_state_manager.h"
+#include "nrf_mesh.h"
+#include "nrf_mesh_assert.h"
+#include "timer.h"
+#include "timer_scheduler.h"
+
+/** Advertising packet overhead per PDU: preamble, access address, header, AdvA, AD header and CRC. */
+#define ADV_OVERHEAD   (1 + 4 + 2 + 6 + 2 + 3)
+/** Network PDU header: IVI/NID, CTL/TTL, SEQ, SRC and DST. */
+#define NET_HEADER     (1 + 1 + 3 + 2 + 2)
+/** Network MIC of an access message. */
+#define NET_MIC        (4)
+/** Transport MIC of an access message. */
+#define TRANS_MIC      (4)
+/** Largest upper transport PDU sent unsegmented. */
+#define UNSEGMENTED_MAX (15)
+/** Upper transport bytes per segment. */
+#define SEGMENT_SIZE   (12)
+
+/** No event, ends a node's event list. */
+#define EVENT_NONE     (0xFFFF)
+/** No message. */
+#define MESSAGE_NONE   (0xFFFF)
+/** Air time of one byte at 1 Mbit/s, in microseconds. */
+#define BYTE_US        (8)
+
+/*****************************************************************************
+ * Static variables
+ *****************************************************************************/
+
+typedef struct
+{
+    bool used;
+    uint16_t element_index;
+    access_model_id_t model_id;
+    const access_opcode_handler_t * p_opcode_handlers;
+    uint32_t opcode_count;
+    void * p_args;
+    uint16_t publish_address;
+    bool subscription_list;
+    uint16_t subscriptions[HOST_MESH_SUBSCRIPTIONS_MAX];
+    uint8_t subscription_count;
+} model_t;
+
+/** A message on air or waiting at a relay, shared by every frame that carries it. */
+typedef struct
+{
+    uint16_t references;
+    uint32_t sequence;
+    timestamp_t sent;
+    uint16_t src;
+    uint16_t dst;
+    access_model_handle_t sender;
+    uint32_t pdus;
+    uint32_t bytes;
+    uint32_t duration;
+    access_opcode_t opcode;
+    uint16_t length;
+    uint8_t data[ACCESS_MESSAGE_LENGTH_MAX];
+} message_t;
+
+typedef enum
+{
+    /** A frame arrives at the node. */
+    EVENT_RX,
+    /** The node's own message has gone out and frees its TX buffer. */
+    EVENT_TX_DONE,
+    /** The node sends a relayed frame. */
+    EVENT_RELAY,
+} event_type_t;
+
+typedef struct
+{
+    uint16_t next;
+    uint16_t message;
+    uint32_t sequence;
+    timestamp_t due;
+    uint16_t from;
+    uint8_t type;
+    uint8_t ttl;
+    uint8_t hops;
+    bool collided;
+} event_t;
+
+typedef struct
+{
+    bool relay;
+    uint8_t model_count;
+    access_model_handle_t models[HOST_MESH_NODE_MODELS_MAX];
+    /** Pending events in (due, sequence) order. */
+    uint16_t events;
+    /** Own messages waiting to be sent. */
+    uint16_t tx_pending;
+    /** Last frame to end arriving, and when it ends. */
+    uint16_t rx_last;
+    timestamp_t rx_end;
+    /** Frame being sent. */
+    timestamp_t tx_start;
+    timestamp_t tx_end;
+    /** Sequence numbers of the messages received, plus one so that 0 is free. */
+    uint32_t cache[HOST_MESH_NET_CACHE_SIZE];
+    uint8_t cache_next;
+} node_t;
+
+static host_mesh_config_t m_config;
+static host_mesh_stats_t m_stats;
+static model_t m_models[HOST_MESH_MODELS_MAX];
+static node_t m_nodes[HOST_MESH_NODES_MAX];
+static uint16_t m_node_count;
+static message_t m_messages[HOST_MESH_MESSAGES_MAX];
+static uint16_t m_messages_used;
+static event_t m_events[HOST_MESH_EVENTS_MAX];
+static uint16_t m_events_free;
+/** Loss of each link, valid once the topology has been changed from the full mesh. */
+static uint16_t m_links[HOST_MESH_NODES_MAX][HOST_MESH_NODES_MAX];
+static bool m_topology;
+static uint32_t m_sequence;
+static timer_event_t * mp_timers;
+static timestamp_t m_now;
+static uint32_t m_random;
+static nrf_mesh_tx_token_t m_token;
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+/** Signed time from now, so events scheduled in the past sort first. */
+static int32_t offset_get(timestamp_t timestamp)
+{
+    return (int32_t) (timestamp - m_now);
+}
+
+static uint32_t random_next(void)
+{
+    /* xorshift32 */
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 17;
+    m_random ^= m_random << 5;
+    return m_random;
+}
+
+static const model_t * model_get(access_model_handle_t handle)
+{
+    return (handle < HOST_MESH_MODELS_MAX && m_models[handle].used) ? &m_models[handle] : NULL;
+}
+
+/** Gets the number of network PDUs of a message and the bytes they take on air. */
+static uint32_t pdus_get(const access_message_tx_t * p_message, uint32_t * p_bytes)
+{
+    uint32_t opcode_length = (p_message->opcode.company_id != ACCESS_COMPANY_ID_NONE) ? 3 :
+                             (p_message->opcode.opcode < 0x80) ? 1 : 2;
+    uint32_t upper = opcode_length + p_message->length + TRANS_MIC;
+
+    if (upper <= UNSEGMENTED_MAX && !p_message->force_segmented)
+    {
+        *p_bytes = ADV_OVERHEAD + NET_HEADER + 1 + upper + NET_MIC;
+        return 1;
+    }
+
+    uint32_t segments = (upper + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+    *p_bytes = segments * (ADV_OVERHEAD + NET_HEADER + 4 + NET_MIC) + upper;
+    return segments;
+}
+
+static bool model_accepts(const model_t * p_model, uint16_t dst)
+{
+    if (dst == host_mesh_element_address_get(p_model->element_index))
+    {
+        return true;
+    }
+
+    for (uint8_t i = 0; i < p_model->subscription_count; ++i)
+    {
+        if (p_model->subscriptions[i] == dst)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void message_release(uint16_t index)
+{
+    NRF_MESH_ASSERT(m_messages[index].references > 0);
+    if (--m_messages[index].references == 0)
+    {
+        m_messages_used--;
+    }
+}
+
+static uint16_t link_get(uint16_t from, uint16_t to)
+{
+    return m_topology ? m_links[from][to] : m_config.loss_permille;
+}
+
+/** Schedules an event at a node, after the events due at the same time. */
+static uint16_t event_add(uint16_t node_index, event_type_t type, uint16_t message, timestamp_t due)
+{
+    if (m_events_free == EVENT_NONE)
+    {
+        m_stats.dropped++;
+        return EVENT_NONE;
+    }
+
+    uint16_t index = m_events_free;
+    event_t * p_event = &m_events[index];
+    m_events_free = p_event->next;
+
+    memset(p_event, 0, sizeof(*p_event));
+    p_event->type = type;
+    p_event->message = message;
+    p_event->sequence = m_sequence++;
+    p_event->due = due;
+    m_messages[message].references++;
+
+    uint16_t * p_next = &m_nodes[node_index].events;
+    while (*p_next != EVENT_NONE && offset_get(m_events[*p_next].due) <= offset_get(due))
+    {
+        p_next = &m_events[*p_next].next;
+    }
+    p_event->next = *p_next;
+    *p_next = index;
+    return index;
+}
+
+/** Checks whether a frame arriving at a node overlaps another frame there, and marks both lost. */
+static bool collision_check(node_t * p_node, timestamp_t start, timestamp_t end)
+{
+    bool collided = false;
+
+    /* A frame still arriving has not been handled yet, its event is valid. */
+    if (p_node->rx_last != EVENT_NONE && offset_get(p_node->rx_end) > offset_get(start))
+    {
+        m_events[p_node->rx_last].collided = true;
+        collided = true;
+    }
+    if (offset_get(p_node->tx_end) > offset_get(start) && offset_get(p_node->tx_start) < offset_get(end))
+    {
+        collided = true;
+    }
+    return collided;
+}
+
+static uint32_t airtime_get(const message_t * p_message)
+{
+    uint32_t airtime = p_message->bytes * BYTE_US;
+    return (airtime < p_message->duration) ? airtime : p_message->duration;
+}
+
+/**
+ * Puts a frame of a message on air at a node. Frames are on air for the last part of their
+ * delivery delay, and with collisions enabled a node sends them one after the other.
+ *
+ * @returns Time the frame has been received.
+ */
+static timestamp_t frame_start(uint16_t node_index, uint16_t message)
+{
+    const message_t * p_message = &m_messages[message];
+    node_t * p_sender = &m_nodes[node_index];
+    uint32_t airtime = airtime_get(p_message);
+    timestamp_t due = m_now + p_message->duration;
+
+    m_stats.pdus += p_message->pdus;
+    m_stats.bytes_on_air += p_message->bytes;
+    m_stats.airtime_us += airtime;
+
+    if (m_config.collisions)
+    {
+        if (offset_get(p_sender->tx_end) > offset_get(due - airtime))
+        {
+            due = p_sender->tx_end + airtime;
+        }
+
+        /* The radio is half duplex, sending spoils whatever it was receiving. */
+        if (p_sender->rx_last != EVENT_NONE && offset_get(p_sender->rx_end) > offset_get(due - airtime))
+        {
+            m_events[p_sender->rx_last].collided = true;
+        }
+        p_sender->tx_start = due - airtime;
+        p_sender->tx_end = due;
+    }
+    return due;
+}
+
+/** Hands a frame on air to every node the sender has a link to. */
+static void frame_send(uint16_t node_index, uint16_t message, timestamp_t due, uint8_t ttl, uint8_t hops)
+{
+    timestamp_t start = due - airtime_get(&m_messages[message]);
+
+    for (uint16_t i = 0; i < m_node_count; ++i)
+    {
+        node_t * p_node = &m_nodes[i];
+        if (i == node_index || link_get(node_index, i) == HOST_MESH_NO_LINK ||
+            (p_node->model_count == 0 && !p_node->relay))
+        {
+            continue;
+        }
+
+        uint16_t index = event_add(i, EVENT_RX, message, due);
+        if (index == EVENT_NONE)
+        {
+            continue;
+        }
+
+        event_t * p_event = &m_events[index];
+        p_event->from = node_index;
+        p_event->ttl = ttl;
+        p_event->hops = hops;
+        if (m_config.collisions)
+        {
+            p_event->collided = collision_check(p_node, start, due);
+            if (p_node->rx_last == EVENT_NONE || offset_get(due) >= offset_get(p_node->rx_end))
+            {
+                p_node->rx_last = index;
+                p_node->rx_end = due;
+            }
+        }
+    }
+}
+
+static uint32_t message_queue(access_model_handle_t handle, uint16_t dst, const access_message_tx_t * p_message)
+{
+    const model_t * p_model = model_get(handle);
+    if (p_message == NULL || (p_message->length > 0 && p_message->p_buffer == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (p_model == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    else if (p_message->length > ACCESS_MESSAGE_LENGTH_MAX)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    node_t * p_node = &m_nodes[p_model->element_index];
+    uint16_t message = MESSAGE_NONE;
+    for (uint16_t i = 0; i < HOST_MESH_MESSAGES_MAX && message == MESSAGE_NONE; ++i)
+    {
+        if (m_messages[i].references == 0)
+        {
+            message = i;
+        }
+    }
+
+    if (p_node->tx_pending >= m_config.tx_queue_size || message == MESSAGE_NONE || m_events_free == EVENT_NONE)
+    {
+        m_stats.rejected++;
+        return NRF_ERROR_NO_MEM;
+    }
+
+    message_t * p_slot = &m_messages[message];
+    p_slot->pdus = pdus_get(p_message, &p_slot->bytes);
+    p_slot->duration = m_config.latency_us + (p_slot->pdus - 1) * m_config.segment_us;
+    p_slot->sequence = m_sequence++;
+    p_slot->sent = m_now;
+    p_slot->src = host_mesh_element_address_get(p_model->element_index);
+    p_slot->dst = dst;
+    p_slot->sender = handle;
+    p_slot->opcode = p_message->opcode;
+    p_slot->length = p_message->length;
+    memcpy(p_slot->data, p_message->p_buffer, p_message->length);
+    m_messages_used++;
+
+    /* The TX buffer is freed first when the message is due, then the frames are handled. */
+    timestamp_t due = frame_start(p_model->element_index, message);
+    (void) event_add(p_model->element_index, EVENT_TX_DONE, message, due);
+    p_node->tx_pending++;
+
+    uint16_t loopback = event_add(p_model->element_index, EVENT_RX, message, due);
+    if (loopback != EVENT_NONE)
+    {
+        m_events[loopback].from = p_model->element_index;
+        m_events[loopback].ttl = m_config.ttl;
+    }
+
+    frame_send(p_model->element_index, message, due, m_config.ttl, 1);
+    m_stats.sent++;
+    return NRF_SUCCESS;
+}
+
+/**
+ * Calls the handler of a model for a message, if it has one.
+ *
+ * @returns @c true if the model has a handler for the opcode.
+ */
+static bool model_dispatch(access_model_handle_t handle, const message_t * p_message, uint8_t ttl)
+{
+    const model_t * p_model = &m_models[handle];
+    for (uint32_t i = 0; i < p_model->opcode_count; ++i)
+    {
+        const access_opcode_handler_t * p_handler = &p_model->p_opcode_handlers[i];
+        if (p_handler->opcode.opcode != p_message->opcode.opcode ||
+            p_handler->opcode.company_id != p_message->opcode.company_id)
+        {
+            continue;
+        }
+
+        access_message_rx_t rx;
+        rx.opcode = p_message->opcode;
+        rx.p_data = p_message->data;
+        rx.length = p_message->length;
+        rx.meta_data.src.type = NRF_MESH_ADDRESS_TYPE_UNICAST;
+        rx.meta_data.src.value = p_message->src;
+        rx.meta_data.src.p_virtual_uuid = NULL;
+        rx.meta_data.dst.type = nrf_mesh_address_type_get(p_message->dst);
+        rx.meta_data.dst.value = p_message->dst;
+        rx.meta_data.dst.p_virtual_uuid = NULL;
+        rx.meta_data.ttl = ttl;
+
+        p_handler->handler(handle, &rx, p_model->p_args);
+        return true;
+    }
+    return false;
+}
+
+static bool node_accepts(const node_t * p_node, const message_t * p_message)
+{
+    for (uint8_t i = 0; i < p_node->model_count; ++i)
+    {
+        access_model_handle_t handle = p_node->models[i];
+        if (handle != p_message->sender && model_accepts(&m_models[handle], p_message->dst))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool cache_add(node_t * p_node, uint32_t sequence)
+{
+    for (uint32_t i = 0; i < HOST_MESH_NET_CACHE_SIZE; ++i)
+    {
+        if (p_node->cache[i] == sequence + 1)
+        {
+            return false;
+        }
+    }
+    p_node->cache[p_node->cache_next] = sequence + 1;
+    p_node->cache_next = (p_node->cache_next + 1) % HOST_MESH_NET_CACHE_SIZE;
+    return true;
+}
+
+/** Handles a frame arriving at a node: loss, duplicates, delivery to its models and relaying. */
+static void frame_receive(uint16_t node_index, const event_t * p_event)
+{
+    node_t * p_node = &m_nodes[node_index];
+    const message_t * p_message = &m_messages[p_event->message];
+
+    if (p_event->from == node_index)
+    {
+        cache_add(p_node, p_message->sequence);
+        for (uint8_t i = 0; i < p_node->model_count; ++i)
+        {
+            access_model_handle_t handle = p_node->models[i];
+            if (handle != p_message->sender && model_accepts(&m_models[handle], p_message->dst) &&
+                model_dispatch(handle, p_message, p_event->ttl))
+            {
+                m_stats.delivered++;
+            }
+        }
+        return;
+    }
+
+    bool relay = (p_node->relay && p_event->ttl >= 2 &&
+                  p_message->dst != host_mesh_element_address_get(node_index));
+    if (!relay && !node_accepts(p_node, p_message))
+    {
+        return;
+    }
+
+    if (p_event->collided)
+    {
+        m_stats.collisions++;
+        return;
+    }
+    else if (random_next() % 1000 < link_get(p_event->from, node_index))
+    {
+        m_stats.lost++;
+        return;
+    }
+    else if (!cache_add(p_node, p_message->sequence))
+    {
+        m_stats.duplicates++;
+        return;
+    }
+
+    if (relay)
+    {
+        uint32_t delay = m_config.relay_delay_us +
+                         ((m_config.relay_jitter_us > 0) ? random_next() % (m_config.relay_jitter_us + 1) : 0);
+        uint16_t index = event_add(node_index, EVENT_RELAY, p_event->message, m_now + delay);
+        if (index != EVENT_NONE)
+        {
+            m_events[index].ttl = p_event->ttl - 1;
+            m_events[index].hops = p_event->hops + 1;
+        }
+    }
+
+    for (uint8_t i = 0; i < p_node->model_count; ++i)
+    {
+        access_model_handle_t handle = p_node->models[i];
+        if (handle != p_message->sender && model_accepts(&m_models[handle], p_message->dst) &&
+            model_dispatch(handle, p_message, p_event->ttl))
+        {
+            m_stats.delivered++;
+            m_stats.latency_us += TIMER_DIFF(m_now, p_message->sent);
+            m_stats.hops += p_event->hops;
+        }
+    }
+}
+
+/** Gets the node with the next event, in (due, sequence) order over all nodes. */
+static uint16_t node_next_get(void)
+{
+    uint16_t next = HOST_MESH_NODES_MAX;
+    for (uint16_t i = 0; i < m_node_count; ++i)
+    {
+        if (m_nodes[i].events == EVENT_NONE)
+        {
+            continue;
+        }
+
+        const event_t * p_event = &m_events[m_nodes[i].events];
+        if (next == HOST_MESH_NODES_MAX)
+        {
+            next = i;
+            continue;
+        }
+
+        const event_t * p_next = &m_events[m_nodes[next].events];
+        if (offset_get(p_event->due) < offset_get(p_next->due) ||
+            (p_event->due == p_next->due && (int32_t) (p_event->sequence - p_next->sequence) < 0))
+        {
+            next = i;
+        }
+    }
+    return next;
+}
+
+static void event_handle(uint16_t node_index)
+{
+    node_t * p_node = &m_nodes[node_index];
+    uint16_t index = p_node->events;
+
+    /* Copy out and free the event first, the handlers may send messages of their own. */
+    event_t event = m_events[index];
+    p_node->events = event.next;
+    m_events[index].next = m_events_free;
+    m_events_free = index;
+    if (p_node->rx_last == index)
+    {
+        p_node->rx_last = EVENT_NONE;
+    }
+
+    switch (event.type)
+    {
+        case EVENT_TX_DONE:
+            p_node->tx_pending--;
+            break;
+
+        case EVENT_RELAY:
+            m_stats.relayed++;
+            frame_send(node_index, event.message, frame_start(node_index, event.message), event.ttl, event.hops);
+            break;
+
+        case EVENT_RX:
+            frame_receive(node_index, &event);
+            break;
+
+        default:
+            NRF_MESH_ASSERT(false);
+            break;
+    }
+
+    message_release(event.message);
+}
+
+static void timer_insert(timer_event_t * p_timer_evt)
+{
+    timer_event_t ** pp_next = &mp_timers;
+    while (*pp_next != NULL && offset_get((*pp_next)->timestamp) <= offset_get(p_timer_evt->timestamp))
+    {
+        pp_next = &(*pp_next)->p_next;
+    }
+    p_timer_evt->p_next = *pp_next;
+    *pp_next = p_timer_evt;
+    p_timer_evt->state = TIMER_EVENT_STATE_ADDED;
+}
+
+static void timer_fire(timer_event_t * p_timer_evt)
+{
+    timestamp_t timestamp = p_timer_evt->timestamp;
+    timer_sch_abort(p_timer_evt);
+    if (p_timer_evt->interval > 0)
+    {
+        /* Reschedule before the callback, so the callback can abort a periodic event. */
+        p_timer_evt->timestamp += p_timer_evt->interval;
+        timer_insert(p_timer_evt);
+    }
+    p_timer_evt->cb(timestamp, p_timer_evt->p_context);
+}
+
+/*****************************************************************************
+ * SDK stand-in API
+ *****************************************************************************/
+
+timestamp_t timer_now(void)
+{
+    return m_now;
+}
+
+void timer_sch_schedule(timer_event_t * p_timer_evt)
+{
+    NRF_MESH_ASSERT(p_timer_evt != NULL && p_timer_evt->cb != NULL);
+    timer_sch_abort(p_timer_evt);
+    timer_insert(p_timer_evt);
+}
+
+void timer_sch_abort(timer_event_t * p_timer_evt)
+{
+    for (timer_event_t ** pp_next = &mp_timers; *pp_next != NULL; pp_next = &(*pp_next)->p_next)
+    {
+        if (*pp_next == p_timer_evt)
+        {
+            *pp_next = p_timer_evt->p_next;
+            break;
+        }
+    }
+    p_timer_evt->p_next = NULL;
+    p_timer_evt->state = TIMER_EVENT_STATE_UNUSED;
+}
+
+void timer_sch_reschedule(timer_event_t * p_timer_evt, timestamp_t new_timestamp)
+{
+    p_timer_evt->timestamp = new_timestamp;
+    timer_sch_schedule(p_timer_evt);
+}
+
+nrf_mesh_tx_token_t nrf_mesh_unique_token_get(void)
+{
+    return ++m_token;
+}
+
+nrf_mesh_address_type_t nrf_mesh_address_type_get(uint16_t address)
+{
+    if (address == NRF_MESH_ADDR_UNASSIGNED)
+    {
+        return NRF_MESH_ADDRESS_TYPE_INVALID;
+    }
+    else if (address < 0x8000)
+    {
+        return NRF_MESH_ADDRESS_TYPE_UNICAST;
+    }
+    else if (address < 0xC000)
+    {
+        return NRF_MESH_ADDRESS_TYPE_VIRTUAL;
+    }
+    return NRF_MESH_ADDRESS_TYPE_GROUP;
+}
+
+uint32_t access_model_add(const access_model_add_params_t * p_init_params,
+                          access_model_handle_t * p_model_handle)
+{
+    if (p_init_params == NULL || p_model_handle == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (p_init_params->element_index >= HOST_MESH_NODES_MAX)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    node_t * p_node = &m_nodes[p_init_params->element_index];
+    if (p_node->model_count == HOST_MESH_NODE_MODELS_MAX)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    for (access_model_handle_t handle = 0; handle < HOST_MESH_MODELS_MAX; ++handle)
+    {
+        const model_t * p_model = &m_models[handle];
+        if (p_model->used &&
+            p_model->element_index == p_init_params->element_index &&
+            p_model->model_id.model_id == p_init_params->model_id.model_id &&
+            p_model->model_id.company_id == p_init_params->model_id.company_id)
+        {
+            return NRF_ERROR_FORBIDDEN;
+        }
+    }
+
+    for (access_model_handle_t handle = 0; handle < HOST_MESH_MODELS_MAX; ++handle)
+    {
+        model_t * p_model = &m_models[handle];
+        if (!p_model->used)
+        {
+            memset(p_model, 0, sizeof(*p_model));
+            p_model->used = true;
+            p_model->element_index = p_init_params->element_index;
+            p_model->model_id = p_init_params->model_id;
+            p_model->p_opcode_handlers = p_init_params->p_opcode_handlers;
+            p_model->opcode_count = p_init_params->opcode_count;
+            p_model->p_args = p_init_params->p_args;
+            p_node->models[p_node->model_count++] = handle;
+            if (p_init_params->element_index >= m_node_count)
+            {
+                m_node_count = p_init_params->element_index + 1;
+            }
+            *p_model_handle = handle;
+            return NRF_SUCCESS;
+        }
+    }
+    return NRF_ERROR_NO_MEM;
+}
+
+uint32_t access_model_publish(access_model_handle_t handle, const access_message_tx_t * p_message)
+{
+    const model_t * p_model = model_get(handle);
+    if (p_model == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    else if (p_model->publish_address == NRF_MESH_ADDR_UNASSIGNED)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    return message_queue(handle, p_model->publish_address, p_message);
+}
+
+uint32_t access_model_reply(access_model_handle_t handle,
+                            const access_message_rx_t * p_message,
+                            const access_message_tx_t * p_reply)
+{
+    if (p_message == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    return message_queue(handle, p_message->meta_data.src.value, p_reply);
+}
+
+uint32_t access_model_subscription_list_alloc(access_model_handle_t handle)
+{
+    if (model_get(handle) == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    m_models[handle].subscription_list = true;
+    return NRF_SUCCESS;
+}
+
+uint32_t access_model_publish_address_get(access_model_handle_t handle, dsm_handle_t * p_address_handle)
+{
+    if (p_address_handle == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (model_get(handle) == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    /* Every model has its own publish address entry, named by the model handle. */
+    *p_address_handle = handle;
+    return NRF_SUCCESS;
+}
+
+uint32_t dsm_address_get(dsm_handle_t address_handle, nrf_mesh_address_t * p_address)
+{
+    if (p_address == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    const model_t * p_model = model_get(address_handle);
+    if (p_model == NULL || p_model->publish_address == NRF_MESH_ADDR_UNASSIGNED)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    p_address->type = nrf_mesh_address_type_get(p_model->publish_address);
+    p_address->value = p_model->publish_address;
+    p_address->p_virtual_uuid = NULL;
+    return NRF_SUCCESS;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void host_mesh_config_default(host_mesh_config_t * p_config)
+{
+    p_config->latency_us = MS_TO_US(10);
+    p_config->segment_us = 7500;
+    p_config->loss_permille = 0;
+    p_config->tx_queue_size = HOST_MESH_QUEUE_SIZE;
+    p_config->seed = 0x2545F491;
+    p_config->relay_delay_us = MS_TO_US(1);
+    p_config->relay_jitter_us = MS_TO_US(10);
+    p_config->ttl = 7;
+    p_config->collisions = false;
+}
+
+void host_mesh_reset(const host_mesh_config_t * p_config)
+{
+    NRF_MESH_ASSERT(p_config->tx_queue_size <= HOST_MESH_QUEUE_SIZE && p_config->seed != 0 && p_config->ttl > 0);
+
+    while (mp_timers != NULL)
+    {
+        timer_sch_abort(mp_timers);
+    }
+
+    m_config = *p_config;
+    memset(&m_stats, 0, sizeof(m_stats));
+    memset(m_models, 0, sizeof(m_models));
+    memset(m_messages, 0, sizeof(m_messages));
+    m_messages_used = 0;
+    memset(m_nodes, 0, sizeof(m_nodes));
+    for (uint16_t i = 0; i < HOST_MESH_NODES_MAX; ++i)
+    {
+        m_nodes[i].events = EVENT_NONE;
+        m_nodes[i].rx_last = EVENT_NONE;
+        m_nodes[i].rx_end = m_now;
+        m_nodes[i].tx_start = m_now;
+        m_nodes[i].tx_end = m_now;
+    }
+    m_node_count = 0;
+    for (uint16_t i = 0; i < HOST_MESH_EVENTS_MAX; ++i)
+    {
+        m_events[i].next = (i + 1 < HOST_MESH_EVENTS_MAX) ? i + 1 : EVENT_NONE;
+    }
+    m_events_free = 0;
+    m_topology = false;
+    m_random = p_config->seed;
+}
+
+uint16_t host_mesh_element_address_get(uint16_t element_index)
+{
+    return (uint16_t) (element_index + 1);
+}
+
+uint32_t host_mesh_publish_address_set(access_model_handle_t handle, uint16_t address)
+{
+    if (model_get(handle) == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    m_models[handle].publish_address = address;
+    return NRF_SUCCESS;
+}
+
+uint32_t host_mesh_subscription_add(access_model_handle_t handle, uint16_t address)
+{
+    if (model_get(handle) == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    model_t * p_model = &m_models[handle];
+    if (!p_model->subscription_list || p_model->subscription_count == HOST_MESH_SUBSCRIPTIONS_MAX)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    p_model->subscriptions[p_model->subscription_count++] = address;
+    return NRF_SUCCESS;
+}
+
+void host_mesh_topology_clear(void)
+{
+    memset(m_links, 0xFF, sizeof(m_links));
+    m_topology = true;
+}
+
+uint32_t host_mesh_link_set(uint16_t from, uint16_t to, uint16_t loss_permille)
+{
+    if (from >= HOST_MESH_NODES_MAX || to >= HOST_MESH_NODES_MAX || from == to)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (!m_topology)
+    {
+        /* Keep the full mesh the other links had so far. */
+        for (uint16_t i = 0; i < HOST_MESH_NODES_MAX; ++i)
+        {
+            for (uint16_t j = 0; j < HOST_MESH_NODES_MAX; ++j)
+            {
+                m_links[i][j] = m_config.loss_permille;
+            }
+        }
+        m_topology = true;
+    }
+    m_links[from][to] = loss_permille;
+    return NRF_SUCCESS;
+}
+
+uint32_t host_mesh_relay_set(uint16_t node_index, bool enabled)
+{
+    if (node_index >= HOST_MESH_NODES_MAX)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_nodes[node_index].relay = enabled;
+    if (node_index >= m_node_count)
+    {
+        m_node_count = node_index + 1;
+    }
+    return NRF_SUCCESS;
+}
+
+void host_mesh_run_until(timestamp_t until)
+{
+    for (;;)
+    {
+        uint16_t node_index = node_next_get();
+        const event_t * p_event = (node_index < HOST_MESH_NODES_MAX) ? &m_events[m_nodes[node_index].events] : NULL;
+        bool timer_first = (mp_timers != NULL &&
+                            (p_event == NULL || offset_get(mp_timers->timestamp) <= offset_get(p_event->due)));
+        timestamp_t next = timer_first ? mp_timers->timestamp :
+                           (p_event != NULL) ? p_event->due : until;
+
+        if ((mp_timers == NULL && p_event == NULL) || offset_get(next) > offset_get(until))
+        {
+            break;
+        }
+
+        if (offset_get(next) > 0)
+        {
+            m_now = next;
+        }
+
+        if (timer_first)
+        {
+            timer_fire(mp_timers);
+        }
+        else
+        {
+            event_handle(node_index);
+        }
+    }
+
+    if (offset_get(until) > 0)
+    {
+        m_now = until;
+    }
+}
+
+void host_mesh_run_for(uint32_t duration_us)
+{
+    host_mesh_run_until(m_now + duration_us);
+}
+
+bool host_mesh_idle(void)
+{
+    return (m_messages_used == 0);
+}
+
+uint32_t host_mesh_inject(uint16_t src,
+                          uint16_t dst,
+                          access_opcode_t opcode,
+                          const uint8_t * p_data,
+                          uint16_t length)
+{
+    if (length > ACCESS_MESSAGE_LENGTH_MAX)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    message_t message;
+    memset(&message, 0, sizeof(message));
+    message.sequence = m_sequence++;
+    message.sent = m_now;
+    message.src = src;
+    message.dst = dst;
+    message.sender = HOST_MESH_MODELS_MAX;
+    message.opcode = opcode;
+    message.length = length;
+    memcpy(message.data, p_data, length);
+
+    for (access_model_handle_t handle = 0; handle < HOST_MESH_MODELS_MAX; ++handle)
+    {
+        if (m_models[handle].used && model_dispatch(handle, &message, m_config.ttl))
+        {
+            m_stats.delivered++;
+        }
+    }
+    return NRF_SUCCESS;
+}
+
+void host_mesh_stats_get(host_mesh_stats_t * p_stats)
+{
+    *p_stats = m_stats;
+}
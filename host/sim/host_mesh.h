@@ -0,0 +1,223 @@
+#ifndef HOST_MESH_H__
+#define HOST_MESH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "access.h"
+#include "timer.h"
+
+/**
+ * @defgroup HOST_MESH Simulated mesh
+ * Host implementation of the access layer, device state manager and timer scheduler the PosCmd
+ * models are built against.
+ *
+ * Every element is a node of its own with unicast address <tt>element_index + 1</tt>. A message
+ * is delivered to every model, other than the sender, whose element has the destination address
+ * or which subscribes to it, and that has a handler for the opcode. Time only moves in
+ * @ref host_mesh_run_until, which fires timers and handles the frames due at each node in order.
+ *
+ * A node sends a message as one frame, heard by every node it has a link to after a fixed latency
+ * plus a per-segment delay. Each link loses a frame with its own probability. Until the topology
+ * is changed, every node has a link to every other node with the loss of the configuration, so a
+ * message takes one hop. A relay node sends on every new frame not addressed to it after a relay
+ * delay, with the TTL decremented, and every node drops copies of a message it has already
+ * received. With collisions enabled, a frame is lost at a node if it overlaps another frame
+ * arriving there, or a frame the node is sending.
+ *
+ * Models on the sender's element get the message over the loopback, after the same delay, and
+ * never lose it.
+ * @{
+ */
+
+/** Number of nodes, and of elements. */
+#define HOST_MESH_NODES_MAX (256)
+
+/** Number of models per node. */
+#define HOST_MESH_NODE_MODELS_MAX (4)
+
+/** Number of models that can be added. */
+#define HOST_MESH_MODELS_MAX (2 * HOST_MESH_NODES_MAX)
+
+/** Number of subscriptions per model. */
+#define HOST_MESH_SUBSCRIPTIONS_MAX (4)
+
+/** Number of messages a node can have waiting to be sent. */
+#define HOST_MESH_QUEUE_SIZE (64)
+
+/** Number of messages the simulation holds at the same time, on air or waiting at relays. */
+#define HOST_MESH_MESSAGES_MAX (1024)
+
+/** Number of frames pending at the nodes at the same time. */
+#define HOST_MESH_EVENTS_MAX (16384)
+
+/** Number of messages each node remembers to drop copies it has already received. */
+#define HOST_MESH_NET_CACHE_SIZE (32)
+
+/** Link loss of a pair of nodes that do not hear each other. */
+#define HOST_MESH_NO_LINK (0xFFFF)
+
+/** Simulation parameters. */
+typedef struct
+{
+    uint32_t latency_us;      /**< Delivery latency of an unsegmented message, in microseconds. */
+    uint32_t segment_us;      /**< Additional latency per segment after the first, in microseconds. */
+    uint16_t loss_permille;   /**< Probability that a frame is lost on a link of the full mesh, in 1/1000. */
+    uint16_t tx_queue_size;   /**< Messages waiting to be sent at a node before sends fail with @c NRF_ERROR_NO_MEM, at most @ref HOST_MESH_QUEUE_SIZE. */
+    uint32_t seed;            /**< Seed of the loss generator, not 0. */
+    uint32_t relay_delay_us;  /**< Time a relay holds a frame before sending it on, in microseconds. */
+    uint32_t relay_jitter_us; /**< Largest random delay added to @p relay_delay_us, in microseconds. */
+    uint8_t ttl;              /**< TTL of the messages sent, 1 to keep them from being relayed. */
+    bool collisions;          /**< Lose frames that overlap at a node. */
+} host_mesh_config_t;
+
+/** Traffic counters. */
+typedef struct
+{
+    uint32_t sent;         /**< Messages accepted by the access layer. */
+    uint32_t rejected;     /**< Messages rejected, e.g. for a full TX queue. */
+    uint32_t delivered;    /**< Copies handed to an opcode handler. */
+    uint32_t lost;         /**< Frames lost on a link. */
+    uint32_t collisions;   /**< Frames lost to a collision. */
+    uint32_t duplicates;   /**< Frames dropped by a node that had already received the message. */
+    uint32_t relayed;      /**< Frames sent on by a relay. */
+    uint32_t dropped;      /**< Frames dropped for lack of simulation memory. */
+    uint32_t pdus;         /**< Network PDUs sent, relayed ones included. */
+    uint64_t bytes_on_air; /**< Estimated bytes sent over the air, advertising overhead included. */
+    uint64_t airtime_us;   /**< Time spent sending, summed over the nodes, in microseconds. */
+    uint64_t latency_us;   /**< Time from send to delivery, summed over the copies delivered to another node. */
+    uint64_t hops;         /**< Hops taken, summed over the copies delivered to another node. */
+} host_mesh_stats_t;
+
+/**
+ * Gets the default simulation parameters: 10 ms latency, 7.5 ms per segment, no loss, a relay
+ * delay of 1 to 11 ms, TTL 7 and no collisions.
+ *
+ * @param[out] p_config Parameters.
+ */
+void host_mesh_config_default(host_mesh_config_t * p_config);
+
+/**
+ * Removes every model, timer and message in flight, restores the full mesh topology with no
+ * relays, and restarts the simulation.
+ *
+ * The simulated time keeps running, so timestamps held by the models stay in the past.
+ *
+ * @param[in] p_config Simulation parameters.
+ */
+void host_mesh_reset(const host_mesh_config_t * p_config);
+
+/**
+ * Gets the unicast address of an element.
+ *
+ * @param[in] element_index Element index.
+ *
+ * @returns Unicast address of the element.
+ */
+uint16_t host_mesh_element_address_get(uint16_t element_index);
+
+/**
+ * Sets the publish address of a model.
+ *
+ * @param[in] handle  Model handle.
+ * @param[in] address Publish address, @c NRF_MESH_ADDR_UNASSIGNED to disable publishing.
+ *
+ * @retval NRF_SUCCESS         Address set.
+ * @retval NRF_ERROR_NOT_FOUND Invalid model handle.
+ */
+uint32_t host_mesh_publish_address_set(access_model_handle_t handle, uint16_t address);
+
+/**
+ * Subscribes a model to a group address.
+ *
+ * @param[in] handle  Model handle.
+ * @param[in] address Group address.
+ *
+ * @retval NRF_SUCCESS         Subscription added.
+ * @retval NRF_ERROR_NOT_FOUND Invalid model handle.
+ * @retval NRF_ERROR_NO_MEM    No subscription list allocated, or the list is full.
+ */
+uint32_t host_mesh_subscription_add(access_model_handle_t handle, uint16_t address);
+
+/**
+ * Removes every link, so that no node hears another until links are added with
+ * @ref host_mesh_link_set.
+ */
+void host_mesh_topology_clear(void);
+
+/**
+ * Sets the link from one node to another. Links are one way.
+ *
+ * @param[in] from          Index of the sending node.
+ * @param[in] to            Index of the receiving node.
+ * @param[in] loss_permille Probability that a frame is lost on the link, in 1/1000, or
+ *                          @ref HOST_MESH_NO_LINK to remove the link.
+ *
+ * @retval NRF_SUCCESS             Link set.
+ * @retval NRF_ERROR_INVALID_PARAM A node index is out of range, or both are the same.
+ */
+uint32_t host_mesh_link_set(uint16_t from, uint16_t to, uint16_t loss_permille);
+
+/**
+ * Makes a node a relay, or stops it relaying.
+ *
+ * @param[in] node_index Index of the node.
+ * @param[in] enabled    Whether the node relays.
+ *
+ * @retval NRF_SUCCESS             Relay set.
+ * @retval NRF_ERROR_INVALID_PARAM The node index is out of range.
+ */
+uint32_t host_mesh_relay_set(uint16_t node_index, bool enabled);
+
+/**
+ * Fires every timer and delivers every message due up to a time, in order, and advances the
+ * simulated time to it.
+ *
+ * @param[in] until Time to run to.
+ */
+void host_mesh_run_until(timestamp_t until);
+
+/**
+ * Runs the simulation for a while.
+ *
+ * @param[in] duration_us Time to run, in microseconds.
+ */
+void host_mesh_run_for(uint32_t duration_us);
+
+/**
+ * Checks whether messages are in flight.
+ *
+ * @returns @c true if no message is waiting to be sent, on air or waiting at a relay.
+ */
+bool host_mesh_idle(void);
+
+/**
+ * Hands a message from outside the simulation to the models at once, as if they had received it.
+ *
+ * The message goes to every model with a handler for the opcode, whatever the destination, and is
+ * never lost. Use it to feed recorded traffic through the models.
+ *
+ * @param[in] src    Source address.
+ * @param[in] dst    Destination address.
+ * @param[in] opcode Opcode of the message.
+ * @param[in] p_data Message parameters.
+ * @param[in] length Length of @p p_data.
+ *
+ * @retval NRF_SUCCESS              Message handed to the models.
+ * @retval NRF_ERROR_INVALID_LENGTH The message is longer than @c ACCESS_MESSAGE_LENGTH_MAX.
+ */
+uint32_t host_mesh_inject(uint16_t src,
+                          uint16_t dst,
+                          access_opcode_t opcode,
+                          const uint8_t * p_data,
+                          uint16_t length);
+
+/**
+ * Gets the traffic counters since the last reset.
+ *
+ * @param[out] p_stats Counters.
+ */
+void host_mesh_stats_get(host_mesh_stats_t * p_stats);
+
+/** @} end of HOST_MESH */
+
+#endif /* HOST_MESH_H__ */
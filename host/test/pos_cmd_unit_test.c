@@ -0,0 +1,976 @@
+/*
+ * Unit tests of the PosCmd building blocks, and of the Client and Server over the simulated mesh.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "access.h"
+#include "nrf_mesh.h"
+#include "host_mesh.h"
+#include "pos_cmd_airtime.h"
+#include "pos_cmd_axis_server.h"
+#include "pos_cmd_client.h"
+#include "pos_cmd_codec.h"
+#include "pos_cmd_link.h"
+#include "pos_cmd_server.h"
+#include "pos_cmd_status_table.h"
+#include "pos_cmd_trajectory.h"
+#include "pos_cmd_typed_model.h"
+
+static uint32_t m_checks;
+static uint32_t m_failures;
+
+#define CHECK(cond)                                                                 \
+    do                                                                              \
+    {                                                                               \
+        m_checks++;                                                                 \
+        if (!(cond))                                                                \
+        {                                                                           \
+            m_failures++;                                                           \
+            printf("%s:%d: %s: check failed: %s\n", __FILE__, __LINE__, __func__, #cond); \
+        }                                                                           \
+    } while (0)
+
+/*****************************************************************************
+ * Codec
+ *****************************************************************************/
+
+static void test_codec(void)
+{
+    const struct position_t ref = {100, -100};
+    const struct position_t targets[] = {{100, -100}, {227, -228}, {-27, 27}, {103, -97}};
+    pos_cmd_delta_t deltas[4];
+    struct position_t decoded[4];
+
+    /* Exact round trip without quantization. */
+    CHECK(pos_cmd_codec_delta_encode(&ref, targets, 4, 0, deltas));
+    pos_cmd_codec_delta_decode(&ref, deltas, 4, 0, decoded);
+    CHECK(memcmp(decoded, targets, sizeof(targets)) == 0);
+
+    /* Out of range at shift 0, within half a step at shift 2. */
+    const struct position_t far = {100 + 300, -100 - 300};
+    CHECK(!pos_cmd_codec_delta_encode(&ref, &far, 1, 0, deltas));
+    CHECK(pos_cmd_codec_delta_encode(&ref, &far, 1, 2, deltas));
+    pos_cmd_codec_delta_decode(&ref, deltas, 1, 2, decoded);
+    CHECK(decoded[0].x == far.x && decoded[0].y == far.y);
+
+    /* Rounding is symmetric around the reference. */
+    const struct position_t odd[] = {{102, -102}};
+    CHECK(pos_cmd_codec_delta_encode(&ref, odd, 1, 2, deltas));
+    CHECK(deltas[0].dx == 1 && deltas[0].dy == -1);
+
+    /* Decoding saturates instead of wrapping. */
+    const struct position_t edge = {INT16_MAX - 10, INT16_MIN + 10};
+    const pos_cmd_delta_t out = {INT8_MAX, INT8_MIN};
+    pos_cmd_codec_delta_decode(&edge, &out, 1, POS_CMD_CODEC_SHIFT_MAX, decoded);
+    CHECK(decoded[0].x == INT16_MAX && decoded[0].y == INT16_MIN);
+}
+
+/*****************************************************************************
+ * Trajectory
+ *****************************************************************************/
+
+static void test_trajectory(void)
+{
+    const struct position_t start = {0, 0};
+    const struct position_t waypoints[] = {{100, 0}, {100, -100}};
+    pos_cmd_trajectory_t trajectory;
+    struct position_t setpoint;
+
+    pos_cmd_trajectory_start(&trajectory, start, waypoints, 2, 1000, 5000);
+    CHECK(trajectory.active);
+
+    CHECK(pos_cmd_trajectory_sample(&trajectory, 5000, &setpoint));
+    CHECK(setpoint.x == 0 && setpoint.y == 0);
+
+    CHECK(pos_cmd_trajectory_sample(&trajectory, 5500, &setpoint));
+    CHECK(setpoint.x == 50 && setpoint.y == 0);
+
+    /* Second leg, a quarter of the way. */
+    CHECK(pos_cmd_trajectory_sample(&trajectory, 6250, &setpoint));
+    CHECK(setpoint.x == 100 && setpoint.y == -25);
+
+    /* Sampling past the end lands on the last waypoint and ends the trajectory. */
+    CHECK(!pos_cmd_trajectory_sample(&trajectory, 9000, &setpoint));
+    CHECK(setpoint.x == 100 && setpoint.y == -100);
+    CHECK(!trajectory.active);
+}
+
+/*****************************************************************************
+ * Airtime
+ *****************************************************************************/
+
+static void test_airtime(void)
+{
+    /* 3 byte opcode, 8 parameters and the TransMIC fit in one PDU, 9 parameters or segmentation
+     * take two. */
+    CHECK(pos_cmd_airtime_cost(8, 3, false) == POS_CMD_AIRTIME_PDU_US);
+    CHECK(pos_cmd_airtime_cost(9, 3, false) == 2 * POS_CMD_AIRTIME_PDU_US);
+    CHECK(pos_cmd_airtime_cost(8, 3, true) == 2 * POS_CMD_AIRTIME_PDU_US);
+    CHECK(pos_cmd_airtime_cost(30, 3, false) == 4 * POS_CMD_AIRTIME_PDU_US);
+
+    pos_cmd_airtime_bucket_t bucket = {0};
+    const uint32_t depth = 10000;
+
+    /* 10 % of 50 ms. */
+    pos_cmd_airtime_refill(&bucket, 50000, 100, depth);
+    CHECK(bucket.tokens == 5000);
+    CHECK(pos_cmd_airtime_available(&bucket, 5000, depth));
+    CHECK(!pos_cmd_airtime_available(&bucket, 5001, depth));
+
+    /* The bucket never holds more than its depth. */
+    pos_cmd_airtime_refill(&bucket, 10050000, 100, depth);
+    CHECK(bucket.tokens == (int32_t) depth);
+
+    /* A message costing more than the depth is sent from a full bucket, and leaves a debt. */
+    CHECK(pos_cmd_airtime_available(&bucket, 3 * depth, depth));
+    pos_cmd_airtime_consume(&bucket, 3 * depth);
+    CHECK(bucket.tokens == -2 * (int32_t) depth);
+    CHECK(bucket.used == 3 * depth);
+
+    /* Repaying the debt and collecting 1000 us at 100 permille takes 210 ms. */
+    CHECK(pos_cmd_airtime_wait(&bucket, 1000, 100, depth) == 210000);
+    CHECK(pos_cmd_airtime_wait(&bucket, 1000, 0, depth) == 0);
+}
+
+/*****************************************************************************
+ * Link
+ *****************************************************************************/
+
+static void test_link(void)
+{
+    pos_cmd_link_table_t table;
+    memset(&table, 0, sizeof(table));
+    const uint16_t target = POS_CMD_LINK_DELIVERY_ONE / 10 * 9;
+    const uint16_t server = 0x0002;
+
+    pos_cmd_link_t * p_link = pos_cmd_link_get(&table, server, 4);
+    CHECK(p_link->address == server && p_link->repeats == 4);
+    CHECK(pos_cmd_link_get(&table, server, 4) == p_link);
+
+    /* Answered probes back off the repeat count. */
+    timestamp_t now = 0;
+    for (uint8_t tid = 0; tid < POS_CMD_LINK_BACKOFF_SAMPLES; ++tid)
+    {
+        pos_cmd_link_sent(p_link, tid, true, now, target, 4);
+        CHECK(p_link->probe_pending && p_link->probe_tid == tid);
+        pos_cmd_link_status_received(&table, server, tid, now + 1000, target, 4);
+        CHECK(!p_link->probe_pending);
+        now += 10000;
+    }
+    CHECK(p_link->repeats == 3);
+
+    /* A Status from another server does not answer a unicast probe. */
+    pos_cmd_link_sent(p_link, 100, true, now, target, 4);
+    pos_cmd_link_status_received(&table, 0x0003, 100, now + 1000, target, 4);
+    CHECK(p_link->probe_pending);
+
+    /* Nor does a Status for an earlier transaction. */
+    pos_cmd_link_status_received(&table, server, 99, now + 1000, target, 4);
+    CHECK(p_link->probe_pending);
+
+    /* A later Set reported by the server answers the probe. */
+    pos_cmd_link_status_received(&table, server, 102, now + 1000, target, 4);
+    CHECK(!p_link->probe_pending);
+    now += 10000;
+
+    /* Unanswered probes expire as lost and raise the repeat count again. */
+    for (uint8_t i = 0; i < POS_CMD_LINK_HOLD_SAMPLES + 2; ++i)
+    {
+        now += POS_CMD_LINK_PROBE_TIMEOUT;
+        pos_cmd_link_sent(p_link, (uint8_t) (101 + i), true, now, target, 4);
+    }
+    CHECK(p_link->repeats == 4);
+
+    /* The upper bound applies to an existing link. */
+    CHECK(pos_cmd_link_get(&table, server, 2)->repeats == 2);
+}
+
+/*****************************************************************************
+ * Status table
+ *****************************************************************************/
+
+static void test_status_table(void)
+{
+    static pos_cmd_status_table_t table;
+    pos_cmd_status_table_clear(&table);
+
+    /* Colliding addresses are probed into the next bucket. */
+    const uint16_t a = 0x0001;
+    const uint16_t b = (uint16_t) (a + POS_CMD_STATUS_TABLE_SIZE);
+    pos_cmd_status_entry_t * p_a = pos_cmd_status_table_add(&table, a);
+    pos_cmd_status_entry_t * p_b = pos_cmd_status_table_add(&table, b);
+    CHECK(p_a != NULL && p_b != NULL && p_a != p_b);
+    CHECK(pos_cmd_status_table_add(&table, a) == p_a);
+    CHECK(table.count == 2);
+    CHECK(pos_cmd_status_table_find(&table, b) == p_b);
+    CHECK(pos_cmd_status_table_find(&table, 0x0003) == NULL);
+    CHECK(pos_cmd_status_table_find(&table, NRF_MESH_ADDR_UNASSIGNED) == NULL);
+
+    /* Velocity from two reports 100 ms apart, predicted 50 ms ahead. */
+    pos_cmd_status_table_report(p_a, 1, (struct position_t) {0, 0}, 1000000);
+    pos_cmd_status_table_report(p_a, 2, (struct position_t) {100, -50}, 1100000);
+    CHECK(p_a->velocity_x == 1000 && p_a->velocity_y == -500);
+    struct position_t predicted = pos_cmd_status_table_predict(p_a, 1150000);
+    CHECK(predicted.x == 150 && predicted.y == -75);
+
+    /* A report right after the previous one keeps the velocity. */
+    pos_cmd_status_table_report(p_a, 2, (struct position_t) {101, -50}, 1101000);
+    CHECK(p_a->velocity_x == 1000);
+
+    /* Prediction saturates. */
+    predicted = pos_cmd_status_table_predict(p_a, 1101000 + SEC_TO_US(100));
+    CHECK(predicted.x == INT16_MAX && predicted.y == INT16_MIN);
+
+    /* a has reported TID 2 but confirmed no Set yet, b has not reported. */
+    uint16_t stragglers[2];
+    CHECK(pos_cmd_status_table_stragglers_get(&table, 2, NULL, NULL, 0) == 2);
+
+    /* a confirmed Set 2. */
+    pos_cmd_status_table_set_confirm(p_a, 2);
+    CHECK(pos_cmd_status_table_stragglers_get(&table, 2, NULL, stragglers, 2) == 1);
+    CHECK(stragglers[0] == b);
+    CHECK(pos_cmd_status_table_stragglers_get(&table, 3, NULL, NULL, 0) == 2);
+
+    /* A late confirmation of an older Set does not undo a newer one. */
+    pos_cmd_status_table_set_confirm(p_a, 1);
+    CHECK(p_a->set_tid == 2);
+
+    /* A server that applied a later Set has caught up, also across the wrap. */
+    CHECK(pos_cmd_status_table_stragglers_get(&table, 1, NULL, NULL, 0) == 1);
+    pos_cmd_status_table_report(p_b, 1, (struct position_t) {5, 5}, 1200000);
+    pos_cmd_status_table_set_confirm(p_b, 1);
+    CHECK(pos_cmd_status_table_stragglers_get(&table, 255, NULL, NULL, 0) == 0);
+    CHECK(pos_cmd_status_table_stragglers_get(&table, 2, NULL, stragglers, 2) == 1);
+    CHECK(stragglers[0] == b);
+
+    /* A newer report that confirms no Set of this client, such as a reply to a Get, does not
+     * count. */
+    pos_cmd_status_table_report(p_b, 9, (struct position_t) {5, 5}, 1300000);
+    CHECK(pos_cmd_status_table_stragglers_get(&table, 2, NULL, NULL, 0) == 1);
+
+    /* A server already at the target publishes no Status for the Set. */
+    const struct position_t target = {5, 5};
+    CHECK(pos_cmd_status_table_stragglers_get(&table, 2, &target, NULL, 0) == 0);
+    CHECK(pos_cmd_status_table_stragglers_get(&table, 3, &target, stragglers, 2) == 1);
+    CHECK(stragglers[0] == a);
+
+    /* Fill the table, then one more does not fit. */
+    for (uint16_t address = 0x0100; table.count < POS_CMD_STATUS_TABLE_SIZE; ++address)
+    {
+        CHECK(pos_cmd_status_table_add(&table, address) != NULL);
+    }
+    CHECK(pos_cmd_status_table_add(&table, 0x0200) == NULL);
+}
+
+/*****************************************************************************
+ * Client and Server
+ *****************************************************************************/
+
+static pos_cmd_client_t m_client;
+static pos_cmd_server_t m_server;
+static struct position_t m_present;
+static uint32_t m_set_count;
+static pos_cmd_status_t m_last_status;
+static struct position_t m_last_reported;
+static uint32_t m_status_count;
+
+static struct position_t server_get_cb(const pos_cmd_server_t * p_self)
+{
+    return m_present;
+}
+
+static struct position_t server_set_cb(const pos_cmd_server_t * p_self, struct position_t target)
+{
+    m_set_count++;
+    m_present = target;
+    return m_present;
+}
+
+static void client_status_cb(const pos_cmd_client_t * p_self,
+                             pos_cmd_status_t status,
+                             const struct position_t * p_present,
+                             uint16_t src)
+{
+    m_status_count++;
+    m_last_status = status;
+    if (p_present != NULL)
+    {
+        m_last_reported = *p_present;
+    }
+}
+
+/** Sets up a client on element 0 publishing to a server on element 1. */
+static void models_setup(uint16_t loss_permille)
+{
+    host_mesh_config_t config;
+    host_mesh_config_default(&config);
+    config.loss_permille = loss_permille;
+    host_mesh_reset(&config);
+
+    memset(&m_client, 0, sizeof(m_client));
+    m_client.status_cb = client_status_cb;
+    CHECK(pos_cmd_client_init(&m_client, 0) == NRF_SUCCESS);
+
+    memset(&m_server, 0, sizeof(m_server));
+    m_server.get_cb = server_get_cb;
+    m_server.set_cb = server_set_cb;
+    CHECK(pos_cmd_server_init(&m_server, 1) == NRF_SUCCESS);
+
+    CHECK(host_mesh_publish_address_set(m_client.model_handle, host_mesh_element_address_get(1)) == NRF_SUCCESS);
+
+    memset(&m_present, 0, sizeof(m_present));
+    m_set_count = 0;
+    m_status_count = 0;
+}
+
+static void models_teardown(void)
+{
+    pos_cmd_client_pending_msg_cancel(&m_client);
+}
+
+static void test_client_server(void)
+{
+    /* Acknowledged Set. */
+    models_setup(0);
+    CHECK(pos_cmd_client_set(&m_client, (struct position_t) {12, -34}) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == 1);
+    CHECK(m_present.x == 12 && m_present.y == -34);
+    CHECK(m_status_count == 1 && m_last_status == POS_CMD_STATUS_PRESENT);
+    CHECK(m_last_reported.x == 12 && m_last_reported.y == -34);
+
+    /* Get reports the present position. */
+    m_present.x = 7;
+    CHECK(pos_cmd_client_get(&m_client) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_status_count == 2 && m_last_reported.x == 7);
+    CHECK(host_mesh_idle());
+
+    /* Without a time base an absolute Set Scheduled is refused at once, not left to time out. */
+    CHECK(pos_cmd_client_set_scheduled(&m_client, (struct position_t) {99, 99}, 500, true) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_status_count == 3 && m_last_status == POS_CMD_STATUS_PRESENT && m_last_reported.x == 7);
+    CHECK(pos_cmd_client_stats_get(&m_client)->retransmissions == 0);
+    host_mesh_run_for(SEC_TO_US(1));
+    CHECK(m_set_count == 1);
+
+    /* A delay works without a time base. */
+    CHECK(pos_cmd_client_set_scheduled(&m_client, (struct position_t) {99, 99}, 500, false) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_status_count == 4 && m_set_count == 1);
+    host_mesh_run_for(MS_TO_US(500));
+    CHECK(m_set_count == 2 && m_present.x == 99);
+    models_teardown();
+
+    /* Nothing gets through: the transaction times out once. */
+    models_setup(1000);
+    CHECK(pos_cmd_client_set(&m_client, (struct position_t) {1, 1}) == NRF_SUCCESS);
+    host_mesh_run_for(POS_CMD_CLIENT_ACKED_TRANSACTION_TIMEOUT + SEC_TO_US(1));
+    CHECK(m_set_count == 0);
+    CHECK(m_status_count == 1 && m_last_status == POS_CMD_STATUS_ERROR_NO_REPLY);
+    models_teardown();
+}
+
+static pos_cmd_axis_server_t m_axis_server;
+static uint16_t m_axis_set_mask;
+static uint32_t m_axis_set_count;
+static uint16_t m_axis_status_mask;
+static int16_t m_axis_status[POS_CMD_AXES_MAX];
+static uint32_t m_axis_status_count;
+
+static void axis_set_cb(const pos_cmd_axis_server_t * p_self, uint16_t mask)
+{
+    m_axis_set_count++;
+    m_axis_set_mask = mask;
+}
+
+static void client_axis_status_cb(const pos_cmd_client_t * p_self,
+                                  uint16_t mask,
+                                  const int16_t * p_present,
+                                  uint16_t src)
+{
+    m_axis_status_count++;
+    m_axis_status_mask = mask;
+    memcpy(m_axis_status, p_present, sizeof(m_axis_status));
+}
+
+/** Injects an Axis message from @p src and returns the number of messages the server sent for it. */
+static uint32_t axis_inject(uint16_t src, uint16_t opcode, const void * p_data, uint16_t length)
+{
+    host_mesh_stats_t before;
+    host_mesh_stats_t after;
+    host_mesh_stats_get(&before);
+    CHECK(host_mesh_inject(src, host_mesh_element_address_get(1), (access_opcode_t) {opcode, POS_CMD_COMPANY_ID},
+                           p_data, length) == NRF_SUCCESS);
+    host_mesh_stats_get(&after);
+    return after.sent - before.sent;
+}
+
+static void test_axis_server(void)
+{
+    /* A client on element 0 and a four axis server on element 1. */
+    host_mesh_config_t config;
+    host_mesh_config_default(&config);
+    host_mesh_reset(&config);
+    memset(&m_client, 0, sizeof(m_client));
+    m_client.status_cb = client_status_cb;
+    m_client.axis_status_cb = client_axis_status_cb;
+    CHECK(pos_cmd_client_init(&m_client, 0) == NRF_SUCCESS);
+    CHECK(host_mesh_publish_address_set(m_client.model_handle, host_mesh_element_address_get(1)) == NRF_SUCCESS);
+    memset(&m_axis_server, 0, sizeof(m_axis_server));
+    m_axis_server.axis_count = 4;
+    m_axis_server.set_cb = axis_set_cb;
+    m_axis_server.deadband = 5;
+    CHECK(pos_cmd_axis_server_init(&m_axis_server, 1) == NRF_SUCCESS);
+    m_axis_set_count = 0;
+    m_axis_status_count = 0;
+
+    /* The targets of the selected axes are unpacked in order of axis index. */
+    const int16_t targets[POS_CMD_AXES_MAX] = {-1, 10, -1, 30};
+    CHECK(pos_cmd_client_axis_set(&m_client, 0x000A, targets) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_axis_set_count == 1 && m_axis_set_mask == 0x000A);
+    CHECK(pos_cmd_axis_server_target_get(&m_axis_server, 0) == 0);
+    CHECK(pos_cmd_axis_server_target_get(&m_axis_server, 1) == 10);
+    CHECK(pos_cmd_axis_server_target_get(&m_axis_server, 2) == 0);
+    CHECK(pos_cmd_axis_server_target_get(&m_axis_server, 3) == 30);
+    CHECK(m_axis_status_count == 1 && m_axis_status_mask == 0x000A);
+
+    struct __attribute((packed))
+    {
+        pos_cmd_msg_axis_set_t header;
+        int16_t targets[2];
+    } set = {{7, 0x0006}, {70, 80}};
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_SET_UNRELIABLE, &set, sizeof(set)) == 0);
+    CHECK(m_axis_set_count == 2 && m_axis_set_mask == 0x0006);
+    CHECK(pos_cmd_axis_server_target_get(&m_axis_server, 1) == 70);
+    CHECK(pos_cmd_axis_server_target_get(&m_axis_server, 2) == 80);
+    CHECK(pos_cmd_axis_server_target_get(&m_axis_server, 3) == 30);
+
+    /* The present positions are packed in order of axis index. */
+    for (uint8_t i = 0; i < 4; ++i)
+    {
+        pos_cmd_axis_server_present_update(&m_axis_server, i, (int16_t) (100 + i), 0);
+    }
+    CHECK(pos_cmd_client_axis_get(&m_client, 0x000D) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_axis_status_count == 2 && m_axis_status_mask == 0x000D);
+    CHECK(m_axis_status[0] == 100 && m_axis_status[2] == 102 && m_axis_status[3] == 103);
+
+    /* Empty masks, axes the server does not have, and lengths that do not match the mask are
+     * dropped without a reply. */
+    set.header.tid = 8;
+    set.header.mask = 0;
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_SET, &set, sizeof(pos_cmd_msg_axis_set_t)) == 0);
+    set.header.mask = 0x0011;
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_SET, &set, sizeof(set)) == 0);
+    set.header.mask = 0x0006;
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_SET, &set, sizeof(set) - sizeof(int16_t)) == 0);
+    set.header.mask = 0x0001;
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_SET, &set, sizeof(set)) == 0);
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_SET, &set, 2) == 0);
+    CHECK(m_axis_set_count == 2);
+    pos_cmd_msg_axis_get_t get = {9, 0x0010};
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_GET, &get, sizeof(get)) == 0);
+    get.mask = 0x0001;
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_GET, &get, sizeof(get) - 1) == 0);
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_GET, &get, sizeof(get)) == 1);
+
+    /* A repeated Axis Set is answered but not applied again, a repeated unreliable one is dropped. */
+    set.header.tid = 10;
+    set.header.mask = 0x0003;
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_SET, &set, sizeof(set)) == 1);
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_SET, &set, sizeof(set)) == 1);
+    CHECK(m_axis_set_count == 3);
+    CHECK(axis_inject(0x0100, POS_CMD_OPCODE_AXIS_SET_UNRELIABLE, &set, sizeof(set)) == 0);
+    CHECK(m_axis_set_count == 3);
+    CHECK(pos_cmd_axis_server_stats_get(&m_axis_server)->duplicates == 2);
+
+    /* The same TID from another client is applied. */
+    CHECK(axis_inject(0x0101, POS_CMD_OPCODE_AXIS_SET_UNRELIABLE, &set, sizeof(set)) == 0);
+    CHECK(m_axis_set_count == 4);
+
+    /* A publication reports every axis that moved past the deadband, and only those. */
+    CHECK(host_mesh_publish_address_set(m_axis_server.model_handle, host_mesh_element_address_get(0)) == NRF_SUCCESS);
+    CHECK(pos_cmd_axis_server_status_publish(&m_axis_server) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_axis_status_count == 3 && m_axis_status_mask == 0x000F);
+    CHECK(m_axis_status[1] == 101);
+
+    pos_cmd_axis_server_present_update(&m_axis_server, 1, 104, 0);
+    pos_cmd_axis_server_present_update(&m_axis_server, 3, 93, 0);
+    CHECK(pos_cmd_axis_server_status_publish(&m_axis_server) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_axis_status_count == 4 && m_axis_status_mask == 0x0008 && m_axis_status[3] == 93);
+
+    /* Nothing moved, nothing is published. */
+    CHECK(pos_cmd_axis_server_status_publish(&m_axis_server) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_axis_status_count == 4);
+
+    models_teardown();
+}
+
+typedef struct __attribute((packed))
+{
+    int16_t angle[3];
+} test_pose_t;
+
+POS_CMD_TYPED_MODEL_DECLARE(test_pose, test_pose_t);
+POS_CMD_TYPED_MODEL_DEFINE(test_pose, test_pose_t, 0x0010, 0xE0, 0xE1, 0xE2, 0xE3);
+
+static test_pose_server_t m_pose_server;
+static test_pose_t m_pose;
+static uint32_t m_pose_set_count;
+
+static test_pose_t pose_set_cb(const test_pose_server_t * p_self, const test_pose_t * p_target)
+{
+    m_pose_set_count++;
+    m_pose = *p_target;
+    return m_pose;
+}
+
+static test_pose_t pose_get_cb(const test_pose_server_t * p_self)
+{
+    return m_pose;
+}
+
+/** Injects a typed model message and returns the number of messages the server sent for it. */
+static uint32_t pose_inject(uint16_t src, uint16_t opcode, const uint8_t * p_data, uint16_t length)
+{
+    host_mesh_stats_t before;
+    host_mesh_stats_t after;
+    host_mesh_stats_get(&before);
+    CHECK(host_mesh_inject(src, host_mesh_element_address_get(0), (access_opcode_t) {opcode, POS_CMD_COMPANY_ID},
+                           p_data, length) == NRF_SUCCESS);
+    host_mesh_stats_get(&after);
+    return after.sent - before.sent;
+}
+
+static void test_typed_model(void)
+{
+    host_mesh_config_t config;
+    host_mesh_config_default(&config);
+    host_mesh_reset(&config);
+    memset(&m_pose_server, 0, sizeof(m_pose_server));
+    memset(&m_pose, 0, sizeof(m_pose));
+    m_pose_set_count = 0;
+    m_pose_server.set_cb = pose_set_cb;
+    m_pose_server.get_cb = pose_get_cb;
+    CHECK(test_pose_server_init(&m_pose_server, 0) == NRF_SUCCESS);
+
+    /* An acknowledged Set is applied and answered with the present value. */
+    uint8_t buffer[sizeof(test_pose_msg_t) + 1];
+    const test_pose_t pose = {{1, -2, 3}};
+    uint16_t length = test_pose_encode(buffer, &pose, 5);
+    CHECK(length == 7);
+    CHECK(pose_inject(0x0100, 0xE0, buffer, length) == 1);
+    CHECK(m_pose_set_count == 1 && m_pose.angle[1] == -2 && m_pose_server.state.tid == 5);
+
+    /* A repeated copy is answered, not applied again, and counted as a duplicate. */
+    CHECK(pose_inject(0x0100, 0xE0, buffer, length) == 1);
+    CHECK(m_pose_set_count == 1 && m_pose_server.state.stats.duplicates == 1);
+
+    /* The same TID from another client is a new Set, and the first client's entry is kept. */
+    CHECK(pose_inject(0x0101, 0xE1, buffer, length) == 0);
+    CHECK(m_pose_set_count == 2);
+    CHECK(pose_inject(0x0100, 0xE1, buffer, length) == 0);
+    CHECK(m_pose_set_count == 2 && m_pose_server.state.stats.duplicates == 2);
+
+    /* Once the cache window has passed, the TID may be used again. */
+    host_mesh_run_for(POS_CMD_SERVER_TID_CACHE_WINDOW);
+    CHECK(pose_inject(0x0100, 0xE1, buffer, length) == 0);
+    CHECK(m_pose_set_count == 3);
+
+    /* Messages of the wrong length are dropped. */
+    CHECK(pose_inject(0x0100, 0xE0, buffer, length - 1) == 0);
+    CHECK(pose_inject(0x0100, 0xE0, buffer, length + 1) == 0);
+    CHECK(m_pose_set_count == 3);
+
+    /* A Get is answered with its own TID. */
+    const pos_cmd_msg_get_t get = {9};
+    CHECK(pose_inject(0x0100, 0xE2, (const uint8_t *) &get, sizeof(get)) == 1);
+    CHECK(m_pose_set_count == 3);
+
+    /* A publication without a publish address is counted as failed. */
+    CHECK(test_pose_server_status_publish(&m_pose_server, &m_pose) != NRF_SUCCESS);
+    CHECK(m_pose_server.state.stats.publish_failures == 1);
+}
+
+/** Checks whether the client still waits for a reply to a transaction. */
+static bool transaction_outstanding(const pos_cmd_client_t * p_client, uint8_t tid)
+{
+    for (uint32_t i = 0; i < POS_CMD_CLIENT_TRANSACTION_COUNT; ++i)
+    {
+        if (p_client->state.transactions[i].active && p_client->state.transactions[i].tid == tid)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_client_tid_collision(void)
+{
+    /* A second client on element 2 commands the server with the same TID as the first client,
+     * whose own Set goes to an address nobody listens on. */
+    static pos_cmd_client_t other;
+    const uint16_t nowhere = 0x0010;
+    const uint16_t status_group = 0xC002;
+    models_setup(0);
+    memset(&other, 0, sizeof(other));
+    other.status_cb = client_status_cb;
+    CHECK(pos_cmd_client_init(&other, 2) == NRF_SUCCESS);
+    CHECK(host_mesh_publish_address_set(other.model_handle, host_mesh_element_address_get(1)) == NRF_SUCCESS);
+
+    /* The server publishes the colliding TID straight to the first client. */
+    CHECK(host_mesh_publish_address_set(m_server.model_handle, host_mesh_element_address_get(0)) == NRF_SUCCESS);
+    CHECK(host_mesh_publish_address_set(m_client.model_handle, nowhere) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_set(&m_client, (struct position_t) {1, 1}) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_set(&other, (struct position_t) {2, 2}) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_last_tid_get(&m_client) == pos_cmd_client_last_tid_get(&other));
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == 1 && m_present.x == 2);
+    CHECK(transaction_outstanding(&m_client, pos_cmd_client_last_tid_get(&m_client)));
+    CHECK(!transaction_outstanding(&other, pos_cmd_client_last_tid_get(&other)));
+    pos_cmd_client_pending_msg_cancel(&m_client);
+
+    /* A group request is only completed by a reply, not by a Status published to a group. */
+    CHECK(access_model_subscription_list_alloc(m_client.model_handle) == NRF_SUCCESS);
+    CHECK(host_mesh_subscription_add(m_client.model_handle, status_group) == NRF_SUCCESS);
+    CHECK(host_mesh_publish_address_set(m_server.model_handle, status_group) == NRF_SUCCESS);
+    CHECK(host_mesh_publish_address_set(m_client.model_handle, 0xC001) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_set(&m_client, (struct position_t) {3, 3}) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_set(&other, (struct position_t) {4, 4}) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_last_tid_get(&m_client) == pos_cmd_client_last_tid_get(&other));
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == 2 && m_present.x == 4);
+    CHECK(transaction_outstanding(&m_client, pos_cmd_client_last_tid_get(&m_client)));
+    pos_cmd_client_pending_msg_cancel(&m_client);
+
+    /* Once the server subscribes to the group, its reply completes the request. */
+    CHECK(host_mesh_subscription_add(m_server.model_handle, 0xC001) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_set(&m_client, (struct position_t) {5, 5}) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == 3 && m_present.x == 5);
+    CHECK(!transaction_outstanding(&m_client, pos_cmd_client_last_tid_get(&m_client)));
+
+    pos_cmd_client_pending_msg_cancel(&other);
+    models_teardown();
+}
+
+static void test_delta_per_client(void)
+{
+    /* Two clients send deltas to the same server, each against its own keyframe. */
+    static pos_cmd_client_t other;
+    models_setup(0);
+    memset(&other, 0, sizeof(other));
+    other.status_cb = client_status_cb;
+    CHECK(pos_cmd_client_init(&other, 2) == NRF_SUCCESS);
+    CHECK(host_mesh_publish_address_set(other.model_handle, host_mesh_element_address_get(1)) == NRF_SUCCESS);
+
+    const struct position_t keyframe = {100, 100};
+    const struct position_t other_keyframe = {-100, -100};
+    CHECK(pos_cmd_client_set_delta_unreliable(&m_client, &keyframe, 1, 1) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(pos_cmd_client_set_delta_unreliable(&other, &other_keyframe, 1, 1) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == 2 && m_present.x == -100);
+
+    /* The first client's delta still decodes against its own reference. */
+    const struct position_t target = {110, 90};
+    CHECK(pos_cmd_client_set_delta_unreliable(&m_client, &target, 1, 1) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == 3 && m_present.x == 110 && m_present.y == 90);
+
+    const struct position_t other_target = {-90, -110};
+    CHECK(pos_cmd_client_set_delta_unreliable(&other, &other_target, 1, 1) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == 4 && m_present.x == -90 && m_present.y == -110);
+
+    pos_cmd_client_pending_msg_cancel(&other);
+    models_teardown();
+}
+
+static void test_client_stragglers(void)
+{
+    /* A Set to a group the server does not subscribe to never reaches it. */
+    const uint16_t server = host_mesh_element_address_get(1);
+    const struct position_t target = {700, 700};
+    uint16_t stragglers[1];
+    models_setup(0);
+    CHECK(pos_cmd_client_server_add(&m_client, server) == NRF_SUCCESS);
+    CHECK(host_mesh_publish_address_set(m_server.model_handle, host_mesh_element_address_get(0)) == NRF_SUCCESS);
+    CHECK(host_mesh_publish_address_set(m_client.model_handle, 0xC001) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_set_unreliable(&m_client, target, 1) == NRF_SUCCESS);
+    uint8_t set_tid = pos_cmd_client_last_tid_get(&m_client);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == 0);
+
+    /* The reply to a later Get carries a newer TID, but confirms no Set. */
+    CHECK(host_mesh_publish_address_set(m_client.model_handle, server) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_get(&m_client) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(pos_cmd_status_table_find(pos_cmd_client_status_table_get(&m_client), server)->reported);
+    CHECK(pos_cmd_status_table_stragglers_get(pos_cmd_client_status_table_get(&m_client), set_tid, &target,
+                                              stragglers, 1) == 1);
+    CHECK(stragglers[0] == server);
+
+    /* A Set that reaches the server catches it up, also for the earlier Set. */
+    CHECK(pos_cmd_client_set_unreliable(&m_client, (struct position_t) {800, 800}, 1) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == 1);
+    CHECK(pos_cmd_status_table_stragglers_get(pos_cmd_client_status_table_get(&m_client), set_tid, &target,
+                                              NULL, 0) == 0);
+
+    models_teardown();
+}
+
+static void test_client_adaptive(void)
+{
+    /* The server publishes past a deadband and at most every 200 ms, so its Status carries the
+     * newest Set by then rather than the probe. */
+    const uint16_t server = host_mesh_element_address_get(1);
+    models_setup(0);
+    m_server.publish_config.deadband = 50;
+    m_server.publish_config.min_interval = MS_TO_US(200);
+    CHECK(host_mesh_publish_address_set(m_server.model_handle, host_mesh_element_address_get(0)) == NRF_SUCCESS);
+    m_client.adaptive.target_permille = 900;
+    m_client.adaptive.repeats_max = 4;
+    m_client.adaptive.deadband = 50;
+
+    /* On a lossless link the repeat count backs off from the maximum. */
+    uint32_t failures = 0;
+    for (int16_t i = 0; i < 500; ++i)
+    {
+        if (pos_cmd_client_set_unreliable_adaptive(&m_client, (struct position_t) {(int16_t) (i * 10), 0}) !=
+            NRF_SUCCESS)
+        {
+            failures++;
+        }
+        host_mesh_run_for(MS_TO_US(20));
+    }
+    CHECK(failures == 0);
+    const pos_cmd_link_t * p_link = pos_cmd_link_get(&m_client.state.links, server, 4);
+    CHECK(p_link->repeats < 4);
+    CHECK(p_link->delivery >= POS_CMD_LINK_DELIVERY_ONE / 10 * 9);
+
+    models_teardown();
+}
+
+static struct position_t m_batch[POS_CMD_PATH_POINTS_MAX];
+static uint16_t m_batch_count;
+static uint32_t m_path_count;
+static bool m_path_delivered;
+
+static void server_set_batch_cb(const pos_cmd_server_t * p_self, const struct position_t * p_targets, uint16_t count)
+{
+    memcpy(m_batch, p_targets, count * sizeof(p_targets[0]));
+    m_batch_count = count;
+    m_present = p_targets[count - 1];
+}
+
+static void client_path_cb(const pos_cmd_client_t * p_self, bool delivered, uint16_t dst)
+{
+    m_path_count++;
+    m_path_delivered = delivered;
+}
+
+static void test_deferred_path(void)
+{
+    /* A deferred server acknowledges a path only if it hands the whole path over later. */
+    models_setup(0);
+    m_client.path_cb = client_path_cb;
+    m_server.set_batch_cb = server_set_batch_cb;
+    m_server.deferred = true;
+    m_batch_count = 0;
+    m_path_count = 0;
+
+    struct position_t points[5];
+    for (int16_t i = 0; i < 5; ++i)
+    {
+        points[i] = (struct position_t) {i, (int16_t) -i};
+    }
+    CHECK(pos_cmd_client_path_send(&m_client, points, 5) == NRF_SUCCESS);
+    host_mesh_run_for(SEC_TO_US(1));
+    CHECK(m_path_count == 1 && m_path_delivered);
+    CHECK(m_batch_count == 0);
+
+    /* A second path is not taken while the first one is queued. */
+    points[4].x = 40;
+    CHECK(pos_cmd_client_path_send(&m_client, points, 5) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(500));
+    CHECK(m_path_count == 1);
+
+    CHECK(pos_cmd_server_process(&m_server));
+    CHECK(m_batch_count == 5 && m_batch[4].x == 4 && m_batch[4].y == -4);
+    CHECK(!pos_cmd_server_process(&m_server));
+
+    /* Once the first path was applied, the retried second one goes through. */
+    host_mesh_run_for(SEC_TO_US(10));
+    CHECK(m_path_count == 2 && m_path_delivered);
+    CHECK(pos_cmd_server_process(&m_server));
+    CHECK(m_batch_count == 5 && m_batch[4].x == 40);
+    models_teardown();
+}
+
+static void test_client_coalesce(void)
+{
+    /* A Set held back for a full window is sent from the slot freed by the first reply, which
+     * must still be reported as its own transaction. */
+    models_setup(0);
+    m_client.coalesce = true;
+    for (int16_t i = 0; i <= POS_CMD_CLIENT_WINDOW_SIZE; ++i)
+    {
+        CHECK(pos_cmd_client_set(&m_client, (struct position_t) {i, i}) == NRF_SUCCESS);
+    }
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == POS_CMD_CLIENT_WINDOW_SIZE + 1);
+    CHECK(m_present.x == POS_CMD_CLIENT_WINDOW_SIZE);
+    CHECK(m_status_count == POS_CMD_CLIENT_WINDOW_SIZE + 1 && m_last_status == POS_CMD_STATUS_PRESENT);
+
+    /* Every round trip takes two deliveries, none may be recorded as shorter. */
+    const pos_cmd_stats_t * p_stats = pos_cmd_client_stats_get(&m_client);
+    uint32_t recorded = 0;
+    for (uint32_t i = 0; i < POS_CMD_STATS_RTT_BUCKETS; ++i)
+    {
+        recorded += p_stats->rtt[i];
+    }
+    CHECK(recorded == POS_CMD_CLIENT_WINDOW_SIZE + 1);
+    CHECK(p_stats->rtt[0] == 0);
+    models_teardown();
+}
+
+static void test_client_stop_no_mem(void)
+{
+    /* A full window and a coalesced Set behind it. */
+    models_setup(0);
+    m_client.coalesce = true;
+    for (int16_t i = 0; i <= POS_CMD_CLIENT_WINDOW_SIZE; ++i)
+    {
+        CHECK(pos_cmd_client_set(&m_client, (struct position_t) {i, i}) == NRF_SUCCESS);
+    }
+    CHECK(m_client.state.pending_valid);
+
+    /* Fill the TX queue with unreliable Sets until the mesh stack runs out of buffers. */
+    uint32_t status = NRF_SUCCESS;
+    for (int16_t i = 0; i < HOST_MESH_QUEUE_SIZE && status == NRF_SUCCESS; ++i)
+    {
+        status = pos_cmd_client_set_unreliable(&m_client, (struct position_t) {(int16_t) (100 + i), 0}, 1);
+    }
+    CHECK(status == NRF_ERROR_NO_MEM);
+
+    /* The Stop is retried instead of failing, and it still cancels the Sets. */
+    m_status_count = 0;
+    CHECK(pos_cmd_client_stop(&m_client) == NRF_SUCCESS);
+    uint8_t stop_tid = pos_cmd_client_last_tid_get(&m_client);
+    CHECK(!m_client.state.pending_valid);
+    CHECK(m_status_count == POS_CMD_CLIENT_WINDOW_SIZE + 1 && m_last_status == POS_CMD_STATUS_CANCELLED);
+    CHECK(transaction_outstanding(&m_client, stop_tid));
+
+    host_mesh_run_for(SEC_TO_US(2));
+    CHECK(!transaction_outstanding(&m_client, stop_tid));
+    CHECK(m_last_status == POS_CMD_STATUS_PRESENT);
+    models_teardown();
+}
+
+static void test_mesh_topology(void)
+{
+    host_mesh_stats_t stats;
+
+    /* A line 0 - 2 - 1: the client and the server only hear each other through the relay. */
+    models_setup(0);
+    host_mesh_topology_clear();
+    CHECK(host_mesh_link_set(0, 2, 0) == NRF_SUCCESS);
+    CHECK(host_mesh_link_set(2, 0, 0) == NRF_SUCCESS);
+    CHECK(host_mesh_link_set(2, 1, 0) == NRF_SUCCESS);
+    CHECK(host_mesh_link_set(1, 2, 0) == NRF_SUCCESS);
+    CHECK(host_mesh_link_set(1, 1, 0) == NRF_ERROR_INVALID_PARAM);
+    CHECK(host_mesh_link_set(0, HOST_MESH_NODES_MAX, 0) == NRF_ERROR_INVALID_PARAM);
+    CHECK(host_mesh_relay_set(2, true) == NRF_SUCCESS);
+    CHECK(host_mesh_relay_set(0, true) == NRF_SUCCESS);
+
+    CHECK(pos_cmd_client_set(&m_client, (struct position_t) {5, 5}) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(200));
+    CHECK(m_set_count == 1);
+    CHECK(m_status_count == 1 && m_last_status == POS_CMD_STATUS_PRESENT);
+    host_mesh_stats_get(&stats);
+    CHECK(stats.relayed == 2 && stats.delivered == 2 && stats.hops == 4);
+    CHECK(stats.latency_us >= 2 * MS_TO_US(2 * 10 + 1));
+    CHECK(host_mesh_idle());
+
+    /* The client relays too, and drops the copy of its Set relayed back to it. */
+    CHECK(stats.duplicates == 1);
+
+    /* Without the relay nothing gets through. */
+    CHECK(host_mesh_relay_set(2, false) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_set_unreliable(&m_client, (struct position_t) {6, 6}, 1) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(200));
+    CHECK(m_set_count == 1);
+    models_teardown();
+
+    /* Two clients sending to the server at the same time collide there. */
+    host_mesh_config_t config;
+    host_mesh_config_default(&config);
+    config.collisions = true;
+    host_mesh_reset(&config);
+
+    pos_cmd_client_t clients[2];
+    memset(clients, 0, sizeof(clients));
+    memset(&m_server, 0, sizeof(m_server));
+    m_server.get_cb = server_get_cb;
+    m_server.set_cb = server_set_cb;
+    CHECK(pos_cmd_server_init(&m_server, 1) == NRF_SUCCESS);
+    for (uint16_t i = 0; i < 2; ++i)
+    {
+        clients[i].status_cb = client_status_cb;
+        CHECK(pos_cmd_client_init(&clients[i], (uint16_t) (2 * i)) == NRF_SUCCESS);
+        CHECK(host_mesh_publish_address_set(clients[i].model_handle, host_mesh_element_address_get(1)) == NRF_SUCCESS);
+    }
+    m_set_count = 0;
+
+    CHECK(pos_cmd_client_set_unreliable(&clients[0], (struct position_t) {1, 1}, 1) == NRF_SUCCESS);
+    CHECK(pos_cmd_client_set_unreliable(&clients[1], (struct position_t) {2, 2}, 1) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    host_mesh_stats_get(&stats);
+    CHECK(m_set_count == 0);
+    CHECK(stats.collisions == 2);
+
+    /* One after the other they both get through. */
+    CHECK(pos_cmd_client_set_unreliable(&clients[0], (struct position_t) {3, 3}, 1) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(1));
+    CHECK(pos_cmd_client_set_unreliable(&clients[1], (struct position_t) {4, 4}, 1) == NRF_SUCCESS);
+    host_mesh_run_for(MS_TO_US(100));
+    CHECK(m_set_count == 2 && m_present.x == 4);
+    for (uint16_t i = 0; i < 2; ++i)
+    {
+        pos_cmd_client_pending_msg_cancel(&clients[i]);
+    }
+}
+
+int main(void)
+{
+    test_codec();
+    test_trajectory();
+    test_airtime();
+    test_link();
+    test_status_table();
+    test_client_server();
+    test_axis_server();
+    test_typed_model();
+    test_client_coalesce();
+    test_client_tid_collision();
+    test_delta_per_client();
+    test_client_stragglers();
+    test_client_adaptive();
+    test_client_stop_no_mem();
+    test_deferred_path();
+    test_mesh_topology();
+
+    printf("%u checks, %u failures\n", m_checks, m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
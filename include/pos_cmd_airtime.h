@@ -0,0 +1,98 @@
+#ifndef POS_CMD_AIRTIME_H__
+#define POS_CMD_AIRTIME_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+
+/**
+ * @defgroup POS_CMD_AIRTIME PosCmd airtime budget
+ * @ingroup POS_CMD_MODEL
+ * Token bucket over the estimated airtime of the messages a model sends.
+ *
+ * The bucket holds airtime in microseconds. It fills at a fixed share of the elapsed time, up to
+ * its depth, and every message sent takes its estimated airtime out. Messages that must not wait
+ * may overdraw the bucket; the debt then delays the messages that can wait.
+ * @{
+ */
+
+/**
+ * Airtime of one network PDU, in microseconds. The default is a full advertising packet at
+ * 1 Mbit/s, sent on all three advertising channels.
+ */
+#ifndef POS_CMD_AIRTIME_PDU_US
+#define POS_CMD_AIRTIME_PDU_US (3 * 376)
+#endif
+
+/** Token bucket. */
+typedef struct
+{
+    int32_t tokens;          /**< Airtime available, in microseconds. Negative while overdrawn. */
+    timestamp_t updated;     /**< Time the bucket was last filled. */
+    uint32_t used;           /**< Airtime taken out since initialization, in microseconds. Wraps around. */
+} pos_cmd_airtime_bucket_t;
+
+/**
+ * Estimates the airtime of a message from its length and segmentation.
+ *
+ * @param[in] length          Length of the message parameters, without the opcode.
+ * @param[in] opcode_length   Length of the opcode.
+ * @param[in] force_segmented Whether the message is sent segmented even if it would fit in one PDU.
+ *
+ * @returns Estimated airtime in microseconds.
+ */
+uint32_t pos_cmd_airtime_cost(uint16_t length, uint8_t opcode_length, bool force_segmented);
+
+/**
+ * Fills the bucket for the time elapsed since it was last filled.
+ *
+ * @param[in,out] p_bucket       Bucket.
+ * @param[in]     now            Current time.
+ * @param[in]     share_permille Share of the elapsed time added, in 1/1000.
+ * @param[in]     depth          Most airtime the bucket holds, in microseconds.
+ */
+void pos_cmd_airtime_refill(pos_cmd_airtime_bucket_t * p_bucket,
+                            timestamp_t now,
+                            uint16_t share_permille,
+                            uint32_t depth);
+
+/**
+ * Checks whether a message may be sent now.
+ *
+ * A message costing more than the depth of the bucket may be sent once the bucket is full, so
+ * it is not held back forever.
+ *
+ * @param[in] p_bucket Bucket, filled up to now.
+ * @param[in] cost     Airtime of the message, in microseconds.
+ * @param[in] depth    Most airtime the bucket holds, in microseconds.
+ *
+ * @returns @c true if the message may be sent.
+ */
+bool pos_cmd_airtime_available(const pos_cmd_airtime_bucket_t * p_bucket, uint32_t cost, uint32_t depth);
+
+/**
+ * Takes the airtime of a message sent out of the bucket.
+ *
+ * @param[in,out] p_bucket Bucket.
+ * @param[in]     cost     Airtime of the message, in microseconds.
+ */
+void pos_cmd_airtime_consume(pos_cmd_airtime_bucket_t * p_bucket, uint32_t cost);
+
+/**
+ * Gets the time until a message may be sent.
+ *
+ * @param[in] p_bucket       Bucket, filled up to now.
+ * @param[in] cost           Airtime of the message, in microseconds.
+ * @param[in] share_permille Share of the elapsed time added to the bucket, in 1/1000.
+ * @param[in] depth          Most airtime the bucket holds, in microseconds.
+ *
+ * @returns Time to wait in microseconds, 0 if the message may be sent now.
+ */
+uint32_t pos_cmd_airtime_wait(const pos_cmd_airtime_bucket_t * p_bucket,
+                              uint32_t cost,
+                              uint16_t share_permille,
+                              uint32_t depth);
+
+/** @} end of POS_CMD_AIRTIME */
+
+#endif /* POS_CMD_AIRTIME_H__ */
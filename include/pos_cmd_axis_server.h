@@ -0,0 +1,138 @@
+#ifndef POS_CMD_AXIS_SERVER_H__
+#define POS_CMD_AXIS_SERVER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "access.h"
+#include "timer.h"
+#include "pos_cmd_common.h"
+#include "pos_cmd_server.h"
+#include "pos_cmd_stats.h"
+
+/**
+ * @defgroup POS_CMD_AXIS_SERVER PosCmd Axis Server
+ * @ingroup POS_CMD_MODEL
+ * PosCmd Server variant that manages up to @ref POS_CMD_AXES_MAX axes in one model instance.
+ *
+ * The state of the axes is kept as a structure of arrays, one array per quantity, indexed by
+ * axis. Axis Set, Axis Get and Axis Status address axes with a bit mask, so a single message can
+ * carry any subset of the axes, and one publication reports every axis that has moved.
+ * @{
+ */
+
+/** PosCmd Axis Server model ID. */
+#define POS_CMD_AXIS_SERVER_MODEL_ID (0x000A)
+
+/** Forward declaration. */
+typedef struct __pos_cmd_axis_server pos_cmd_axis_server_t;
+
+/**
+ * Axis set callback type.
+ *
+ * The new targets are in @ref __pos_cmd_axis_server::state, see
+ * @ref pos_cmd_axis_server_target_get.
+ *
+ * @param[in] p_self Pointer to the PosCmd Axis Server context structure.
+ * @param[in] mask   Axes that got a new target.
+ */
+typedef void (*pos_cmd_axis_set_cb_t)(const pos_cmd_axis_server_t * p_self, uint16_t mask);
+
+/** PosCmd Axis Server state structure. */
+struct __pos_cmd_axis_server
+{
+    /** Model handle assigned to the server. */
+    access_model_handle_t model_handle;
+    /** Number of axes, at most @ref POS_CMD_AXES_MAX. */
+    uint8_t axis_count;
+    /** Axis set callback. */
+    pos_cmd_axis_set_cb_t set_cb;
+    /** Minimum change of the present position of an axis that makes it due for publication. */
+    uint16_t deadband;
+    /** Internal server state. */
+    struct
+    {
+        int16_t target[POS_CMD_AXES_MAX];    /**< Target position per axis. */
+        int16_t present[POS_CMD_AXES_MAX];   /**< Present position per axis. */
+        int16_t velocity[POS_CMD_AXES_MAX];  /**< Present velocity per axis, in position units per second. */
+        int16_t published[POS_CMD_AXES_MAX]; /**< Last published present position per axis. */
+        uint16_t changed;                    /**< Axes due for publication. */
+        uint8_t tid;                         /**< Transaction number of the last applied Axis Set. */
+        pos_cmd_server_tid_entry_t tid_cache[POS_CMD_SERVER_TID_CACHE_SIZE]; /**< Recent transactions. */
+        uint8_t tid_cache_next;              /**< Next TID cache entry to overwrite. */
+        pos_cmd_stats_t stats;               /**< Message statistics. */
+    } state;
+};
+
+/**
+ * Initializes the PosCmd Axis Server.
+ *
+ * @note This function should only be called _once_.
+ * @note The server handles the model allocation and adding.
+ *
+ * @param[in] p_server      PosCmd Axis Server structure pointer.
+ * @param[in] element_index Element index to add the server model.
+ *
+ * @retval NRF_SUCCESS             Successfully added server.
+ * @retval NRF_ERROR_NULL          NULL pointer supplied to function.
+ * @retval NRF_ERROR_INVALID_PARAM Invalid number of axes.
+ * @retval NRF_ERROR_NO_MEM        No more memory available to allocate model.
+ * @retval NRF_ERROR_FORBIDDEN     Multiple model instances per element is not allowed.
+ * @retval NRF_ERROR_NOT_FOUND     Invalid element index.
+ */
+uint32_t pos_cmd_axis_server_init(pos_cmd_axis_server_t * p_server, uint16_t element_index);
+
+/**
+ * Gets the target position of an axis.
+ *
+ * @param[in] p_server PosCmd Axis Server structure pointer.
+ * @param[in] index    Axis index.
+ *
+ * @returns Target position of the axis.
+ */
+int16_t pos_cmd_axis_server_target_get(const pos_cmd_axis_server_t * p_server, uint8_t index);
+
+/**
+ * Reports the present state of an axis.
+ *
+ * The axis becomes due for publication when it has moved at least
+ * @ref __pos_cmd_axis_server::deadband from its last published position. Report every axis that
+ * moved, then publish them together with @ref pos_cmd_axis_server_status_publish.
+ *
+ * @param[in,out] p_server PosCmd Axis Server structure pointer.
+ * @param[in]     index    Axis index.
+ * @param[in]     present  Present position of the axis.
+ * @param[in]     velocity Present velocity of the axis, in position units per second.
+ */
+void pos_cmd_axis_server_present_update(pos_cmd_axis_server_t * p_server,
+                                        uint8_t index,
+                                        int16_t present,
+                                        int16_t velocity);
+
+/**
+ * Publishes the present position of every axis due for publication in one Axis Status.
+ *
+ * @param[in,out] p_server PosCmd Axis Server structure pointer.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission, or no axis was due.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t pos_cmd_axis_server_status_publish(pos_cmd_axis_server_t * p_server);
+
+/**
+ * Gets the statistics of the server.
+ *
+ * @param[in] p_server PosCmd Axis Server structure pointer.
+ *
+ * @returns Pointer to the statistics.
+ */
+const pos_cmd_stats_t * pos_cmd_axis_server_stats_get(const pos_cmd_axis_server_t * p_server);
+
+/** @} end of POS_CMD_AXIS_SERVER */
+
+#endif /* POS_CMD_AXIS_SERVER_H__ */
@@ -0,0 +1,142 @@
+#ifndef POS_CMD_CAPTURE_H__
+#define POS_CMD_CAPTURE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "access.h"
+#include "nrf_mesh_assert.h"
+
+/**
+ * @defgroup POS_CMD_CAPTURE PosCmd traffic capture
+ * @ingroup POS_CMD_MODEL
+ * Binary capture of every message the PosCmd models send and receive, for offline replay.
+ *
+ * Unlike @ref POS_CMD_TRACE, a capture record holds the addresses and the payload of the message,
+ * so the exchange can be fed back through the models later. The models hand each record to a sink
+ * registered by the application, which stores or forwards it, e.g. to flash or over RTT. Records
+ * are laid out back to back with no padding, and @ref pos_cmd_capture_record_next walks them in
+ * place, so a capture file can be replayed from a memory mapping without loading it into RAM.
+ * The host tool in host/replay/ does so: it feeds the received messages of a capture through the
+ * models at the original or an accelerated speed, and diffs the messages they send, and when,
+ * against the capture.
+ *
+ * Capture is selected at compile time with @ref POS_CMD_CAPTURE_ENABLED. When disabled the capture
+ * calls compile out, but the record format and @ref pos_cmd_capture_record_next remain available
+ * to tools that read captures.
+ * @{
+ */
+
+/** Enables capture of PosCmd traffic. */
+#ifndef POS_CMD_CAPTURE_ENABLED
+#define POS_CMD_CAPTURE_ENABLED (0)
+#endif
+
+/** Largest payload stored in a record. Longer payloads are truncated. */
+#ifndef POS_CMD_CAPTURE_PAYLOAD_MAX
+#define POS_CMD_CAPTURE_PAYLOAD_MAX (80)
+#endif
+
+/**
+ * @defgroup POS_CMD_CAPTURE_FLAGS Capture record flags
+ * @{
+ */
+#define POS_CMD_CAPTURE_FLAG_TX        (1 << 0) /**< Message sent, otherwise received. */
+#define POS_CMD_CAPTURE_FLAG_FAILED    (1 << 1) /**< The access layer refused to send the message. */
+#define POS_CMD_CAPTURE_FLAG_TRUNCATED (1 << 2) /**< Payload truncated at @ref POS_CMD_CAPTURE_PAYLOAD_MAX. */
+/** @} */
+
+/**
+ * Capture record, followed by @ref pos_cmd_capture_record_t::length bytes of payload.
+ *
+ * Sent messages have the source address @c NRF_MESH_ADDR_UNASSIGNED, meaning the capturing node.
+ * Publications have the publish address of the model as destination, replies the source of the
+ * request.
+ */
+typedef struct __attribute((packed))
+{
+    uint32_t timestamp; /**< Time the message was sent or received, in microseconds. */
+    uint16_t src;       /**< Source address. */
+    uint16_t dst;       /**< Destination address. */
+    uint8_t opcode;     /**< Vendor opcode of the message. */
+    uint8_t tid;        /**< Transaction number of the message. */
+    uint8_t flags;      /**< Record flags, see @ref POS_CMD_CAPTURE_FLAGS. */
+    uint16_t length;    /**< Payload length stored in the record. */
+    uint8_t payload[];  /**< Message payload. */
+} pos_cmd_capture_record_t;
+
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_capture_record_t) == 13);
+
+/**
+ * Capture sink type.
+ *
+ * Called once per record, from the mesh stack context the models run in. The record is only valid
+ * for the duration of the call.
+ *
+ * @param[in] p_record Encoded record.
+ * @param[in] length   Length of the record, header included.
+ */
+typedef void (*pos_cmd_capture_sink_t)(const uint8_t * p_record, uint16_t length);
+
+/**
+ * Gets the next record in a capture and advances the cursor past it.
+ *
+ * The record is returned in place, so the capture may be a memory mapped file.
+ *
+ * @param[in,out] pp_cursor Position of the next record, advanced past the record returned.
+ * @param[in]     p_end     End of the capture.
+ *
+ * @returns The record, or NULL at the end of the capture or if the remaining bytes do not hold a
+ *          complete record.
+ */
+const pos_cmd_capture_record_t * pos_cmd_capture_record_next(const uint8_t ** pp_cursor, const uint8_t * p_end);
+
+#if POS_CMD_CAPTURE_ENABLED
+
+/**
+ * Sets the capture sink. Capture is off until a sink is set.
+ *
+ * @param[in] sink Capture sink, or NULL to stop capturing.
+ */
+void pos_cmd_capture_sink_set(pos_cmd_capture_sink_t sink);
+
+/**
+ * Captures a received message. Use @ref POS_CMD_CAPTURE_RX instead, so the call compiles out.
+ *
+ * @param[in] p_message Received message.
+ */
+void pos_cmd_capture_rx(const access_message_rx_t * p_message);
+
+/**
+ * Captures a sent message. Use @ref POS_CMD_CAPTURE_TX instead, so the call compiles out.
+ *
+ * @param[in] model_handle Handle of the model that sent the message.
+ * @param[in] p_request    Request the message replies to, or NULL if it was published.
+ * @param[in] p_message    Sent message.
+ * @param[in] status       Error code returned by the access layer.
+ */
+void pos_cmd_capture_tx(access_model_handle_t model_handle,
+                        const access_message_rx_t * p_request,
+                        const access_message_tx_t * p_message,
+                        uint32_t status);
+
+/** Captures a received message. */
+#define POS_CMD_CAPTURE_RX(p_message) pos_cmd_capture_rx(p_message)
+/** Captures a sent message. */
+#define POS_CMD_CAPTURE_TX(model_handle, p_request, p_message, status) \
+    pos_cmd_capture_tx((model_handle), (p_request), (p_message), (status))
+
+#else
+
+static inline void pos_cmd_capture_sink_set(pos_cmd_capture_sink_t sink)
+{
+    (void) sink;
+}
+
+#define POS_CMD_CAPTURE_RX(p_message) do {} while (0)
+#define POS_CMD_CAPTURE_TX(model_handle, p_request, p_message, status) do {} while (0)
+
+#endif
+
+/** @} end of POS_CMD_CAPTURE */
+
+#endif /* POS_CMD_CAPTURE_H__ */
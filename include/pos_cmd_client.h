@@ -5,7 +5,14 @@
 
 #include <stdint.h>
 #include "access.h"
+#include "timer.h"
+#include "timer_scheduler.h"
+#include "nrf_mesh_assert.h"
 #include "pos_cmd_common.h"
+#include "pos_cmd_status_table.h"
+#include "pos_cmd_link.h"
+#include "pos_cmd_airtime.h"
+#include "pos_cmd_stats.h"
 
 /**
  * @defgroup POS_CMD_CLIENT PosCmd Client
@@ -20,16 +27,73 @@
 #define POS_CMD_CLIENT_ACKED_TRANSACTION_TIMEOUT  (SEC_TO_US(60))
 #endif
 
+/** Number of acknowledged transactions that may be outstanding at the same time. */
+#ifndef POS_CMD_CLIENT_WINDOW_SIZE
+#define POS_CMD_CLIENT_WINDOW_SIZE  (4)
+#endif
+
+/** Initial retransmission interval of an unacknowledged message, doubled after every retransmission. */
+#ifndef POS_CMD_CLIENT_RETRANSMIT_INTERVAL
+#define POS_CMD_CLIENT_RETRANSMIT_INTERVAL  (MS_TO_US(500))
+#endif
+
+/** Initial retransmission interval of an unacknowledged Stop, doubled after every retransmission. */
+#ifndef POS_CMD_CLIENT_STOP_RETRANSMIT_INTERVAL
+#define POS_CMD_CLIENT_STOP_RETRANSMIT_INTERVAL  (MS_TO_US(100))
+#endif
+
+/** Number of Set Delta messages sent against one reference before a new keyframe is forced. */
+#ifndef POS_CMD_CLIENT_DELTA_KEYFRAME_INTERVAL
+#define POS_CMD_CLIENT_DELTA_KEYFRAME_INTERVAL  (16)
+#endif
+
+/** Number of Path Chunks sent back to back before waiting for a Path Ack, at most 32. */
+#ifndef POS_CMD_CLIENT_PATH_BURST
+#define POS_CMD_CLIENT_PATH_BURST  (8)
+#endif
+
+/** Time to wait for a Path Ack before sending the missing chunks again. */
+#ifndef POS_CMD_CLIENT_PATH_ACK_TIMEOUT
+#define POS_CMD_CLIENT_PATH_ACK_TIMEOUT  (MS_TO_US(500))
+#endif
+
+/** Number of bursts in a row without progress before a path transfer is given up. */
+#ifndef POS_CMD_CLIENT_PATH_ATTEMPTS
+#define POS_CMD_CLIENT_PATH_ATTEMPTS  (8)
+#endif
+
+/** Number of unreliable messages that may wait for the airtime budget at the same time. */
+#ifndef POS_CMD_CLIENT_AIRTIME_QUEUE_SIZE
+#define POS_CMD_CLIENT_AIRTIME_QUEUE_SIZE  (4)
+#endif
+
+/**
+ * Largest unreliable message that may wait for the airtime budget. Larger messages are charged
+ * but sent right away. The default fits every unreliable message at the default sizes.
+ */
+#ifndef POS_CMD_CLIENT_AIRTIME_PAYLOAD_MAX
+#define POS_CMD_CLIENT_AIRTIME_PAYLOAD_MAX  (68)
+#endif
+
+/** Minimum time between two messages sent from the airtime queue, which spreads out repeats. */
+#ifndef POS_CMD_CLIENT_REPEAT_INTERVAL
+#define POS_CMD_CLIENT_REPEAT_INTERVAL  (MS_TO_US(20))
+#endif
+
+/** Number of transaction slots, the window plus one slot reserved for Stop. */
+#define POS_CMD_CLIENT_TRANSACTION_COUNT (POS_CMD_CLIENT_WINDOW_SIZE + 1)
+
+NRF_MESH_STATIC_ASSERT(POS_CMD_CLIENT_WINDOW_SIZE > 0 && POS_CMD_CLIENT_TRANSACTION_COUNT <= 32);
+NRF_MESH_STATIC_ASSERT(POS_CMD_CLIENT_PATH_BURST > 0 && POS_CMD_CLIENT_PATH_BURST <= 32);
+
 /** PosCmd Client model ID. */
 #define POS_CMD_CLIENT_MODEL_ID (0x0008)
 
 /** PosCmd status codes. */
 typedef enum
 {
-    /** Received status OFF from the server. */
-    POS_CMD_STATUS_OFF,
-    /** Received status ON from the server. */
-    POS_CMD_STATUS_ON,
+    /** Received the present position from the server. */
+    POS_CMD_STATUS_PRESENT,
     /** The server did not reply to a PosCmd Set/Get. */
     POS_CMD_STATUS_ERROR_NO_REPLY,
     /** PosCmd Set/Get was cancelled. */
@@ -42,11 +106,49 @@ typedef struct __pos_cmd_client pos_cmd_client_t;
 /**
  * PosCmd status callback type.
  *
- * @param[in] p_self Pointer to the PosCmd client structure that received the status.
- * @param[in] status The received status of the remote server.
- * @param[in] src    Element address of the remote server.
+ * @param[in] p_self    Pointer to the PosCmd client structure that received the status.
+ * @param[in] status    The received status of the remote server.
+ * @param[in] p_present Present position reported by the server, or NULL if @p status is not
+ *                      @ref POS_CMD_STATUS_PRESENT.
+ * @param[in] src       Element address of the remote server.
+ */
+typedef void (*pos_cmd_status_cb_t)(const pos_cmd_client_t * p_self,
+                                    pos_cmd_status_t status,
+                                    const struct position_t * p_present,
+                                    uint16_t src);
+/**
+ * PosCmd stats callback type.
+ *
+ * @param[in] p_self  Pointer to the PosCmd client structure that received the statistics.
+ * @param[in] p_stats Statistics reported by the server.
+ * @param[in] src     Element address of the remote server.
+ */
+typedef void (*pos_cmd_stats_cb_t)(const pos_cmd_client_t * p_self, const pos_cmd_stats_t * p_stats, uint16_t src);
+
+/**
+ * PosCmd axis status callback type.
+ *
+ * @param[in] p_self    Pointer to the PosCmd client structure that received the status.
+ * @param[in] mask      Axes reported by the server.
+ * @param[in] p_present Present position per axis, indexed by axis. Only the entries selected by
+ *                      @p mask are valid.
+ * @param[in] src       Element address of the remote server.
+ */
+typedef void (*pos_cmd_axis_status_cb_t)(const pos_cmd_client_t * p_self,
+                                         uint16_t mask,
+                                         const int16_t * p_present,
+                                         uint16_t src);
+
+/**
+ * PosCmd path callback type.
+ *
+ * @param[in] p_self    Pointer to the PosCmd client structure that sent the path.
+ * @param[in] delivered Whether the server acknowledged every chunk of the path. @c false if the
+ *                      transfer timed out or was cancelled.
+ * @param[in] dst       Element address of the server the path was sent to.
  */
-typedef void (*pos_cmd_status_cb_t)(const pos_cmd_client_t * p_self, pos_cmd_status_t status, uint16_t src);
+typedef void (*pos_cmd_path_cb_t)(const pos_cmd_client_t * p_self, bool delivered, uint16_t dst);
+
 /**
  * PosCmd timeout callback type.
  *
@@ -55,6 +157,45 @@ typedef void (*pos_cmd_status_cb_t)(const pos_cmd_client_t * p_self, pos_cmd_sta
  */
 typedef void (*pos_cmd_timeout_cb_t)(access_model_handle_t handle, void * p_self);
 
+/**
+ * Outstanding acknowledged transaction, matched to its Status reply by TID and, for a unicast
+ * request, by the address of the server.
+ */
+typedef struct
+{
+    bool active;                    /**< Set while waiting for the Status reply. */
+    uint8_t tid;                    /**< Transaction number of the request. */
+    uint16_t dst;                   /**< Address the request was published to. */
+    pos_cmd_opcode_t opcode;        /**< Opcode of the request. */
+    timestamp_t sent;               /**< Time the request was first sent. */
+    timestamp_t deadline;           /**< Time at which the transaction times out. */
+    timestamp_t next_retransmit;    /**< Time of the next retransmission. */
+    uint32_t retransmit_interval;   /**< Current retransmission interval. */
+    uint16_t length;                /**< Length of the encoded request. */
+    uint8_t * p_data;               /**< Encoded request in a @ref POS_CMD_TX_POOL buffer, or in the
+                                         client's Stop buffer, kept for retransmission. */
+} pos_cmd_client_transaction_t;
+
+/** Unreliable message waiting for the airtime budget. */
+typedef struct
+{
+    pos_cmd_opcode_t opcode;    /**< Opcode of the message. */
+    uint8_t tid;                /**< Transaction number of the message. */
+    uint8_t repeats;            /**< Copies left to send. */
+    uint16_t length;            /**< Length of the message. */
+    uint8_t data[POS_CMD_CLIENT_AIRTIME_PAYLOAD_MAX]; /**< Encoded message. */
+} pos_cmd_client_deferred_t;
+
+/** Airtime budget usage of a client. */
+typedef struct
+{
+    int32_t available_us; /**< Airtime budget available now, in microseconds. Negative while overdrawn. */
+    uint32_t used_us;     /**< Airtime used since initialization, in microseconds. Wraps around. */
+    uint8_t queued;       /**< Unreliable messages waiting for the budget. */
+    uint32_t deferred;    /**< Unreliable messages that had to wait for the budget. */
+    uint32_t dropped;     /**< Unreliable messages dropped from the queue, superseded or for lack of room. */
+} pos_cmd_client_airtime_usage_t;
+
 /** PosCmd Client state structure. */
 struct __pos_cmd_client
 {
@@ -64,11 +205,101 @@ struct __pos_cmd_client
     pos_cmd_status_cb_t status_cb;
     /** Timeout callback called after acknowledged message sending times out */
     pos_cmd_timeout_cb_t timeout_cb;
+    /** Stats callback called when a server reports its statistics. Optional. */
+    pos_cmd_stats_cb_t stats_cb;
+    /** Axis status callback called when a PosCmd Axis Server reports its axes. Optional. */
+    pos_cmd_axis_status_cb_t axis_status_cb;
+    /** Path callback called when a path transfer ends. Optional. */
+    pos_cmd_path_cb_t path_cb;
+    /**
+     * Coalesce acknowledged Sets. When set, a Set issued while all transaction slots are in use is
+     * held back instead of rejected, replacing any Set already held back, and is sent as soon as a
+     * slot frees up.
+     */
+    bool coalesce;
+    /** Quantization shift used by @ref pos_cmd_client_set_delta_unreliable, 0 for lossless deltas. */
+    uint8_t delta_shift;
+    /**
+     * Dead-reckoning suppression of unreliable Sets to a unicast server. A Set is not sent when the
+     * last Status and estimated velocity of the server predict its target within @c error_bound,
+     * unless @c refresh_interval has passed since the last Set or the last Status.
+     */
+    struct
+    {
+        uint16_t error_bound;      /**< Largest error per coordinate to suppress a Set at, 0 to disable. */
+        uint32_t refresh_interval; /**< Longest time between two Sets to the same server, in microseconds. */
+    } dead_reckoning;
+    /**
+     * Freshness of the cached server state, in microseconds, 0 to disable the cache. While the
+     * server at the publish address has reported within this time, @ref pos_cmd_client_get
+     * answers from the status table instead of sending a Get.
+     */
+    uint32_t get_cache_ttl;
+    /** Repeat policy of @ref pos_cmd_client_set_unreliable_adaptive. */
+    struct
+    {
+        uint16_t target_permille; /**< Delivery probability to reach per message, in 1/1000. */
+        uint8_t repeats_max;      /**< Upper bound on the number of messages per burst. */
+        uint16_t deadband;        /**< Publish deadband of the servers, see @ref pos_cmd_server_publish_config_t. */
+    } adaptive;
+    /**
+     * Airtime budget, see @ref POS_CMD_AIRTIME. With @c share_permille set, every publication is
+     * charged its estimated airtime. Acknowledged requests, retransmissions and Stops are sent
+     * right away and may overdraw the budget. Copies of unreliable messages that exceed the budget
+     * are queued and sent as it recovers, at least @ref POS_CMD_CLIENT_REPEAT_INTERVAL apart. A
+     * Set Unreliable replaces any Set Unreliable still queued.
+     */
+    struct
+    {
+        uint16_t share_permille; /**< Share of the airtime the client may use, in 1/1000, 0 to disable pacing. */
+        uint32_t burst_us;       /**< Most airtime the client may use in one go, in microseconds. */
+    } airtime;
     /** Internal client state. */
     struct
     {
-        bool reliable_transfer_active; /**< Variable used to determine if a transfer is currently active. */
-        pos_cmd_msg_set_t data;  /**< Variable reflecting the data stored in the server. */
+        /** Outstanding acknowledged transactions, the last slot is reserved for Stop. */
+        pos_cmd_client_transaction_t transactions[POS_CMD_CLIENT_TRANSACTION_COUNT];
+        uint8_t stop_buffer[sizeof(pos_cmd_msg_stop_t)]; /**< Encoded Stop, so a Stop never waits for the pool. */
+        timer_event_t timer;     /**< Retransmission and timeout timer. */
+        uint8_t tid;             /**< Transaction number of the next message. */
+        uint32_t set_tids[256 / 32]; /**< Transaction numbers last used by a Set, one bit per number. */
+        bool pending_valid;      /**< Set while a coalesced Set is waiting for a free slot. */
+        struct position_t pending_target; /**< Target of the coalesced Set. */
+        struct
+        {
+            struct position_t ref;  /**< Target of the newest acknowledged Set. */
+            uint8_t ref_tid;        /**< Transaction number of the newest acknowledged Set. */
+            bool ref_valid;         /**< Set once a Set has been acknowledged. */
+            uint8_t count;          /**< Set Delta messages sent against the current reference. */
+            bool keyframe_pending;  /**< Set while a keyframe Set is outstanding. */
+            uint8_t keyframe_tid;   /**< Transaction number of the outstanding keyframe Set. */
+        } delta;                    /**< Set Delta encoder state. */
+        pos_cmd_status_table_t servers; /**< Last reported state per server. */
+        pos_cmd_link_table_t links;     /**< Delivery estimate per destination of adaptive Sets. */
+        struct
+        {
+            bool active;                  /**< Set while a path is being sent. */
+            uint8_t tid;                  /**< Transaction number of the path. */
+            uint8_t attempts;             /**< Bursts sent since the last progress. */
+            uint16_t dst;                 /**< Server the path is sent to. */
+            const struct position_t * p_points; /**< Points of the path, owned by the application. */
+            uint16_t count;               /**< Number of points. */
+            uint16_t chunk_count;         /**< Number of chunks. */
+            uint16_t base;                /**< First chunk not acknowledged. */
+            uint32_t acked[POS_CMD_PATH_CHUNK_WORDS]; /**< Chunks acknowledged, one bit per chunk. */
+            timer_event_t timer;          /**< Path Ack timeout timer. */
+        } path;                           /**< Path transfer state. */
+        struct
+        {
+            pos_cmd_airtime_bucket_t bucket; /**< Airtime budget. */
+            pos_cmd_client_deferred_t queue[POS_CMD_CLIENT_AIRTIME_QUEUE_SIZE]; /**< Messages waiting, oldest first. */
+            uint8_t count;                /**< Number of messages waiting. */
+            bool scheduled;               /**< Set while the timer is scheduled. */
+            timer_event_t timer;          /**< Timer sending the next waiting message. */
+            uint32_t deferred;            /**< Messages that had to wait. */
+            uint32_t dropped;             /**< Messages dropped from the queue. */
+        } airtime;                        /**< Airtime pacing state. */
+        pos_cmd_stats_t stats;          /**< Message statistics. */
     } state;
 };
 
@@ -90,28 +321,40 @@ struct __pos_cmd_client
 uint32_t pos_cmd_client_init(pos_cmd_client_t * p_client, uint16_t element_index);
 
 /**
- * Sets the state of the PosCmd server.
+ * Sets the target position of the PosCmd server.
+ *
+ * @note With @ref __pos_cmd_client::coalesce set, a Set issued while the transaction window is
+ *       full returns @ref NRF_SUCCESS and is sent later. If it cannot be sent at that point, the
+ *       status callback is called with @ref POS_CMD_STATUS_CANCELLED.
  *
  * @param[in,out] p_client PosCmd Client structure pointer.
- * @param[in]     on_off   Value to set the PosCmd Server state to.
+ * @param[in]     target   Position to set the PosCmd Server target to.
  *
  * @retval NRF_SUCCESS              Successfully sent message.
  * @retval NRF_ERROR_NULL           NULL pointer in function arguments
- * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message, or no free
+ *                                  @ref POS_CMD_TX_POOL buffer.
  * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
  * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
  *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
- * @retval NRF_ERROR_INVALID_STATE  Message already scheduled for a reliable transfer.
+ * @retval NRF_ERROR_INVALID_STATE  @ref POS_CMD_CLIENT_WINDOW_SIZE acknowledged transactions are
+ *                                  already outstanding.
  * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
  *                                  opcode format.
  */
-uint32_t pos_cmd_client_set(pos_cmd_client_t * p_client, uint8_t * on_off);
+uint32_t pos_cmd_client_set(pos_cmd_client_t * p_client, struct position_t target);
 
 /**
- * Sets the state of the PosCmd Server unreliably (without acknowledgment).
+ * Sets the target position of the PosCmd Server unreliably (without acknowledgment).
+ *
+ * @note With @ref __pos_cmd_client::dead_reckoning enabled, a Set the server is predicted to
+ *       already follow returns @ref NRF_SUCCESS without sending anything.
+ * @note With @ref __pos_cmd_client::airtime pacing enabled, copies that exceed the airtime budget
+ *       are queued and sent later, and @ref NRF_SUCCESS is returned once the first copy is sent
+ *       or queued.
  *
  * @param[in,out] p_client PosCmd Client structure pointer.
- * @param[in]     on_off   Value to set the PosCmd Server state to.
+ * @param[in]     target   Position to set the PosCmd Server target to.
  * @param[in]     repeats  Number of messages to send in a single burst. Increasing the number may
  *                     increase probability of successful delivery.
  *
@@ -124,29 +367,403 @@ uint32_t pos_cmd_client_set(pos_cmd_client_t * p_client, uint8_t * on_off);
  * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
  *                                  opcode format.
  */
-uint32_t pos_cmd_client_set_unreliable(pos_cmd_client_t * p_client, uint8_t * com_data, uint16_t len, uint8_t repeats);
+uint32_t pos_cmd_client_set_unreliable(pos_cmd_client_t * p_client, struct position_t target, uint8_t repeats);
 
 /**
- * Gets the state of the PosCmd server.
+ * Sets the target position of the PosCmd Server unreliably, with an adaptive repeat count.
  *
- * @note The state of the server will be given in the @ref pos_cmd_status_cb_t callback.
+ * The client estimates the delivery ratio to the publish address from the Status messages the
+ * servers publish, and sends the smallest number of repeats that meets
+ * @ref __pos_cmd_client::adaptive, see @ref POS_CMD_LINK. New destinations start at
+ * the maximum number of repeats and back off while the link stays good.
+ *
+ * @note The estimate needs the servers to publish their Status to this client. Sets within the
+ *       deadband of the position a server last reported produce no Status and are not used as
+ *       probes, so set @c adaptive.deadband to the deadband the servers publish with.
+ *
+ * @param[in,out] p_client PosCmd Client structure pointer.
+ * @param[in]     target   Position to set the PosCmd Server target to.
+ *
+ * @retval NRF_SUCCESS              Successfully sent message.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid adaptive repeat policy, model not bound to appkey,
+ *                                  publish address not set or wrong opcode format.
+ */
+uint32_t pos_cmd_client_set_unreliable_adaptive(pos_cmd_client_t * p_client, struct position_t target);
+
+/**
+ * Sets several target positions of the PosCmd Server in one unreliable message.
+ *
+ * The positions are packed in order into a single access message, e.g. one target per axis or the
+ * points of a short trajectory. The server hands all of them to the application in one go.
+ *
+ * @param[in,out] p_client  PosCmd Client structure pointer.
+ * @param[in]     p_targets Positions to send. Copied into the message before the function returns.
+ * @param[in]     count     Number of positions, at most @ref POS_CMD_BATCH_POSITIONS_MAX.
+ * @param[in]     repeats   Number of messages to send in a single burst.
+ *
+ * @retval NRF_SUCCESS              Successfully sent message.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_PARAM  @p count is zero or too large, model not bound to appkey,
+ *                                  publish address not set or wrong opcode format.
+ */
+uint32_t pos_cmd_client_set_batch_unreliable(pos_cmd_client_t * p_client,
+                                             const struct position_t * p_targets,
+                                             uint8_t count,
+                                             uint8_t repeats);
+
+/**
+ * Sets target positions of the PosCmd Server with a compact delta encoding, unreliably.
+ *
+ * The targets are encoded as 8-bit deltas against the newest acknowledged Set, quantized by
+ * @ref __pos_cmd_client::delta_shift. A keyframe is sent instead when there is no acknowledged
+ * reference yet, when @ref POS_CMD_CLIENT_DELTA_KEYFRAME_INTERVAL deltas were sent against the
+ * current reference, or when a target is too far from it. The keyframe is an acknowledged Set of
+ * the last target in @p p_targets; earlier targets in that call are skipped. While a keyframe is
+ * outstanding, targets are sent in full with @ref pos_cmd_client_set_batch_unreliable.
+ *
+ * @note The server keeps the reference of @ref POS_CMD_SERVER_DELTA_REF_COUNT clients. A server
+ *       that has not got this client's reference, e.g. because it missed the keyframe, drops the
+ *       deltas without telling the client, until the next keyframe.
+ *
+ * @param[in,out] p_client  PosCmd Client structure pointer.
+ * @param[in]     p_targets Positions to send.
+ * @param[in]     count     Number of positions, at most @ref POS_CMD_BATCH_POSITIONS_MAX.
+ * @param[in]     repeats   Number of messages to send in a single burst, not used for keyframes.
+ *
+ * @retval NRF_SUCCESS              Successfully sent message.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_STATE  A keyframe was needed but the transaction window is full.
+ * @retval NRF_ERROR_INVALID_PARAM  @p count is zero or too large, invalid quantization shift,
+ *                                  model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t pos_cmd_client_set_delta_unreliable(pos_cmd_client_t * p_client,
+                                             const struct position_t * p_targets,
+                                             uint8_t count,
+                                             uint8_t repeats);
+
+/**
+ * Sends a trajectory to the PosCmd Server unreliably.
+ *
+ * The server interpolates from its present position through the waypoints and hands setpoints to
+ * its application every @ref POS_CMD_SERVER_CONTROL_INTERVAL, so one message describes the whole
+ * motion. Any later Set to the server aborts the trajectory.
+ *
+ * @param[in,out] p_client    PosCmd Client structure pointer.
+ * @param[in]     p_waypoints Waypoints to visit, in order.
+ * @param[in]     count       Number of waypoints, at most @ref POS_CMD_TRAJECTORY_WAYPOINTS_MAX.
+ * @param[in]     leg_time_ms Time to travel between two consecutive waypoints, in milliseconds.
+ * @param[in]     repeats     Number of messages to send in a single burst.
+ *
+ * @retval NRF_SUCCESS              Successfully sent message.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_PARAM  @p count is zero or too large, model not bound to appkey,
+ *                                  publish address not set or wrong opcode format.
+ */
+uint32_t pos_cmd_client_trajectory_unreliable(pos_cmd_client_t * p_client,
+                                              const struct position_t * p_waypoints,
+                                              uint8_t count,
+                                              uint16_t leg_time_ms,
+                                              uint8_t repeats);
+
+/**
+ * Sets the target position of the PosCmd server at a given time.
+ *
+ * Every server that receives the Set applies it at the same instant, regardless of when its copy
+ * arrived, when @p absolute is set and the servers share a time base, see
+ * @ref __pos_cmd_server::time_base_cb. With a delay, each server counts from its own reception.
+ * The transaction completes when a server replies that the Set is scheduled. A server without a
+ * time base replies to an absolute Set at once as well, without scheduling it, so the reported
+ * position does not move to @p target.
+ *
+ * @param[in,out] p_client PosCmd Client structure pointer.
+ * @param[in]     target   Position to set the PosCmd Server target to.
+ * @param[in]     time_ms  Low 16 bits of the execution time on the shared time base if
+ *                         @p absolute is set, delay from reception otherwise, in milliseconds.
+ * @param[in]     absolute Whether @p time_ms is an execution time rather than a delay.
+ *
+ * @retval NRF_SUCCESS              Successfully sent message.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message, or no free
+ *                                  @ref POS_CMD_TX_POOL buffer.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_STATE  @ref POS_CMD_CLIENT_WINDOW_SIZE acknowledged transactions are
+ *                                  already outstanding.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t pos_cmd_client_set_scheduled(pos_cmd_client_t * p_client,
+                                      struct position_t target,
+                                      uint16_t time_ms,
+                                      bool absolute);
+
+/**
+ * Sets target positions of axes of a PosCmd Axis Server.
+ *
+ * The Axis Set is encoded into a @ref POS_CMD_TX_POOL buffer like every acknowledged request, so it
+ * must fit an unsegmented message: at most two axes. Use
+ * @ref pos_cmd_client_axis_set_unreliable for more. The reply is given in the
+ * @ref pos_cmd_axis_status_cb_t callback.
+ *
+ * @param[in,out] p_client  PosCmd Client structure pointer.
+ * @param[in]     mask      Axes to set.
+ * @param[in]     p_targets Target position per axis, indexed by axis. Only the entries selected by
+ *                          @p mask are used.
+ *
+ * @retval NRF_SUCCESS              Successfully sent message.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message, or no free
+ *                                  @ref POS_CMD_TX_POOL buffer.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_STATE  @ref POS_CMD_CLIENT_WINDOW_SIZE acknowledged transactions are
+ *                                  already outstanding.
+ * @retval NRF_ERROR_INVALID_PARAM  @p mask selects no axis or more than two, model not bound to
+ *                                  appkey, publish address not set or wrong opcode format.
+ */
+uint32_t pos_cmd_client_axis_set(pos_cmd_client_t * p_client, uint16_t mask, const int16_t * p_targets);
+
+/**
+ * Sets target positions of axes of a PosCmd Axis Server unreliably (without acknowledgment).
+ *
+ * @param[in,out] p_client  PosCmd Client structure pointer.
+ * @param[in]     mask      Axes to set.
+ * @param[in]     p_targets Target position per axis, indexed by axis. Only the entries selected by
+ *                          @p mask are used.
+ * @param[in]     repeats   Number of messages to send in a single burst.
+ *
+ * @retval NRF_SUCCESS              Successfully sent message.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_PARAM  @p mask selects no axis or one beyond @ref POS_CMD_AXES_MAX,
+ *                                  model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t pos_cmd_client_axis_set_unreliable(pos_cmd_client_t * p_client,
+                                            uint16_t mask,
+                                            const int16_t * p_targets,
+                                            uint8_t repeats);
+
+/**
+ * Gets the present position of axes of a PosCmd Axis Server.
+ *
+ * The state is given in the @ref pos_cmd_axis_status_cb_t callback.
  *
  * @param[in,out] p_client PosCmd Client structure pointer.
+ * @param[in]     mask     Axes to report.
  *
  * @retval NRF_SUCCESS              Successfully sent message.
  * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message, or no free
+ *                                  @ref POS_CMD_TX_POOL buffer.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_STATE  @ref POS_CMD_CLIENT_WINDOW_SIZE acknowledged transactions are
+ *                                  already outstanding.
+ * @retval NRF_ERROR_INVALID_PARAM  @p mask selects no axis or one beyond @ref POS_CMD_AXES_MAX,
+ *                                  model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t pos_cmd_client_axis_get(pos_cmd_client_t * p_client, uint16_t mask);
+
+/**
+ * Streams a long path to the PosCmd server at the publish address.
+ *
+ * The path is split into chunks of @ref POS_CMD_PATH_CHUNK_POINTS points, which are sent back to
+ * back in bursts of @ref POS_CMD_CLIENT_PATH_BURST. The server acknowledges each burst with a
+ * bitmap of the chunks it holds, and only the missing chunks are sent again. The server hands the
+ * whole path to its application at once, see @ref __pos_cmd_server::set_batch_cb. The outcome is
+ * given in the @ref pos_cmd_path_cb_t callback.
+ *
+ * @note The points are not copied. They must stay valid until the path callback is called.
+ * @note The acknowledgments come from a single server, so the publish address must be a unicast
+ *       address.
+ *
+ * @param[in,out] p_client PosCmd Client structure pointer.
+ * @param[in]     p_points Points of the path, in order.
+ * @param[in]     count    Number of points, at most @ref POS_CMD_PATH_POINTS_MAX.
+ *
+ * @retval NRF_SUCCESS              Successfully started the transfer.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
  * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
  * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
  * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
  *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
- * @retval NRF_ERROR_INVALID_STATE  Message already scheduled for a reliable transfer.
+ * @retval NRF_ERROR_INVALID_STATE  A path transfer is already in progress.
+ * @retval NRF_ERROR_INVALID_PARAM  @p count is zero or too large, publish address not set or not
+ *                                  a unicast address, model not bound to appkey or wrong opcode
+ *                                  format.
+ */
+uint32_t pos_cmd_client_path_send(pos_cmd_client_t * p_client, const struct position_t * p_points, uint16_t count);
+
+/**
+ * Stops the PosCmd server.
+ *
+ * The Stop has a transaction slot and buffer of its own, so it is never rejected or delayed
+ * because of the acknowledged Sets and Gets in flight, and it is never coalesced. It is sent
+ * before anything else is touched, and if the mesh stack has no buffer for it, it is retried with
+ * the retransmissions instead of failing. Then the unreliable messages waiting for the airtime budget are
+ * dropped, and the coalesced Set, if any, and all outstanding acknowledged and scheduled Sets are
+ * cancelled, so a retransmission can not move the server again after the Stop. A path transfer in
+ * progress is cancelled as well. Gets and Stats Gets in flight are left alone. A Stop still
+ * outstanding is cancelled and replaced by the new one.
+ *
+ * @note The status callback is called with @ref POS_CMD_STATUS_CANCELLED for every cancelled
+ *       transaction, and with the present position once the server has stopped.
+ *
+ * @param[in,out] p_client PosCmd Client structure pointer.
+ *
+ * @retval NRF_SUCCESS              Successfully sent message, or queued it for retransmission.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format. The coalesced Set and the Sets in flight are kept.
+ */
+uint32_t pos_cmd_client_stop(pos_cmd_client_t * p_client);
+
+/**
+ * Gets the state of the PosCmd server.
+ *
+ * @note The state of the server will be given in the @ref pos_cmd_status_cb_t callback.
+ * @note With @ref __pos_cmd_client::get_cache_ttl set and a fresh Status from the server at the
+ *       publish address in the status table, whether a reply or a publication, the callback is
+ *       called with the cached state before this function returns and no message is sent.
+ *
+ * @param[in,out] p_client PosCmd Client structure pointer.
+ *
+ * @retval NRF_SUCCESS              Successfully sent message, or answered from the cache.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message, or no free
+ *                                  @ref POS_CMD_TX_POOL buffer.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_STATE  @ref POS_CMD_CLIENT_WINDOW_SIZE acknowledged transactions are
+ *                                  already outstanding.
  * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
  *                                  opcode format.
  */
 uint32_t pos_cmd_client_get(pos_cmd_client_t * p_client);
 
 /**
- * Cancel any ongoing reliable message transfer.
+ * Requests the statistics of the PosCmd server.
+ *
+ * The statistics are given in the @ref pos_cmd_stats_cb_t callback. The request takes a slot in
+ * the acknowledged transaction window like any other acknowledged message.
+ *
+ * @param[in,out] p_client PosCmd Client structure pointer.
+ *
+ * @retval NRF_SUCCESS              Successfully sent message.
+ * @retval NRF_ERROR_NULL           NULL pointer in function arguments
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message, or no free
+ *                                  @ref POS_CMD_TX_POOL buffer.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_STATE  @ref POS_CMD_CLIENT_WINDOW_SIZE acknowledged transactions are
+ *                                  already outstanding.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t pos_cmd_client_stats_request(pos_cmd_client_t * p_client);
+
+/**
+ * Gets the statistics of the client.
+ *
+ * @param[in] p_client PosCmd Client structure pointer.
+ *
+ * @returns Pointer to the statistics.
+ */
+const pos_cmd_stats_t * pos_cmd_client_stats_get(const pos_cmd_client_t * p_client);
+
+/**
+ * Resets the statistics of the client.
+ *
+ * @param[in,out] p_client PosCmd Client structure pointer.
+ */
+void pos_cmd_client_stats_reset(pos_cmd_client_t * p_client);
+
+/**
+ * Adds a server to the client's status table.
+ *
+ * Servers that send a Status are added automatically. Adding the members of a group up front
+ * lets @ref pos_cmd_status_table_stragglers_get also report servers that never answered.
+ *
+ * @param[in,out] p_client PosCmd Client structure pointer.
+ * @param[in]     address  Element address of the server.
+ *
+ * @retval NRF_SUCCESS             The server is in the table.
+ * @retval NRF_ERROR_NULL          NULL pointer in function arguments.
+ * @retval NRF_ERROR_INVALID_PARAM Invalid address.
+ * @retval NRF_ERROR_NO_MEM        The table holds @ref POS_CMD_STATUS_TABLE_SIZE servers already.
+ */
+uint32_t pos_cmd_client_server_add(pos_cmd_client_t * p_client, uint16_t address);
+
+/**
+ * Gets the client's status table, holding the last Status reported by every known server.
+ *
+ * Use the @ref POS_CMD_STATUS_TABLE functions to look up, iterate or check acknowledgment.
+ *
+ * @param[in] p_client PosCmd Client structure pointer.
+ *
+ * @returns Pointer to the status table.
+ */
+const pos_cmd_status_table_t * pos_cmd_client_status_table_get(const pos_cmd_client_t * p_client);
+
+/**
+ * Gets the airtime budget usage of the client.
+ *
+ * @param[in]  p_client PosCmd Client structure pointer.
+ * @param[out] p_usage  Airtime budget usage.
+ */
+void pos_cmd_client_airtime_usage_get(const pos_cmd_client_t * p_client, pos_cmd_client_airtime_usage_t * p_usage);
+
+/**
+ * Gets the transaction number of the last message sent by the client.
+ *
+ * Use it after a Set to a group address to check which servers have applied it, with
+ * @ref pos_cmd_status_table_stragglers_get and the target of the Set. Only a Status carrying the
+ * number of one of this client's Sets, whether a reply or a publication, counts as applying it.
+ * A coalesced Set gets its number when it is sent.
+ *
+ * @param[in] p_client PosCmd Client structure pointer.
+ *
+ * @returns Transaction number of the last message sent.
+ */
+uint8_t pos_cmd_client_last_tid_get(const pos_cmd_client_t * p_client);
+
+/**
+ * Cancel all outstanding acknowledged transactions.
+ *
+ * The status callback is called with @ref POS_CMD_STATUS_CANCELLED once per cancelled transaction,
+ * including a coalesced Set that has not been sent yet.
+ * A path transfer in progress is cancelled as well, and reported to the path callback.
  *
  * @param[in,out] p_client Pointer to the client instance structure.
  */
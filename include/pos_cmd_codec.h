@@ -0,0 +1,58 @@
+#ifndef POS_CMD_CODEC_H__
+#define POS_CMD_CODEC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pos_cmd_common.h"
+
+/**
+ * @defgroup POS_CMD_CODEC PosCmd delta codec
+ * @ingroup POS_CMD_MODEL
+ * Encodes positions as 8-bit, optionally quantized, deltas against a reference position.
+ *
+ * A position is encoded as @c round((target - reference) / 2^shift) per coordinate, which must fit
+ * in an @c int8_t. With @c shift zero the encoding is lossless.
+ * @{
+ */
+
+/** Largest quantization shift supported by the codec. */
+#define POS_CMD_CODEC_SHIFT_MAX (7)
+
+/**
+ * Encodes positions as deltas against a reference.
+ *
+ * @param[in]  p_ref     Reference position.
+ * @param[in]  p_targets Positions to encode.
+ * @param[in]  count     Number of positions in @p p_targets.
+ * @param[in]  shift     Quantization shift, at most @ref POS_CMD_CODEC_SHIFT_MAX.
+ * @param[out] p_deltas  Encoded deltas, @p count entries.
+ *
+ * @returns @c true if every position could be encoded, @c false if a delta does not fit in
+ *          8 bits at the given quantization, in which case @p p_deltas is undefined.
+ */
+bool pos_cmd_codec_delta_encode(const struct position_t * p_ref,
+                                const struct position_t * p_targets,
+                                uint16_t count,
+                                uint8_t shift,
+                                pos_cmd_delta_t * p_deltas);
+
+/**
+ * Reconstructs positions from deltas against a reference.
+ *
+ * Coordinates outside the @c int16_t range saturate.
+ *
+ * @param[in]  p_ref     Reference position, the same as used for encoding.
+ * @param[in]  p_deltas  Encoded deltas.
+ * @param[in]  count     Number of deltas in @p p_deltas.
+ * @param[in]  shift     Quantization shift used for encoding.
+ * @param[out] p_targets Reconstructed positions, @p count entries.
+ */
+void pos_cmd_codec_delta_decode(const struct position_t * p_ref,
+                                const pos_cmd_delta_t * p_deltas,
+                                uint16_t count,
+                                uint8_t shift,
+                                struct position_t * p_targets);
+
+/** @} end of POS_CMD_CODEC */
+
+#endif /* POS_CMD_CODEC_H__ */
@@ -3,15 +3,53 @@
 
 #include <stdint.h>
 #include "access.h"
+#include "nrf_mesh_assert.h"
+#include "pos_cmd_stats.h"
 
 /** Vendor specific company ID for PosCmd model */
 #define POS_CMD_COMPANY_ID    (ACCESS_COMPANY_ID_NORDIC)
 
+/**
+ * Largest parameter length of a PosCmd message that still fits in a single unsegmented access PDU.
+ * An unsegmented access PDU carries 11 bytes, of which the vendor opcode takes 3.
+ */
+#define POS_CMD_UNSEGMENTED_PARAMS_MAX (8)
+
+/** Maximum number of positions carried by a single PosCmd Set Batch Unreliable message. */
+#ifndef POS_CMD_BATCH_POSITIONS_MAX
+#define POS_CMD_BATCH_POSITIONS_MAX (16)
+#endif
+
+/** Maximum number of axes of a PosCmd Axis Server, limited by the width of the axis mask. */
+#ifndef POS_CMD_AXES_MAX
+#define POS_CMD_AXES_MAX (16)
+#endif
+
+/** Maximum number of points in a path streamed with the PosCmd Path Chunk message. */
+#ifndef POS_CMD_PATH_POINTS_MAX
+#define POS_CMD_PATH_POINTS_MAX (128)
+#endif
+
+/**
+ * Number of points per PosCmd Path Chunk. With one point, every chunk fits in an unsegmented
+ * access PDU. More points per chunk save headers but make every chunk a segmented message.
+ */
+#ifndef POS_CMD_PATH_CHUNK_POINTS
+#define POS_CMD_PATH_CHUNK_POINTS (1)
+#endif
+
+/** Maximum number of chunks in a streamed path. */
+#define POS_CMD_PATH_CHUNKS_MAX ((POS_CMD_PATH_POINTS_MAX + POS_CMD_PATH_CHUNK_POINTS - 1) / POS_CMD_PATH_CHUNK_POINTS)
+
+/** Number of words in a bitmap with one bit per chunk of a streamed path. */
+#define POS_CMD_PATH_CHUNK_WORDS ((POS_CMD_PATH_CHUNKS_MAX + 31) / 32)
+
+/** Position state. Transmitted little-endian, as laid out in memory on the target. */
 struct position_t
 {
-    int16_t x;
-    int16_t y; 
-}  __attribute((packed)); 
+    int16_t x; /**< X coordinate. */
+    int16_t y; /**< Y coordinate. */
+}  __attribute((packed));
 
 /** PosCmd opcodes. */
 typedef enum
@@ -19,29 +57,222 @@ typedef enum
     POS_CMD_OPCODE_SET = 0xC1,            /**< PosCmd Acknowledged Set. */
     POS_CMD_OPCODE_GET = 0xC2,            /**< PosCmd Get. */
     POS_CMD_OPCODE_SET_UNRELIABLE = 0xC3, /**< PosCmd Set Unreliable. */
-    POS_CMD_OPCODE_STATUS = 0xC4          /**< PosCmd Status. */
+    POS_CMD_OPCODE_STATUS = 0xC4,         /**< PosCmd Status. */
+    POS_CMD_OPCODE_SET_BATCH_UNRELIABLE = 0xC5, /**< PosCmd Set Batch Unreliable. */
+    POS_CMD_OPCODE_SET_DELTA_UNRELIABLE = 0xC6, /**< PosCmd Set Delta Unreliable. */
+    POS_CMD_OPCODE_TRAJECTORY_UNRELIABLE = 0xC7, /**< PosCmd Trajectory Unreliable. */
+    POS_CMD_OPCODE_STATS_GET = 0xC8,      /**< PosCmd Stats Get. */
+    POS_CMD_OPCODE_STATS_STATUS = 0xC9,   /**< PosCmd Stats Status. */
+    POS_CMD_OPCODE_STOP = 0xCA,           /**< PosCmd Acknowledged Stop. */
+    POS_CMD_OPCODE_SET_SCHEDULED = 0xCB,  /**< PosCmd Acknowledged Set Scheduled. */
+    POS_CMD_OPCODE_AXIS_SET = 0xCC,       /**< PosCmd Acknowledged Axis Set. */
+    POS_CMD_OPCODE_AXIS_SET_UNRELIABLE = 0xCD, /**< PosCmd Axis Set Unreliable. */
+    POS_CMD_OPCODE_AXIS_GET = 0xCE,       /**< PosCmd Axis Get. */
+    POS_CMD_OPCODE_AXIS_STATUS = 0xCF,    /**< PosCmd Axis Status. */
+    POS_CMD_OPCODE_PATH_CHUNK = 0xD0,     /**< PosCmd Path Chunk. */
+    POS_CMD_OPCODE_PATH_ACK = 0xD1        /**< PosCmd Path Ack. */
 } pos_cmd_opcode_t;
 
 /** Message format for the PosCmd Set message. */
 typedef struct __attribute((packed))
 {
-    uint8_t * com_data; /**< State to set. */
-    uint8_t tid;    /**< Transaction number. */
+    struct position_t target; /**< Target position to set. */
+    uint8_t tid;              /**< Transaction number. */
 } pos_cmd_msg_set_t;
 
+/** Message format for the PosCmd Get message. */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;    /**< Transaction number, echoed in the Status reply. */
+} pos_cmd_msg_get_t;
+
 /** Message format for th PosCmd Set Unreliable message. */
 typedef struct __attribute((packed))
 {
-    uint8_t * com_data; /**< State to set. */
-    uint8_t tid;    /**< Transaction number. */
+    struct position_t target; /**< Target position to set. */
+    uint8_t tid;              /**< Transaction number. */
 } pos_cmd_msg_set_unreliable_t;
 
 /** Message format for the PosCmd Status message. */
 typedef struct __attribute((packed))
 {
-    uint8_t * present_state; /**< Current state. */
+    struct position_t present; /**< Present position. */
+    uint8_t tid;               /**< Transaction number of the request replied to, or of the Set last
+                                    applied by the server for unsolicited publications. */
 } pos_cmd_msg_status_t;
 
+/** Message format for the PosCmd Set Batch Unreliable message. */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;                  /**< Transaction number. */
+    struct position_t targets[];  /**< Target positions, count given by the message length. */
+} pos_cmd_msg_set_batch_t;
+
+/** Position delta, see @ref POS_CMD_CODEC. */
+typedef struct __attribute((packed))
+{
+    int8_t dx; /**< Quantized X difference to the reference position. */
+    int8_t dy; /**< Quantized Y difference to the reference position. */
+} pos_cmd_delta_t;
+
+/**
+ * Message format for the PosCmd Set Delta Unreliable message.
+ *
+ * The reference position is the target of the acknowledged Set with transaction number
+ * @c ref_tid sent by the same client. The server drops the message if that is not the last
+ * acknowledged Set it applied from this client.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;                /**< Transaction number. */
+    uint8_t ref_tid;            /**< Transaction number of the reference Set. */
+    uint8_t shift;              /**< Quantization shift of the deltas. */
+    pos_cmd_delta_t deltas[];   /**< Target deltas, count given by the message length. */
+} pos_cmd_msg_set_delta_t;
+
+/**
+ * Message format for the PosCmd Trajectory Unreliable message.
+ *
+ * The server moves from its present position through every waypoint in turn, spending
+ * @c leg_time_ms on each leg.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;                    /**< Transaction number. */
+    uint16_t leg_time_ms;           /**< Time to travel each leg, in milliseconds. */
+    struct position_t waypoints[];  /**< Waypoints, count given by the message length. */
+} pos_cmd_msg_trajectory_t;
+
+/** Message format for the PosCmd Stats Get message. */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;    /**< Transaction number, echoed in the Stats Status reply. */
+} pos_cmd_msg_stats_get_t;
+
+/** Message format for the PosCmd Stats Status message. */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;           /**< Transaction number of the Stats Get replied to. */
+    pos_cmd_stats_t stats; /**< Statistics of the server. */
+} pos_cmd_msg_stats_status_t;
+
+/**
+ * Message format for the PosCmd Stop message.
+ *
+ * The server aborts any motion in progress, drops its scheduled Sets and holds its present position. It replies with a
+ * Status like for an acknowledged Set.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;    /**< Transaction number, echoed in the Status reply. */
+} pos_cmd_msg_stop_t;
+
+/** Set Scheduled flag: @c time_ms is a time on the shared time base instead of a delay. */
+#define POS_CMD_SCHEDULED_FLAG_ABSOLUTE (1 << 0)
+
+/**
+ * Message format for the PosCmd Set Scheduled message.
+ *
+ * The server replies with a Status as soon as the Set is scheduled, and applies the target at the
+ * execution time. With @ref POS_CMD_SCHEDULED_FLAG_ABSOLUTE, @c time_ms is the low 16 bits of
+ * the shared time base in milliseconds, which must be less than 32.768 seconds ahead. Without it,
+ * @c time_ms is a delay from reception, which does not include the transit time of the message.
+ */
+typedef struct __attribute((packed))
+{
+    struct position_t target; /**< Target position to set. */
+    uint8_t tid;              /**< Transaction number, echoed in the Status reply. */
+    uint16_t time_ms;         /**< Execution time or delay, in milliseconds. */
+    uint8_t flags;            /**< Set Scheduled flags. */
+} pos_cmd_msg_set_scheduled_t;
+
+/**
+ * Message format for the PosCmd Axis Set and Axis Set Unreliable messages.
+ *
+ * Bit n of @c mask selects axis n. The targets of the selected axes follow in order of increasing
+ * axis index. One axis fits in an unsegmented message, two axes as well.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;        /**< Transaction number. */
+    uint16_t mask;      /**< Axes to set. */
+    int16_t targets[];  /**< Target per selected axis. */
+} pos_cmd_msg_axis_set_t;
+
+/** Message format for the PosCmd Axis Get message. */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;    /**< Transaction number, echoed in the Axis Status reply. */
+    uint16_t mask;  /**< Axes to report. */
+} pos_cmd_msg_axis_get_t;
+
+/**
+ * Message format for the PosCmd Axis Status message.
+ *
+ * Carries the present position of the axes selected by @c mask, in order of increasing axis
+ * index. A reply reports the requested axes, a publication every axis that changed since the
+ * previous publication.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;        /**< Transaction number of the request replied to, or of the last applied Axis Set. */
+    uint16_t mask;      /**< Axes reported. */
+    int16_t present[];  /**< Present position per reported axis. */
+} pos_cmd_msg_axis_status_t;
+
+/** Path Chunk flag: the server replies with a Path Ack. */
+#define POS_CMD_PATH_FLAG_ACK_REQUEST (1 << 0)
+
+/**
+ * Message format for the PosCmd Path Chunk message.
+ *
+ * A path is split into chunks of @ref POS_CMD_PATH_CHUNK_POINTS points, numbered from zero. Only
+ * the last chunk may hold fewer points. All chunks of a path carry the same transaction number.
+ * The server reassembles them and hands the whole path to its application once every chunk has
+ * arrived, and replies with a Path Ack when asked to and when the path is complete.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;                 /**< Transaction number of the path. */
+    uint8_t seq;                 /**< Chunk number. */
+    uint8_t last;                /**< Number of the last chunk of the path. */
+    uint8_t flags;               /**< Path Chunk flags. */
+    struct position_t points[];  /**< Points of the chunk, count given by the message length. */
+} pos_cmd_msg_path_chunk_t;
+
+/**
+ * Message format for the PosCmd Path Ack message.
+ *
+ * Selectively acknowledges the chunks of a path. All chunks before @c next have arrived, chunk
+ * @c next has not. Bit n of @c received is set if chunk <tt>next + 1 + n</tt> has arrived. The
+ * path is complete when @c next is past its last chunk.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t tid;       /**< Transaction number of the path. */
+    uint8_t next;      /**< First chunk missing. */
+    uint32_t received; /**< Chunks received after the first missing one. */
+} pos_cmd_msg_path_ack_t;
+
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_stats_status_t) <= ACCESS_MESSAGE_LENGTH_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_set_delta_t) + sizeof(pos_cmd_delta_t) <= POS_CMD_UNSEGMENTED_PARAMS_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_set_batch_t) + POS_CMD_BATCH_POSITIONS_MAX * sizeof(struct position_t)
+                       <= ACCESS_MESSAGE_LENGTH_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_set_t) <= POS_CMD_UNSEGMENTED_PARAMS_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_get_t) <= POS_CMD_UNSEGMENTED_PARAMS_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_set_unreliable_t) <= POS_CMD_UNSEGMENTED_PARAMS_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_status_t) <= POS_CMD_UNSEGMENTED_PARAMS_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_stop_t) <= POS_CMD_UNSEGMENTED_PARAMS_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_set_scheduled_t) <= POS_CMD_UNSEGMENTED_PARAMS_MAX);
+NRF_MESH_STATIC_ASSERT(POS_CMD_AXES_MAX > 0 && POS_CMD_AXES_MAX <= 16);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_axis_set_t) + 2 * sizeof(int16_t) <= POS_CMD_UNSEGMENTED_PARAMS_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_axis_status_t) + POS_CMD_AXES_MAX * sizeof(int16_t)
+                       <= ACCESS_MESSAGE_LENGTH_MAX);
+NRF_MESH_STATIC_ASSERT(POS_CMD_PATH_CHUNK_POINTS > 0 && POS_CMD_PATH_CHUNKS_MAX <= UINT8_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_path_chunk_t) + POS_CMD_PATH_CHUNK_POINTS * sizeof(struct position_t)
+                       <= ACCESS_MESSAGE_LENGTH_MAX);
+NRF_MESH_STATIC_ASSERT(sizeof(pos_cmd_msg_path_ack_t) <= POS_CMD_UNSEGMENTED_PARAMS_MAX);
+
 
 /** @} end of POS_CMD_COMMON */
 /** @} end of POS_CMD_MODEL */
@@ -0,0 +1,131 @@
+#ifndef POS_CMD_LINK_H__
+#define POS_CMD_LINK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "nrf_mesh_assert.h"
+
+/**
+ * @defgroup POS_CMD_LINK PosCmd link estimator
+ * @ingroup POS_CMD_MODEL
+ * Per-destination delivery estimate and repeat count for unreliable messages.
+ *
+ * One message in flight per destination is a probe. It is delivered if the destination sends a
+ * Status carrying its transaction number, or that of a later Set of the same client, within
+ * @ref POS_CMD_LINK_PROBE_TIMEOUT, and lost otherwise. A server publishes only once it has moved
+ * past its deadband and its minimum interval has passed, and then reports the newest Set it
+ * applied, so a Status for exactly the probe is rare. The delivery ratio is a moving average over
+ * probe outcomes. The repeat count goes up by one when the ratio falls below the target, and down
+ * by one after the ratio has stayed at or above the target for @ref POS_CMD_LINK_BACKOFF_SAMPLES
+ * probes.
+ * @{
+ */
+
+/** Number of destinations tracked at the same time. */
+#ifndef POS_CMD_LINK_TABLE_SIZE
+#define POS_CMD_LINK_TABLE_SIZE (4)
+#endif
+
+/**
+ * Time a probe waits for a Status before it counts as lost. It must be longer than the minimum
+ * publish interval of the servers.
+ */
+#ifndef POS_CMD_LINK_PROBE_TIMEOUT
+#define POS_CMD_LINK_PROBE_TIMEOUT (SEC_TO_US(1))
+#endif
+
+/** Probes after a repeat count change before the count may go up again. */
+#ifndef POS_CMD_LINK_HOLD_SAMPLES
+#define POS_CMD_LINK_HOLD_SAMPLES (8)
+#endif
+
+/** Probes at or above the target delivery ratio before the repeat count goes down. */
+#ifndef POS_CMD_LINK_BACKOFF_SAMPLES
+#define POS_CMD_LINK_BACKOFF_SAMPLES (32)
+#endif
+
+NRF_MESH_STATIC_ASSERT(POS_CMD_LINK_HOLD_SAMPLES <= POS_CMD_LINK_BACKOFF_SAMPLES);
+NRF_MESH_STATIC_ASSERT(POS_CMD_LINK_BACKOFF_SAMPLES <= UINT8_MAX);
+
+/** Delivery ratio of one, the unit of @ref pos_cmd_link_t::delivery. */
+#define POS_CMD_LINK_DELIVERY_ONE (0xFFFF)
+
+/** Estimate for one destination. */
+typedef struct
+{
+    uint16_t address;       /**< Destination address, @c NRF_MESH_ADDR_UNASSIGNED if unused. */
+    uint16_t delivery;      /**< Moving average of the delivery ratio, in 1/@ref POS_CMD_LINK_DELIVERY_ONE. */
+    uint8_t repeats;        /**< Repeat count to use for the next message. */
+    uint8_t samples;        /**< Probes since the repeat count last changed. */
+    bool probe_pending;     /**< Set while a probe waits for its Status. */
+    uint8_t probe_tid;      /**< Transaction number of the probe. */
+    timestamp_t probe_sent; /**< Time the probe was sent. */
+} pos_cmd_link_t;
+
+/** Estimates for all tracked destinations. */
+typedef struct
+{
+    pos_cmd_link_t links[POS_CMD_LINK_TABLE_SIZE]; /**< Tracked destinations. */
+    uint8_t next;                                  /**< Entry to replace when a new destination is added. */
+} pos_cmd_link_table_t;
+
+/**
+ * Gets the estimate of a destination, replacing the oldest added destination if it is new.
+ *
+ * A new destination starts out at @p repeats_max repeats and is backed off from there.
+ *
+ * @param[in,out] p_table     Link table.
+ * @param[in]     address     Destination address.
+ * @param[in]     repeats_max Upper bound on the repeat count.
+ *
+ * @returns The estimate of the destination.
+ */
+pos_cmd_link_t * pos_cmd_link_get(pos_cmd_link_table_t * p_table, uint16_t address, uint8_t repeats_max);
+
+/**
+ * Resolves an expired probe as lost, and starts a new probe if none is pending.
+ *
+ * Only one probe is pending per destination, so a fast sender does not bias the estimate towards
+ * the messages that happen to be answered quickly.
+ *
+ * @param[in,out] p_link      Estimate of the destination.
+ * @param[in]     tid         Transaction number of the message being sent.
+ * @param[in]     probe       Whether the message can be a probe. A message that does not move the
+ *                            server produces no Status and must not be used as one.
+ * @param[in]     now         Current time.
+ * @param[in]     target      Delivery ratio to reach, in 1/@ref POS_CMD_LINK_DELIVERY_ONE.
+ * @param[in]     repeats_max Upper bound on the repeat count.
+ */
+void pos_cmd_link_sent(pos_cmd_link_t * p_link,
+                       uint8_t tid,
+                       bool probe,
+                       timestamp_t now,
+                       uint16_t target,
+                       uint8_t repeats_max);
+
+/**
+ * Resolves the pending probes answered by a Status.
+ *
+ * A probe is answered by a Status carrying its own transaction number or a later one, within
+ * half the transaction number range. A probe to a unicast address is only answered by that
+ * server, a probe to a group by the first member that reports. Only transaction numbers of Sets
+ * of the client that sent the probe may be passed in, and no replies to acknowledged requests.
+ *
+ * @param[in,out] p_table     Link table.
+ * @param[in]     src         Element address of the server that sent the Status.
+ * @param[in]     tid         Transaction number in the Status.
+ * @param[in]     now         Current time.
+ * @param[in]     target      Delivery ratio to reach, in 1/@ref POS_CMD_LINK_DELIVERY_ONE.
+ * @param[in]     repeats_max Upper bound on the repeat count.
+ */
+void pos_cmd_link_status_received(pos_cmd_link_table_t * p_table,
+                                  uint16_t src,
+                                  uint8_t tid,
+                                  timestamp_t now,
+                                  uint16_t target,
+                                  uint8_t repeats_max);
+
+/** @} end of POS_CMD_LINK */
+
+#endif /* POS_CMD_LINK_H__ */
@@ -6,6 +6,11 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "access.h"
+#include "timer.h"
+#include "timer_scheduler.h"
+#include "pos_cmd_common.h"
+#include "pos_cmd_trajectory.h"
+#include "pos_cmd_stats.h"
 
 /**
  * @defgroup POS_CMD_SERVER PosCmd Server
@@ -17,23 +22,117 @@
 /** PosCmd Server model ID. */
 #define POS_CMD_SERVER_MODEL_ID (0x0009)
 
+/** Number of (source address, TID) pairs remembered for duplicate filtering. */
+#ifndef POS_CMD_SERVER_TID_CACHE_SIZE
+#define POS_CMD_SERVER_TID_CACHE_SIZE (8)
+#endif
+
+/** Time a remembered (source address, TID) pair filters out repeated messages. */
+#ifndef POS_CMD_SERVER_TID_CACHE_WINDOW
+#define POS_CMD_SERVER_TID_CACHE_WINDOW (SEC_TO_US(6))
+#endif
+
+/** Number of clients whose Set Delta reference is kept at the same time. */
+#ifndef POS_CMD_SERVER_DELTA_REF_COUNT
+#define POS_CMD_SERVER_DELTA_REF_COUNT (4)
+#endif
+
+/** Interval at which setpoints of a running trajectory are handed to the application. */
+#ifndef POS_CMD_SERVER_CONTROL_INTERVAL
+#define POS_CMD_SERVER_CONTROL_INTERVAL (MS_TO_US(20))
+#endif
+
+/** Number of scheduled Sets a server holds at the same time. */
+#ifndef POS_CMD_SERVER_SCHEDULE_SIZE
+#define POS_CMD_SERVER_SCHEDULE_SIZE (4)
+#endif
+
 /** Forward declaration. */
 typedef struct __pos_cmd_server pos_cmd_server_t;
 
 /**
  * Get callback type.
  * @param[in] p_self Pointer to the PosCmd Server context structure.
- * @returns @c true if the state is On, @c false otherwise.
+ * @returns The present position.
  */
-typedef uint8_t * (*pos_cmd_get_cb_t)(const pos_cmd_server_t * p_self);
+typedef struct position_t (*pos_cmd_get_cb_t)(const pos_cmd_server_t * p_self);
 
 /**
  * Set callback type.
  * @param[in] p_self Pointer to the PosCmd Server context structure.
- * @param[in] on_off Desired state
- * @returns @c true if the current state is On, @c false otherwise.
+ * @param[in] target Desired target position.
+ * @returns The present position.
+ */
+typedef struct position_t (*pos_cmd_set_cb_t)(const pos_cmd_server_t * p_self, struct position_t target);
+
+/**
+ * Set batch callback type.
+ * @param[in] p_self    Pointer to the PosCmd Server context structure.
+ * @param[in] p_targets Desired target positions, in the order they were packed by the client.
+ * @param[in] count     Number of positions in @p p_targets.
  */
-typedef uint8_t * (*pos_cmd_set_cb_t)(const pos_cmd_server_t * p_self, uint8_t * com_data, uint16_t len);
+typedef void (*pos_cmd_set_batch_cb_t)(const pos_cmd_server_t * p_self,
+                                       const struct position_t * p_targets,
+                                       uint16_t count);
+
+/**
+ * Stop callback type.
+ *
+ * Called when a Stop is received, after any trajectory in progress was aborted. The application
+ * must halt all motion and hold its present position.
+ *
+ * @param[in] p_self Pointer to the PosCmd Server context structure.
+ * @returns The present position.
+ */
+typedef struct position_t (*pos_cmd_stop_cb_t)(const pos_cmd_server_t * p_self);
+
+/**
+ * Time base callback type.
+ * @param[in] p_self Pointer to the PosCmd Server context structure.
+ * @returns The time of the time base shared by all nodes, in milliseconds.
+ */
+typedef uint32_t (*pos_cmd_time_base_cb_t)(const pos_cmd_server_t * p_self);
+
+/** Set waiting for its execution time. */
+typedef struct
+{
+    bool active;              /**< Set while the entry is in use. */
+    uint8_t tid;              /**< Transaction number of the Set. */
+    struct position_t target; /**< Target to apply. */
+    timestamp_t timestamp;    /**< Local time to apply the target at. */
+} pos_cmd_server_scheduled_t;
+
+/** Recently received transaction, used to drop repeated copies of the same message. */
+typedef struct
+{
+    uint16_t src;          /**< Source address of the message. */
+    uint8_t tid;           /**< Transaction number of the message. */
+    timestamp_t timestamp; /**< Time the first copy was received. */
+} pos_cmd_server_tid_entry_t;
+
+/** Reference position of the Set Delta messages of one client, its newest acknowledged Set. */
+typedef struct
+{
+    uint16_t src;               /**< Client that sent the reference Set, unassigned if the entry is unused. */
+    uint8_t tid;                /**< Transaction number of the reference Set. */
+    struct position_t position; /**< Target of the reference Set. */
+    timestamp_t timestamp;      /**< Time the reference Set was received, the oldest entry is reused first. */
+} pos_cmd_server_delta_ref_t;
+
+/**
+ * Status publication policy.
+ *
+ * The present position is published when it has moved at least @c deadband from the last
+ * published position, but no more often than every @c min_interval. With @c max_interval set,
+ * it is also published when nothing was published for that long. The all-zero default publishes
+ * every change of the present position immediately.
+ */
+typedef struct
+{
+    uint16_t deadband;     /**< Minimum change of x or y that triggers a publication. */
+    uint32_t min_interval; /**< Minimum time between two publications, in microseconds. */
+    uint32_t max_interval; /**< Maximum time between two publications in microseconds, 0 to disable. */
+} pos_cmd_server_publish_config_t;
 
 /** PosCmd Server state structure. */
 struct __pos_cmd_server
@@ -44,6 +143,65 @@ struct __pos_cmd_server
     pos_cmd_get_cb_t get_cb;
     /** Set callback. */
     pos_cmd_set_cb_t set_cb;
+    /**
+     * Set batch callback, also given every path streamed in with Path Chunk messages. Optional, if
+     * NULL @ref set_cb is called once per position.
+     */
+    pos_cmd_set_batch_cb_t set_batch_cb;
+    /** Stop callback. Optional, if NULL @ref set_cb is called with the present position. */
+    pos_cmd_stop_cb_t stop_cb;
+    /**
+     * Time base callback. Optional, without it only delays are supported: a Set Scheduled message
+     * with an absolute execution time is not scheduled, and answered at once with a Status
+     * carrying the present position.
+     */
+    pos_cmd_time_base_cb_t time_base_cb;
+    /** Status publication policy applied by @ref pos_cmd_server_present_update. */
+    pos_cmd_server_publish_config_t publish_config;
+    /**
+     * Defer commands to @ref pos_cmd_server_process. When set, the opcode handlers and timers never
+     * call the application callbacks. They queue the command and reply with the present position
+     * last given to @ref pos_cmd_server_present_update.
+     */
+    bool deferred;
+    /** Internal server state. */
+    struct
+    {
+        uint8_t tid; /**< Transaction number of the last applied Set. */
+        pos_cmd_server_tid_entry_t tid_cache[POS_CMD_SERVER_TID_CACHE_SIZE]; /**< Recent transactions. */
+        uint8_t tid_cache_next; /**< Next TID cache entry to overwrite. */
+        struct position_t present;   /**< Last reported present position. */
+        struct position_t published; /**< Last published present position. */
+        timestamp_t publish_timestamp; /**< Time of the last publication. */
+        bool published_once;         /**< Set after the first publication. */
+        bool publish_pending;        /**< Set while a publication waits for the minimum interval. */
+        timer_event_t publish_timer; /**< Timer for held back and periodic publications. */
+        pos_cmd_server_delta_ref_t delta_refs[POS_CMD_SERVER_DELTA_REF_COUNT]; /**< Set Delta reference per client. */
+        pos_cmd_trajectory_t trajectory; /**< Trajectory being executed. */
+        timer_event_t control_timer;     /**< Timer generating trajectory setpoints. */
+        pos_cmd_server_scheduled_t scheduled[POS_CMD_SERVER_SCHEDULE_SIZE]; /**< Scheduled Sets. */
+        timer_event_t schedule_timer;    /**< Timer for the next scheduled Set. */
+        struct
+        {
+            bool stop;                /**< Set while a Stop waits to be applied. */
+            bool target_valid;        /**< Set while a target waits to be applied. */
+            struct position_t target; /**< Latest target, it replaces any target not yet applied. */
+            bool path_valid;          /**< Set while the reassembled path waits to be applied. */
+            bool path_busy;           /**< Set while the reassembled path is handed to the application. */
+        } queue;                      /**< Commands waiting for @ref pos_cmd_server_process. */
+        struct
+        {
+            bool active;              /**< Set while a path is reassembled, and after it completed. */
+            uint16_t src;             /**< Client sending the path. */
+            uint8_t tid;              /**< Transaction number of the path. */
+            uint8_t last;             /**< Number of the last chunk. */
+            uint16_t chunks;          /**< Number of chunks received. */
+            uint16_t count;           /**< Number of points, known once the last chunk has arrived. */
+            uint32_t received[POS_CMD_PATH_CHUNK_WORDS];        /**< Chunks received, one bit per chunk. */
+            struct position_t points[POS_CMD_PATH_POINTS_MAX];  /**< Points reassembled so far. */
+        } path;                       /**< Path streamed in with Path Chunk messages. */
+        pos_cmd_stats_t stats;           /**< Message statistics. */
+    } state;
 };
 
 /**
@@ -70,7 +228,7 @@ uint32_t pos_cmd_server_init(pos_cmd_server_t * p_server, uint16_t element_index
  * of local action.
  *
  * @param[in]  p_server         PosCmd Server structure pointer
- * @param[in]  value            Current on/off value to be published
+ * @param[in]  present          Present position to be published
  *
  * @retval NRF_SUCCESS              Successfully queued packet for transmission.
  * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
@@ -83,7 +241,77 @@ uint32_t pos_cmd_server_init(pos_cmd_server_t * p_server, uint16_t element_index
  * @retval NRF_ERROR_INVALID_LENGTH Attempted to send message larger than @ref ACCESS_MESSAGE_LENGTH_MAX.
  *
  */
-uint32_t pos_cmd_server_status_publish(pos_cmd_server_t * p_server, uint8_t * value);
+uint32_t pos_cmd_server_status_publish(pos_cmd_server_t * p_server, struct position_t present);
+
+/**
+ * Reports the present position of the server.
+ *
+ * Call this whenever the actuator has moved. The position is published according to
+ * @ref __pos_cmd_server::publish_config. The server also calls this with the position returned
+ * from the Set callbacks.
+ *
+ * @param[in] p_server PosCmd Server structure pointer.
+ * @param[in] present  Present position.
+ */
+void pos_cmd_server_present_update(pos_cmd_server_t * p_server, struct position_t present);
+
+/**
+ * Gets the statistics of the server.
+ *
+ * Clients can fetch the same numbers remotely with the PosCmd Stats Get message.
+ *
+ * @param[in] p_server PosCmd Server structure pointer.
+ *
+ * @returns Pointer to the statistics.
+ */
+const pos_cmd_stats_t * pos_cmd_server_stats_get(const pos_cmd_server_t * p_server);
+
+/**
+ * Resets the statistics of the server.
+ *
+ * @param[in,out] p_server PosCmd Server structure pointer.
+ */
+void pos_cmd_server_stats_reset(pos_cmd_server_t * p_server);
+
+/**
+ * Checks whether a message repeats a transaction received within
+ * @ref POS_CMD_SERVER_TID_CACHE_WINDOW, and remembers it if not.
+ *
+ * The duplicate check of every PosCmd server, also used by the servers of
+ * @ref POS_CMD_TYPED_MODEL. Each received copy is traced, and duplicates are counted.
+ *
+ * @param[in,out] p_cache   Transaction cache of @ref POS_CMD_SERVER_TID_CACHE_SIZE entries.
+ * @param[in,out] p_next    Next cache entry to overwrite.
+ * @param[in,out] p_stats   Statistics of the server.
+ * @param[in]     p_message Received message.
+ * @param[in]     tid       Transaction number of the message.
+ *
+ * @returns @c true if the message is a duplicate, @c false if it is new.
+ */
+bool pos_cmd_server_tid_is_duplicate(pos_cmd_server_tid_entry_t * p_cache,
+                                     uint8_t * p_next,
+                                     pos_cmd_stats_t * p_stats,
+                                     const access_message_rx_t * p_message,
+                                     uint8_t tid);
+
+/**
+ * Applies the commands queued while @ref __pos_cmd_server::deferred is set.
+ *
+ * Targets are collapsed latest-wins: only the newest target received since the last call is
+ * handed to @ref __pos_cmd_server::set_cb, and batches are applied as their last target. A path
+ * completed with Path Chunk messages is handed over whole, like outside deferred mode, and no new
+ * path is accepted until it has been. A Stop is applied before any command received after it, and
+ * drops those received before. The resulting present position is reported with
+ * @ref pos_cmd_server_present_update.
+ *
+ * @note Call this function regularly from the application's main loop, in a context where mesh
+ *       API calls are allowed.
+ *
+ * @param[in,out] p_server PosCmd Server structure pointer.
+ *
+ * @returns @c true if a command was applied, @c false if the queue was empty.
+ */
+bool pos_cmd_server_process(pos_cmd_server_t * p_server);
 
 /** @} end of POS_CMD_SERVER */
 
@@ -0,0 +1,63 @@
+#ifndef POS_CMD_STATS_H__
+#define POS_CMD_STATS_H__
+
+#include <stdint.h>
+
+/**
+ * @defgroup POS_CMD_STATS PosCmd statistics
+ * @ingroup POS_CMD_MODEL
+ * Fixed-size message counters kept by the PosCmd Client and Server.
+ *
+ * The structure is also the payload of the PosCmd Stats Status message, so its layout is part of
+ * the wire format. It only holds @c uint32_t fields and therefore has no padding.
+ * @{
+ */
+
+/** First opcode counted per opcode, see @ref pos_cmd_opcode_t. */
+#define POS_CMD_STATS_OPCODE_FIRST (0xC1)
+/** Number of consecutive opcodes counted per opcode. */
+#define POS_CMD_STATS_OPCODE_COUNT (17)
+/** Number of round-trip latency histogram buckets. */
+#define POS_CMD_STATS_RTT_BUCKETS  (8)
+/** Upper bound of the first round-trip latency bucket in milliseconds, doubled for every following bucket. */
+#define POS_CMD_STATS_RTT_BUCKET_FIRST_MS (16)
+
+/** Model statistics. */
+typedef struct
+{
+    uint32_t tx[POS_CMD_STATS_OPCODE_COUNT]; /**< Messages sent, per opcode. Repeats and retransmissions included. */
+    uint32_t rx[POS_CMD_STATS_OPCODE_COUNT]; /**< Messages received, per opcode. Duplicates included. */
+    uint32_t retransmissions;  /**< Acknowledged requests sent again for lack of a reply. */
+    uint32_t timeouts;         /**< Acknowledged transactions that timed out. */
+    uint32_t cancellations;    /**< Acknowledged transactions that were cancelled. */
+    uint32_t duplicates;       /**< Received messages dropped as duplicates. */
+    uint32_t publish_failures; /**< Sends rejected by the access layer, e.g. with @c NRF_ERROR_NO_MEM. */
+    uint32_t rtt[POS_CMD_STATS_RTT_BUCKETS]; /**< Round-trip latency histogram of acknowledged transactions.
+                                                  The last bucket holds everything above the others. */
+} pos_cmd_stats_t;
+
+/**
+ * Counts a message for its opcode.
+ *
+ * @param[in,out] p_counters Per opcode counters, @ref pos_cmd_stats_t::tx or @ref pos_cmd_stats_t::rx.
+ * @param[in]     opcode     Opcode of the message. Opcodes outside the counted range are ignored.
+ */
+static inline void pos_cmd_stats_opcode_count(uint32_t * p_counters, uint16_t opcode)
+{
+    if (opcode >= POS_CMD_STATS_OPCODE_FIRST && opcode < POS_CMD_STATS_OPCODE_FIRST + POS_CMD_STATS_OPCODE_COUNT)
+    {
+        p_counters[opcode - POS_CMD_STATS_OPCODE_FIRST]++;
+    }
+}
+
+/**
+ * Records the round-trip latency of an acknowledged transaction.
+ *
+ * @param[in,out] p_stats Statistics.
+ * @param[in]     rtt_us  Round-trip latency in microseconds.
+ */
+void pos_cmd_stats_rtt_record(pos_cmd_stats_t * p_stats, uint32_t rtt_us);
+
+/** @} end of POS_CMD_STATS */
+
+#endif /* POS_CMD_STATS_H__ */
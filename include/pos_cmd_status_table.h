@@ -0,0 +1,162 @@
+#ifndef POS_CMD_STATUS_TABLE_H__
+#define POS_CMD_STATUS_TABLE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "nrf_mesh_assert.h"
+#include "pos_cmd_common.h"
+
+/**
+ * @defgroup POS_CMD_STATUS_TABLE PosCmd status table
+ * @ingroup POS_CMD_MODEL
+ * Last reported state of every PosCmd Server a client talks to, keyed by element address.
+ *
+ * The table is an open addressing hash table with linear probing. Entries are never removed
+ * individually; @ref pos_cmd_status_table_clear empties the whole table.
+ * @{
+ */
+
+/** Number of servers the table can hold. Must be a power of two. */
+#ifndef POS_CMD_STATUS_TABLE_SIZE
+#define POS_CMD_STATUS_TABLE_SIZE (32)
+#endif
+
+/** Shortest time between two Status messages used to estimate the velocity of a server. */
+#ifndef POS_CMD_STATUS_TABLE_VELOCITY_MIN_INTERVAL
+#define POS_CMD_STATUS_TABLE_VELOCITY_MIN_INTERVAL (MS_TO_US(10))
+#endif
+
+NRF_MESH_STATIC_ASSERT((POS_CMD_STATUS_TABLE_SIZE & (POS_CMD_STATUS_TABLE_SIZE - 1)) == 0);
+
+/** State reported by one server. */
+typedef struct
+{
+    uint16_t address;          /**< Element address of the server, @c NRF_MESH_ADDR_UNASSIGNED if unused. */
+    bool reported;             /**< Set once the server has reported its state. */
+    uint8_t tid;               /**< Transaction number of the last reported Status. */
+    bool set_confirmed;        /**< Set once the server has confirmed a Set of this client. */
+    uint8_t set_tid;           /**< Transaction number of the newest Set of this client the server confirmed. */
+    struct position_t present; /**< Last reported present position. */
+    timestamp_t timestamp;     /**< Time the last Status was received. */
+    int32_t velocity_x;        /**< Estimated velocity along x, in position units per second. */
+    int32_t velocity_y;        /**< Estimated velocity along y, in position units per second. */
+    bool set_sent;             /**< Set once a Set has been sent to the server. */
+    timestamp_t set_timestamp; /**< Time the last Set was sent to the server. */
+} pos_cmd_status_entry_t;
+
+/** Status table. */
+typedef struct
+{
+    pos_cmd_status_entry_t entries[POS_CMD_STATUS_TABLE_SIZE]; /**< Hash buckets. */
+    uint16_t count;                                            /**< Number of servers in the table. */
+} pos_cmd_status_table_t;
+
+/**
+ * Iteration callback type.
+ *
+ * @param[in] p_entry   Table entry.
+ * @param[in] p_context Context passed to @ref pos_cmd_status_table_foreach.
+ */
+typedef void (*pos_cmd_status_table_cb_t)(const pos_cmd_status_entry_t * p_entry, void * p_context);
+
+/**
+ * Empties the table.
+ *
+ * @param[out] p_table Status table.
+ */
+void pos_cmd_status_table_clear(pos_cmd_status_table_t * p_table);
+
+/**
+ * Adds a server to the table, or finds it if already present.
+ *
+ * @param[in,out] p_table Status table.
+ * @param[in]     address Element address of the server.
+ *
+ * @returns The entry of the server, or NULL if the table is full.
+ */
+pos_cmd_status_entry_t * pos_cmd_status_table_add(pos_cmd_status_table_t * p_table, uint16_t address);
+
+/**
+ * Finds a server in the table.
+ *
+ * @param[in] p_table Status table.
+ * @param[in] address Element address of the server.
+ *
+ * @returns The entry of the server, or NULL if it is not in the table.
+ */
+pos_cmd_status_entry_t * pos_cmd_status_table_find(const pos_cmd_status_table_t * p_table, uint16_t address);
+
+/**
+ * Records a Status reported by a server and updates its velocity estimate.
+ *
+ * The velocity is the displacement since the previous Status divided by the time between them.
+ * Status messages closer together than @ref POS_CMD_STATUS_TABLE_VELOCITY_MIN_INTERVAL, such as
+ * a reply right after a publication, update the position but keep the previous velocity.
+ *
+ * @param[in,out] p_entry   Entry of the server.
+ * @param[in]     tid       Transaction number in the Status.
+ * @param[in]     present   Present position in the Status.
+ * @param[in]     timestamp Time the Status was received.
+ */
+void pos_cmd_status_table_report(pos_cmd_status_entry_t * p_entry,
+                                 uint8_t tid,
+                                 struct position_t present,
+                                 timestamp_t timestamp);
+
+/**
+ * Records that a server confirmed a Set of this client, by reporting its transaction number.
+ *
+ * Only the client knows which transaction numbers belong to its own Sets. A Status replying to a
+ * Get or Stop, or published after another client's Set, must not be recorded here.
+ *
+ * @param[in,out] p_entry Entry of the server.
+ * @param[in]     tid     Transaction number of the Set.
+ */
+void pos_cmd_status_table_set_confirm(pos_cmd_status_entry_t * p_entry, uint8_t tid);
+
+/**
+ * Predicts the position of a server from its last Status and estimated velocity.
+ *
+ * @param[in] p_entry   Entry of the server, which must have reported.
+ * @param[in] timestamp Time to predict the position at.
+ *
+ * @returns Predicted position, saturated to the range of a coordinate.
+ */
+struct position_t pos_cmd_status_table_predict(const pos_cmd_status_entry_t * p_entry, timestamp_t timestamp);
+
+/**
+ * Calls a function for every server in the table.
+ *
+ * @param[in] p_table   Status table.
+ * @param[in] cb        Function to call.
+ * @param[in] p_context Context passed to @p cb.
+ */
+void pos_cmd_status_table_foreach(const pos_cmd_status_table_t * p_table, pos_cmd_status_table_cb_t cb, void * p_context);
+
+/**
+ * Lists the servers that have not caught up with a given transaction.
+ *
+ * A server has caught up once it confirmed the Set @p tid or a later Set of the same client,
+ * within half the transaction number range, see @ref pos_cmd_status_table_set_confirm. A server
+ * that was already at the target of a Set does not move, so it publishes no Status for it. If
+ * @p p_target is given, a server that last reported being at it has caught up as well.
+ *
+ * @param[in]  p_table     Status table.
+ * @param[in]  tid         Transaction number to check for.
+ * @param[in]  p_target    Target of the transaction, or NULL to check the transaction number only.
+ * @param[out] p_addresses Buffer for the addresses of the stragglers, may be NULL if @p max is 0.
+ * @param[in]  max         Number of addresses that fit in @p p_addresses.
+ *
+ * @returns Number of stragglers, which may be larger than @p max. Zero means every server in the
+ *          table has caught up with @p tid.
+ */
+uint16_t pos_cmd_status_table_stragglers_get(const pos_cmd_status_table_t * p_table,
+                                             uint8_t tid,
+                                             const struct position_t * p_target,
+                                             uint16_t * p_addresses,
+                                             uint16_t max);
+
+/** @} end of POS_CMD_STATUS_TABLE */
+
+#endif /* POS_CMD_STATUS_TABLE_H__ */
@@ -0,0 +1,146 @@
+#ifndef POS_CMD_TRACE_H__
+#define POS_CMD_TRACE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nrf_mesh.h"
+#include "nrf_mesh_assert.h"
+
+/**
+ * @defgroup POS_CMD_TRACE PosCmd trace
+ * @ingroup POS_CMD_MODEL
+ * Compact binary trace of the messages handled by the PosCmd models.
+ *
+ * The models write fixed-size records into a ring buffer without formatting anything. The
+ * application drains the buffer later, e.g. from its main loop, with @ref pos_cmd_trace_read or
+ * @ref pos_cmd_trace_flush. Records are written from API calls, timer callbacks and opcode
+ * handlers, each with interrupts masked for the few stores it takes, so writers in different
+ * interrupt contexts do not interleave. Reading takes no lock, but only one context may read.
+ * When the buffer is full, new records are dropped and counted.
+ *
+ * Tracing is selected at compile time with @ref POS_CMD_TRACE_LEVEL. At
+ * @ref POS_CMD_TRACE_LEVEL_NONE the trace calls and the buffer compile out entirely.
+ * @{
+ */
+
+/** No tracing. */
+#define POS_CMD_TRACE_LEVEL_NONE  (0)
+/** Trace failed sends, timeouts, cancellations and dropped messages. */
+#define POS_CMD_TRACE_LEVEL_ERROR (1)
+/** Trace every message sent and received as well. */
+#define POS_CMD_TRACE_LEVEL_ALL   (2)
+
+/** Compile-time trace level. */
+#ifndef POS_CMD_TRACE_LEVEL
+#define POS_CMD_TRACE_LEVEL POS_CMD_TRACE_LEVEL_NONE
+#endif
+
+/** Number of records in the trace buffer. Must be a power of two. */
+#ifndef POS_CMD_TRACE_BUFFER_SIZE
+#define POS_CMD_TRACE_BUFFER_SIZE (64)
+#endif
+
+NRF_MESH_STATIC_ASSERT((POS_CMD_TRACE_BUFFER_SIZE & (POS_CMD_TRACE_BUFFER_SIZE - 1)) == 0);
+
+/**
+ * @defgroup POS_CMD_TRACE_STATUS Trace record status values
+ * Sent messages record the error code returned by the access layer. Other events use the values
+ * below, which are above every error code of the mesh stack.
+ * @{
+ */
+#define POS_CMD_TRACE_STATUS_RX        (0xF0) /**< Message received. */
+#define POS_CMD_TRACE_STATUS_DUPLICATE (0xF1) /**< Received message dropped as a duplicate. */
+#define POS_CMD_TRACE_STATUS_TIMEOUT   (0xF2) /**< Acknowledged transaction timed out. */
+#define POS_CMD_TRACE_STATUS_CANCELLED (0xF3) /**< Acknowledged transaction cancelled. */
+/** @} */
+
+/** Trace record. */
+typedef struct
+{
+    uint32_t timestamp; /**< Time of the event, in microseconds. */
+    uint8_t opcode;     /**< Vendor opcode of the message. */
+    uint8_t tid;        /**< Transaction number of the message. */
+    uint8_t length;     /**< Message length, saturated at 255. */
+    uint8_t status;     /**< Access layer error code, or one of @ref POS_CMD_TRACE_STATUS. */
+} pos_cmd_trace_record_t;
+
+#if POS_CMD_TRACE_LEVEL > POS_CMD_TRACE_LEVEL_NONE
+
+/**
+ * Writes a trace record. Use the POS_CMD_TRACE_* macros instead, so the call compiles out.
+ *
+ * @param[in] opcode Vendor opcode of the message.
+ * @param[in] tid    Transaction number of the message.
+ * @param[in] length Message length.
+ * @param[in] status Access layer error code, or one of @ref POS_CMD_TRACE_STATUS.
+ */
+void pos_cmd_trace_record(uint8_t opcode, uint8_t tid, uint16_t length, uint32_t status);
+
+/**
+ * Reads the oldest trace record.
+ *
+ * @param[out] p_record Record read.
+ *
+ * @returns @c true if a record was read, @c false if the buffer is empty.
+ */
+bool pos_cmd_trace_read(pos_cmd_trace_record_t * p_record);
+
+/**
+ * Gets the number of records dropped because the buffer was full.
+ *
+ * @returns Number of dropped records.
+ */
+uint32_t pos_cmd_trace_dropped_get(void);
+
+/** Reads every record in the buffer and logs it in readable form. */
+void pos_cmd_trace_flush(void);
+
+#else
+
+static inline bool pos_cmd_trace_read(pos_cmd_trace_record_t * p_record)
+{
+    (void) p_record;
+    return false;
+}
+
+static inline uint32_t pos_cmd_trace_dropped_get(void)
+{
+    return 0;
+}
+
+static inline void pos_cmd_trace_flush(void)
+{
+}
+
+#endif
+
+#if POS_CMD_TRACE_LEVEL >= POS_CMD_TRACE_LEVEL_ALL
+/** Traces a sent message. */
+#define POS_CMD_TRACE_TX(opcode, tid, length, status) pos_cmd_trace_record((opcode), (tid), (length), (status))
+/** Traces a received message. */
+#define POS_CMD_TRACE_RX(opcode, tid, length) pos_cmd_trace_record((opcode), (tid), (length), POS_CMD_TRACE_STATUS_RX)
+#elif POS_CMD_TRACE_LEVEL >= POS_CMD_TRACE_LEVEL_ERROR
+#define POS_CMD_TRACE_TX(opcode, tid, length, status)                   \
+    do {                                                                \
+        uint32_t trace_status_ = (status);                              \
+        if (trace_status_ != NRF_SUCCESS)                               \
+        {                                                               \
+            pos_cmd_trace_record((opcode), (tid), (length), trace_status_); \
+        }                                                               \
+    } while (0)
+#define POS_CMD_TRACE_RX(opcode, tid, length) do {} while (0)
+#else
+#define POS_CMD_TRACE_TX(opcode, tid, length, status) do {} while (0)
+#define POS_CMD_TRACE_RX(opcode, tid, length) do {} while (0)
+#endif
+
+#if POS_CMD_TRACE_LEVEL >= POS_CMD_TRACE_LEVEL_ERROR
+/** Traces a timeout, cancellation or dropped message. */
+#define POS_CMD_TRACE_EVENT(opcode, tid, length, status) pos_cmd_trace_record((opcode), (tid), (length), (status))
+#else
+#define POS_CMD_TRACE_EVENT(opcode, tid, length, status) do {} while (0)
+#endif
+
+/** @} end of POS_CMD_TRACE */
+
+#endif /* POS_CMD_TRACE_H__ */
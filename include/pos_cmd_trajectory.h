@@ -0,0 +1,70 @@
+#ifndef POS_CMD_TRAJECTORY_H__
+#define POS_CMD_TRAJECTORY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timer.h"
+#include "pos_cmd_common.h"
+
+/**
+ * @defgroup POS_CMD_TRAJECTORY PosCmd trajectory interpolator
+ * @ingroup POS_CMD_MODEL
+ * Linear interpolation along a list of waypoints, used by the PosCmd Server to generate
+ * setpoints locally at a fixed control rate.
+ *
+ * The trajectory starts at the present position and visits every waypoint in turn, spending the
+ * same leg time on each leg.
+ * @{
+ */
+
+/** Maximum number of waypoints in one trajectory. */
+#ifndef POS_CMD_TRAJECTORY_WAYPOINTS_MAX
+#define POS_CMD_TRAJECTORY_WAYPOINTS_MAX (POS_CMD_BATCH_POSITIONS_MAX)
+#endif
+
+/** Trajectory state. */
+typedef struct
+{
+    struct position_t waypoints[POS_CMD_TRAJECTORY_WAYPOINTS_MAX]; /**< Waypoints to visit. */
+    uint8_t count;          /**< Number of waypoints. */
+    uint8_t index;          /**< Waypoint the current leg leads to. */
+    struct position_t from; /**< Start of the current leg. */
+    timestamp_t leg_start;  /**< Time the current leg started. */
+    uint32_t leg_time;      /**< Duration of each leg, in microseconds. */
+    bool active;            /**< Set while the trajectory is being executed. */
+} pos_cmd_trajectory_t;
+
+/**
+ * Starts a trajectory.
+ *
+ * @param[out] p_trajectory Trajectory state.
+ * @param[in]  start        Present position, the start of the first leg.
+ * @param[in]  p_waypoints  Waypoints, copied into @p p_trajectory.
+ * @param[in]  count        Number of waypoints, at most @ref POS_CMD_TRAJECTORY_WAYPOINTS_MAX.
+ * @param[in]  leg_time     Duration of each leg, in microseconds.
+ * @param[in]  now          Current time.
+ */
+void pos_cmd_trajectory_start(pos_cmd_trajectory_t * p_trajectory,
+                              struct position_t start,
+                              const struct position_t * p_waypoints,
+                              uint8_t count,
+                              uint32_t leg_time,
+                              timestamp_t now);
+
+/**
+ * Gets the setpoint of an active trajectory at a given time.
+ *
+ * @param[in,out] p_trajectory Trajectory state.
+ * @param[in]     now          Current time, not earlier than the previous call.
+ * @param[out]    p_setpoint   Interpolated setpoint.
+ *
+ * @returns @c true while the trajectory continues, @c false when @p p_setpoint is the final
+ *          waypoint. The trajectory is then no longer active.
+ */
+bool pos_cmd_trajectory_sample(pos_cmd_trajectory_t * p_trajectory,
+                               timestamp_t now,
+                               struct position_t * p_setpoint);
+
+/** @} end of POS_CMD_TRAJECTORY */
+
+#endif /* POS_CMD_TRAJECTORY_H__ */
@@ -0,0 +1,58 @@
+#ifndef POS_CMD_TX_POOL_H__
+#define POS_CMD_TX_POOL_H__
+
+#include <stdint.h>
+#include "nrf_mesh_assert.h"
+#include "pos_cmd_common.h"
+
+/**
+ * @defgroup POS_CMD_TX_POOL PosCmd TX buffer pool
+ * @ingroup POS_CMD_MODEL
+ * Fixed-capacity pool of message buffers shared by all PosCmd Client instances.
+ *
+ * Acknowledged requests are encoded once into a pool buffer when they are issued. The buffer is
+ * owned by the model until the transaction ends, so callers never need to keep payloads alive.
+ * Allocation and release mask interrupts briefly, so clients may run in different interrupt
+ * contexts.
+ * @{
+ */
+
+/** Number of buffers in the pool. */
+#ifndef POS_CMD_TX_POOL_SLOT_COUNT
+#define POS_CMD_TX_POOL_SLOT_COUNT (8)
+#endif
+
+/** Size of each buffer in the pool. */
+#ifndef POS_CMD_TX_POOL_SLOT_SIZE
+#define POS_CMD_TX_POOL_SLOT_SIZE (POS_CMD_UNSEGMENTED_PARAMS_MAX)
+#endif
+
+NRF_MESH_STATIC_ASSERT(POS_CMD_TX_POOL_SLOT_COUNT > 0 && POS_CMD_TX_POOL_SLOT_COUNT <= 32);
+
+/**
+ * Allocates a buffer.
+ *
+ * @param[in] length Number of bytes needed.
+ *
+ * @returns Pointer to the buffer, or NULL if @p length exceeds @ref POS_CMD_TX_POOL_SLOT_SIZE or
+ *          every buffer is in use.
+ */
+uint8_t * pos_cmd_tx_pool_alloc(uint16_t length);
+
+/**
+ * Returns a buffer to the pool.
+ *
+ * @param[in] p_buffer Buffer returned by @ref pos_cmd_tx_pool_alloc.
+ */
+void pos_cmd_tx_pool_release(uint8_t * p_buffer);
+
+/**
+ * Gets the number of free buffers.
+ *
+ * @returns Number of buffers that can currently be allocated.
+ */
+uint32_t pos_cmd_tx_pool_available(void);
+
+/** @} end of POS_CMD_TX_POOL */
+
+#endif /* POS_CMD_TX_POOL_H__ */
@@ -0,0 +1,276 @@
+#ifndef POS_CMD_TYPED_MODEL_H__
+#define POS_CMD_TYPED_MODEL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "access.h"
+#include "nrf_mesh.h"
+#include "nrf_mesh_assert.h"
+#include "pos_cmd_common.h"
+#include "pos_cmd_server.h"
+#include "pos_cmd_stats.h"
+#include "pos_cmd_trace.h"
+#include "pos_cmd_capture.h"
+
+/**
+ * @defgroup POS_CMD_TYPED_MODEL PosCmd typed models
+ * @ingroup POS_CMD_MODEL
+ * Header-only generator for PosCmd-style servers carrying a fixed-layout payload type.
+ *
+ * @ref POS_CMD_TYPED_MODEL_DECLARE declares, for a payload type, the message layout, its encoder
+ * and decoder, typed callbacks and the server structure. @ref POS_CMD_TYPED_MODEL_DEFINE generates
+ * the opcode handlers, the opcode table and the server functions, and must be used in exactly one
+ * source file.
+ *
+ * Every message carries the payload followed by a transaction number, and is checked at build time
+ * to fit an unsegmented access PDU. The payload type must be packed, so the decoder can hand the
+ * callbacks a pointer into the received message instead of a copy. A message is accepted if and
+ * only if its length matches the layout exactly.
+ *
+ * @code
+ * typedef struct __attribute((packed))
+ * {
+ *     int16_t angle[3];
+ * } arm_pose_t;
+ *
+ * // arm_model.h
+ * POS_CMD_TYPED_MODEL_DECLARE(arm, arm_pose_t);
+ *
+ * // arm_model.c
+ * POS_CMD_TYPED_MODEL_DEFINE(arm, arm_pose_t, 0x0010, 0xE0, 0xE1, 0xE2, 0xE3);
+ * @endcode
+ *
+ * The example declares @c arm_server_t, @c arm_msg_t, @c arm_encode, @c arm_decode,
+ * @c arm_server_init and @c arm_server_status_publish.
+ * @{
+ */
+
+/**
+ * Declares a typed model.
+ *
+ * Declares:
+ * - @c name_msg_t: message layout, the payload followed by a transaction number.
+ * - @c name_decode: returns the message in a received access message, or NULL if the length does
+ *   not match.
+ * - @c name_encode: writes a message into a buffer of @c sizeof(name_msg_t) bytes and returns its
+ *   length.
+ * - @c name_set_cb_t and @c name_get_cb_t: set and get callbacks, returning the present value.
+ * - @c name_server_t: server structure. Set @c set_cb and @c get_cb before initializing it. Its
+ *   @c state holds the transaction number of the last applied Set, the transaction cache and the
+ *   @ref pos_cmd_stats_t of the server.
+ * - @c name_server_init and @c name_server_status_publish.
+ *
+ * @param[in] name    Prefix of the declared types and functions.
+ * @param[in] value_t Payload type. Must be packed and fit an unsegmented message with the
+ *                    transaction number.
+ */
+#define POS_CMD_TYPED_MODEL_DECLARE(name, value_t)                                                  \
+    NRF_MESH_STATIC_ASSERT(__alignof__(value_t) == 1);                                              \
+                                                                                                    \
+    typedef struct __attribute((packed))                                                            \
+    {                                                                                               \
+        value_t value;                                                                              \
+        uint8_t tid;                                                                                \
+    } name##_msg_t;                                                                                 \
+                                                                                                    \
+    NRF_MESH_STATIC_ASSERT(sizeof(name##_msg_t) <= POS_CMD_UNSEGMENTED_PARAMS_MAX);                 \
+                                                                                                    \
+    typedef struct name##_server name##_server_t;                                                   \
+    typedef value_t (*name##_set_cb_t)(const name##_server_t * p_self, const value_t * p_target);   \
+    typedef value_t (*name##_get_cb_t)(const name##_server_t * p_self);                             \
+                                                                                                    \
+    struct name##_server                                                                            \
+    {                                                                                               \
+        access_model_handle_t model_handle;                                                         \
+        name##_set_cb_t set_cb;                                                                     \
+        name##_get_cb_t get_cb;                                                                     \
+        struct                                                                                      \
+        {                                                                                           \
+            uint8_t tid;                                                                            \
+            pos_cmd_server_tid_entry_t tid_cache[POS_CMD_SERVER_TID_CACHE_SIZE];                    \
+            uint8_t tid_cache_next;                                                                 \
+            pos_cmd_stats_t stats;                                                                  \
+        } state;                                                                                    \
+    };                                                                                              \
+                                                                                                    \
+    static inline const name##_msg_t * name##_decode(const access_message_rx_t * p_message)         \
+    {                                                                                               \
+        return (p_message->length == sizeof(name##_msg_t)) ?                                        \
+               (const name##_msg_t *) p_message->p_data : NULL;                                     \
+    }                                                                                               \
+                                                                                                    \
+    static inline uint16_t name##_encode(uint8_t * p_buffer, const value_t * p_value, uint8_t tid)  \
+    {                                                                                               \
+        name##_msg_t * p_msg = (name##_msg_t *) p_buffer;                                           \
+        memcpy(&p_msg->value, p_value, sizeof(value_t));                                            \
+        p_msg->tid = tid;                                                                           \
+        return sizeof(name##_msg_t);                                                                \
+    }                                                                                               \
+                                                                                                    \
+    uint32_t name##_server_init(name##_server_t * p_server, uint16_t element_index);                \
+    uint32_t name##_server_status_publish(name##_server_t * p_server, const value_t * p_present)
+
+/**
+ * Defines a typed model declared with @ref POS_CMD_TYPED_MODEL_DECLARE.
+ *
+ * The server answers an acknowledged Set and a Get with a Status carrying the present value, and
+ * applies an unacknowledged Set without answering. Repeated copies of a Set are found with
+ * @ref pos_cmd_server_tid_is_duplicate, like in the other PosCmd servers, and are answered but not
+ * applied again. Gets use the @ref pos_cmd_msg_get_t layout. Messages are counted, traced and
+ * captured like those of the other servers.
+ *
+ * @param[in] name                  Prefix given to @ref POS_CMD_TYPED_MODEL_DECLARE.
+ * @param[in] value_t               Payload type given to @ref POS_CMD_TYPED_MODEL_DECLARE.
+ * @param[in] vendor_model_id       Vendor model ID of the server.
+ * @param[in] opcode_set            Vendor opcode of the acknowledged Set.
+ * @param[in] opcode_set_unreliable Vendor opcode of the unacknowledged Set.
+ * @param[in] opcode_get            Vendor opcode of the Get.
+ * @param[in] opcode_status         Vendor opcode of the Status.
+ */
+#define POS_CMD_TYPED_MODEL_DEFINE(name, value_t, vendor_model_id,                                  \
+                                   opcode_set, opcode_set_unreliable, opcode_get, opcode_status)    \
+    static uint32_t name##_status_send(name##_server_t * p_server,                                  \
+                                       const access_message_rx_t * p_request,                       \
+                                       const value_t * p_present,                                   \
+                                       uint8_t tid)                                                 \
+    {                                                                                               \
+        uint8_t buffer[sizeof(name##_msg_t)];                                                       \
+        access_message_tx_t msg;                                                                    \
+        msg.opcode.opcode = (opcode_status);                                                        \
+        msg.opcode.company_id = POS_CMD_COMPANY_ID;                                                 \
+        msg.p_buffer = buffer;                                                                      \
+        msg.length = name##_encode(buffer, p_present, tid);                                         \
+        msg.force_segmented = false;                                                                \
+        msg.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;                                         \
+        msg.access_token = nrf_mesh_unique_token_get();                                             \
+                                                                                                    \
+        pos_cmd_stats_opcode_count(p_server->state.stats.tx, (opcode_status));                      \
+        uint32_t error_code = (p_request != NULL) ?                                                 \
+                              access_model_reply(p_server->model_handle, p_request, &msg) :         \
+                              access_model_publish(p_server->model_handle, &msg);                   \
+        POS_CMD_CAPTURE_TX(p_server->model_handle, p_request, &msg, error_code);                    \
+        if (error_code != NRF_SUCCESS)                                                              \
+        {                                                                                           \
+            p_server->state.stats.publish_failures++;                                               \
+        }                                                                                           \
+        POS_CMD_TRACE_TX((opcode_status), tid, msg.length, error_code);                             \
+        return error_code;                                                                          \
+    }                                                                                               \
+                                                                                                    \
+    /* Decodes a Set, counting and capturing it even if its length is wrong. */                     \
+    static const name##_msg_t * name##_set_receive(name##_server_t * p_server,                      \
+                                                   const access_message_rx_t * p_message)           \
+    {                                                                                               \
+        pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);             \
+        POS_CMD_CAPTURE_RX(p_message);                                                              \
+        return name##_decode(p_message);                                                            \
+    }                                                                                               \
+                                                                                                    \
+    static value_t name##_set_apply(name##_server_t * p_server,                                     \
+                                    const access_message_rx_t * p_message,                          \
+                                    const name##_msg_t * p_msg)                                     \
+    {                                                                                               \
+        if (pos_cmd_server_tid_is_duplicate(p_server->state.tid_cache,                              \
+                                            &p_server->state.tid_cache_next,                        \
+                                            &p_server->state.stats, p_message, p_msg->tid))         \
+        {                                                                                           \
+            return p_server->get_cb(p_server);                                                      \
+        }                                                                                           \
+        p_server->state.tid = p_msg->tid;                                                           \
+        return p_server->set_cb(p_server, &p_msg->value);                                           \
+    }                                                                                               \
+                                                                                                    \
+    static void name##_handle_set_cb(access_model_handle_t handle,                                  \
+                                     const access_message_rx_t * p_message,                         \
+                                     void * p_args)                                                 \
+    {                                                                                               \
+        name##_server_t * p_server = p_args;                                                        \
+        const name##_msg_t * p_msg = name##_set_receive(p_server, p_message);                       \
+        if (p_msg != NULL)                                                                          \
+        {                                                                                           \
+            value_t present = name##_set_apply(p_server, p_message, p_msg);                         \
+            (void) name##_status_send(p_server, p_message, &present, p_msg->tid);                   \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    static void name##_handle_set_unreliable_cb(access_model_handle_t handle,                       \
+                                                const access_message_rx_t * p_message,              \
+                                                void * p_args)                                      \
+    {                                                                                               \
+        name##_server_t * p_server = p_args;                                                        \
+        const name##_msg_t * p_msg = name##_set_receive(p_server, p_message);                       \
+        if (p_msg != NULL)                                                                          \
+        {                                                                                           \
+            (void) name##_set_apply(p_server, p_message, p_msg);                                    \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    static void name##_handle_get_cb(access_model_handle_t handle,                                  \
+                                     const access_message_rx_t * p_message,                         \
+                                     void * p_args)                                                 \
+    {                                                                                               \
+        name##_server_t * p_server = p_args;                                                        \
+        pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);             \
+        POS_CMD_CAPTURE_RX(p_message);                                                              \
+        if (p_message->length == sizeof(pos_cmd_msg_get_t))                                         \
+        {                                                                                           \
+            uint8_t tid = ((const pos_cmd_msg_get_t *) p_message->p_data)->tid;                     \
+            POS_CMD_TRACE_RX(p_message->opcode.opcode, tid, p_message->length);                     \
+            value_t present = p_server->get_cb(p_server);                                           \
+            (void) name##_status_send(p_server, p_message, &present, tid);                          \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    static const access_opcode_handler_t name##_opcode_handlers[] =                                 \
+    {                                                                                               \
+        {ACCESS_OPCODE_VENDOR((opcode_set), POS_CMD_COMPANY_ID), name##_handle_set_cb},             \
+        {ACCESS_OPCODE_VENDOR((opcode_set_unreliable), POS_CMD_COMPANY_ID),                         \
+         name##_handle_set_unreliable_cb},                                                          \
+        {ACCESS_OPCODE_VENDOR((opcode_get), POS_CMD_COMPANY_ID), name##_handle_get_cb}              \
+    };                                                                                              \
+                                                                                                    \
+    uint32_t name##_server_init(name##_server_t * p_server, uint16_t element_index)                 \
+    {                                                                                               \
+        if (p_server == NULL || p_server->set_cb == NULL || p_server->get_cb == NULL)               \
+        {                                                                                           \
+            return NRF_ERROR_NULL;                                                                  \
+        }                                                                                           \
+                                                                                                    \
+        memset(&p_server->state, 0, sizeof(p_server->state));                                       \
+                                                                                                    \
+        access_model_add_params_t init_params;                                                      \
+        init_params.element_index = element_index;                                                  \
+        init_params.model_id.model_id = (vendor_model_id);                                          \
+        init_params.model_id.company_id = POS_CMD_COMPANY_ID;                                       \
+        init_params.p_opcode_handlers = &name##_opcode_handlers[0];                                 \
+        init_params.opcode_count =                                                                  \
+            sizeof(name##_opcode_handlers) / sizeof(name##_opcode_handlers[0]);                     \
+        init_params.p_args = p_server;                                                              \
+        init_params.publish_timeout_cb = NULL;                                                      \
+        uint32_t status = access_model_add(&init_params, &p_server->model_handle);                  \
+        if (status == NRF_SUCCESS)                                                                  \
+        {                                                                                           \
+            status = access_model_subscription_list_alloc(p_server->model_handle);                  \
+        }                                                                                           \
+        return status;                                                                              \
+    }                                                                                               \
+                                                                                                    \
+    uint32_t name##_server_status_publish(name##_server_t * p_server, const value_t * p_present)    \
+    {                                                                                               \
+        if (p_server == NULL || p_present == NULL)                                                  \
+        {                                                                                           \
+            return NRF_ERROR_NULL;                                                                  \
+        }                                                                                           \
+        return name##_status_send(p_server, NULL, p_present, p_server->state.tid);                  \
+    }                                                                                               \
+                                                                                                    \
+    NRF_MESH_STATIC_ASSERT((opcode_set) >= 0xC0 && (opcode_set) <= 0xFF &&                          \
+                           (opcode_set_unreliable) >= 0xC0 && (opcode_set_unreliable) <= 0xFF &&    \
+                           (opcode_get) >= 0xC0 && (opcode_get) <= 0xFF &&                          \
+                           (opcode_status) >= 0xC0 && (opcode_status) <= 0xFF)
+
+/** @} end of POS_CMD_TYPED_MODEL */
+
+#endif /* POS_CMD_TYPED_MODEL_H__ */
@@ -0,0 +1,66 @@
+#include "pos_cmd_airtime.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+/** Tokens a message needs before it may be sent, capped at the depth of the bucket. */
+static int32_t tokens_needed(uint32_t cost, uint32_t depth)
+{
+    return (int32_t) ((cost < depth) ? cost : depth);
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+uint32_t pos_cmd_airtime_cost(uint16_t length, uint8_t opcode_length, bool force_segmented)
+{
+    /* Lower transport PDU: the access PDU and a 32-bit TransMIC. One unsegmented PDU carries 15
+     * bytes, a segment 12. Segment acknowledgments from the receiver are not counted. */
+    uint32_t size = opcode_length + length + 4;
+    uint32_t pdus = (size <= 15 && !force_segmented) ? 1 : (size + 11) / 12;
+    return pdus * POS_CMD_AIRTIME_PDU_US;
+}
+
+void pos_cmd_airtime_refill(pos_cmd_airtime_bucket_t * p_bucket,
+                            timestamp_t now,
+                            uint16_t share_permille,
+                            uint32_t depth)
+{
+    uint64_t added = ((uint64_t) TIMER_DIFF(now, p_bucket->updated) * share_permille) / 1000;
+    int64_t tokens = (int64_t) p_bucket->tokens + (int64_t) added;
+    p_bucket->tokens = (tokens > (int64_t) depth) ? (int32_t) depth : (int32_t) tokens;
+    p_bucket->updated = now;
+}
+
+bool pos_cmd_airtime_available(const pos_cmd_airtime_bucket_t * p_bucket, uint32_t cost, uint32_t depth)
+{
+    return p_bucket->tokens >= tokens_needed(cost, depth);
+}
+
+void pos_cmd_airtime_consume(pos_cmd_airtime_bucket_t * p_bucket, uint32_t cost)
+{
+    /* Saturate the debt, a long run of messages that must not wait could otherwise wrap it. */
+    int64_t tokens = (int64_t) p_bucket->tokens - (int64_t) cost;
+    p_bucket->tokens = (tokens < INT32_MIN) ? INT32_MIN : (int32_t) tokens;
+    p_bucket->used += cost;
+}
+
+uint32_t pos_cmd_airtime_wait(const pos_cmd_airtime_bucket_t * p_bucket,
+                              uint32_t cost,
+                              uint16_t share_permille,
+                              uint32_t depth)
+{
+    int64_t missing = (int64_t) tokens_needed(cost, depth) - p_bucket->tokens;
+    if (missing <= 0 || share_permille == 0)
+    {
+        return 0;
+    }
+
+    uint64_t wait = ((uint64_t) missing * 1000 + share_permille - 1) / share_permille;
+    return (wait > UINT32_MAX / 2) ? UINT32_MAX / 2 : (uint32_t) wait;
+}
@@ -0,0 +1,274 @@
+#include "pos_cmd_axis_server.h"
+#include "pos_cmd_common.h"
+#include "pos_cmd_stats.h"
+#include "pos_cmd_trace.h"
+#include "pos_cmd_capture.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "access.h"
+#include "nrf_mesh_assert.h"
+#include "timer.h"
+#include "log.h"
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+/** Number of axes selected by a mask, or zero if it is empty or selects an axis the server does not have. */
+static uint32_t mask_axis_count(const pos_cmd_axis_server_t * p_server, uint16_t mask)
+{
+    if (mask == 0 || (mask >> p_server->axis_count) != 0)
+    {
+        return 0;
+    }
+    return (uint32_t) __builtin_popcount(mask);
+}
+
+/** Sends an Axis Status with the present position of the axes in @p mask, as a reply if @p p_message is given. */
+static uint32_t status_send(pos_cmd_axis_server_t * p_server,
+                            const access_message_rx_t * p_message,
+                            uint16_t mask,
+                            uint8_t tid)
+{
+    uint8_t buffer[sizeof(pos_cmd_msg_axis_status_t) + POS_CMD_AXES_MAX * sizeof(int16_t)];
+    pos_cmd_msg_axis_status_t * p_status = (pos_cmd_msg_axis_status_t *) buffer;
+    p_status->tid = tid;
+    p_status->mask = mask;
+
+    uint16_t count = 0;
+    for (uint8_t i = 0; i < p_server->axis_count; ++i)
+    {
+        if (mask & (1u << i))
+        {
+            p_status->present[count++] = p_server->state.present[i];
+        }
+    }
+
+    access_message_tx_t msg;
+    msg.opcode.opcode = POS_CMD_OPCODE_AXIS_STATUS;
+    msg.opcode.company_id = POS_CMD_COMPANY_ID;
+    msg.p_buffer = buffer;
+    msg.length = sizeof(pos_cmd_msg_axis_status_t) + count * sizeof(int16_t);
+    msg.force_segmented = false;
+    msg.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    msg.access_token = nrf_mesh_unique_token_get();
+
+    pos_cmd_stats_opcode_count(p_server->state.stats.tx, POS_CMD_OPCODE_AXIS_STATUS);
+    uint32_t error_code = (p_message != NULL) ?
+                          access_model_reply(p_server->model_handle, p_message, &msg) :
+                          access_model_publish(p_server->model_handle, &msg);
+    POS_CMD_CAPTURE_TX(p_server->model_handle, p_message, &msg, error_code);
+    if (error_code != NRF_SUCCESS)
+    {
+        p_server->state.stats.publish_failures++;
+    }
+    POS_CMD_TRACE_TX(POS_CMD_OPCODE_AXIS_STATUS, tid, msg.length, error_code);
+    return error_code;
+}
+
+/**
+ * Checks whether a message was already received within @ref POS_CMD_SERVER_TID_CACHE_WINDOW,
+ * and remembers it if not.
+ */
+static bool tid_is_duplicate(pos_cmd_axis_server_t * p_server, const access_message_rx_t * p_message, uint8_t tid)
+{
+    return pos_cmd_server_tid_is_duplicate(p_server->state.tid_cache, &p_server->state.tid_cache_next,
+                                           &p_server->state.stats, p_message, tid);
+}
+
+/**
+ * Validates an Axis Set or Axis Set Unreliable message.
+ *
+ * @returns The message, or NULL if its mask or length is invalid.
+ */
+static const pos_cmd_msg_axis_set_t * axis_set_get(const pos_cmd_axis_server_t * p_server,
+                                                   const access_message_rx_t * p_message)
+{
+    if (p_message->length < sizeof(pos_cmd_msg_axis_set_t))
+    {
+        return NULL;
+    }
+
+    const pos_cmd_msg_axis_set_t * p_set = (const pos_cmd_msg_axis_set_t *) p_message->p_data;
+    uint32_t count = mask_axis_count(p_server, p_set->mask);
+    if (count == 0 || p_message->length != sizeof(pos_cmd_msg_axis_set_t) + count * sizeof(int16_t))
+    {
+        return NULL;
+    }
+    return p_set;
+}
+
+/** Stores the targets of an Axis Set and hands them to the application. */
+static void axis_set_apply(pos_cmd_axis_server_t * p_server, const pos_cmd_msg_axis_set_t * p_set)
+{
+    uint16_t count = 0;
+    for (uint8_t i = 0; i < p_server->axis_count; ++i)
+    {
+        if (p_set->mask & (1u << i))
+        {
+            p_server->state.target[i] = p_set->targets[count++];
+        }
+    }
+
+    p_server->state.tid = p_set->tid;
+    p_server->set_cb(p_server, p_set->mask);
+}
+
+/*****************************************************************************
+ * Opcode handler callbacks
+ *****************************************************************************/
+
+static void handle_axis_set_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_axis_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+
+    const pos_cmd_msg_axis_set_t * p_set = axis_set_get(p_server, p_message);
+    if (p_set == NULL)
+    {
+        return;
+    }
+
+    /* The client retransmits until it hears a reply, so answer duplicates without applying them again. */
+    if (!tid_is_duplicate(p_server, p_message, p_set->tid))
+    {
+        axis_set_apply(p_server, p_set);
+    }
+    (void) status_send(p_server, p_message, p_set->mask, p_set->tid);
+}
+
+static void handle_axis_set_unreliable_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_axis_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+
+    const pos_cmd_msg_axis_set_t * p_set = axis_set_get(p_server, p_message);
+    if (p_set == NULL || tid_is_duplicate(p_server, p_message, p_set->tid))
+    {
+        return;
+    }
+
+    axis_set_apply(p_server, p_set);
+}
+
+static void handle_axis_get_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_axis_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+
+    if (p_message->length != sizeof(pos_cmd_msg_axis_get_t))
+    {
+        return;
+    }
+
+    const pos_cmd_msg_axis_get_t * p_get = (const pos_cmd_msg_axis_get_t *) p_message->p_data;
+    POS_CMD_TRACE_RX(p_message->opcode.opcode, p_get->tid, p_message->length);
+    if (mask_axis_count(p_server, p_get->mask) == 0)
+    {
+        return;
+    }
+    (void) status_send(p_server, p_message, p_get->mask, p_get->tid);
+}
+
+static const access_opcode_handler_t m_opcode_handlers[] =
+{
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_AXIS_SET,            POS_CMD_COMPANY_ID), handle_axis_set_cb},
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_AXIS_SET_UNRELIABLE, POS_CMD_COMPANY_ID), handle_axis_set_unreliable_cb},
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_AXIS_GET,            POS_CMD_COMPANY_ID), handle_axis_get_cb}
+};
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+uint32_t pos_cmd_axis_server_init(pos_cmd_axis_server_t * p_server, uint16_t element_index)
+{
+    if (p_server == NULL || p_server->set_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (p_server->axis_count == 0 || p_server->axis_count > POS_CMD_AXES_MAX)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    memset(&p_server->state, 0, sizeof(p_server->state));
+
+    access_model_add_params_t init_params;
+    init_params.element_index = element_index;
+    init_params.model_id.model_id = POS_CMD_AXIS_SERVER_MODEL_ID;
+    init_params.model_id.company_id = POS_CMD_COMPANY_ID;
+    init_params.p_opcode_handlers = &m_opcode_handlers[0];
+    init_params.opcode_count = sizeof(m_opcode_handlers) / sizeof(m_opcode_handlers[0]);
+    init_params.p_args = p_server;
+    init_params.publish_timeout_cb = NULL;
+    uint32_t status = access_model_add(&init_params, &p_server->model_handle);
+
+    if (status == NRF_SUCCESS)
+    {
+        status = access_model_subscription_list_alloc(p_server->model_handle);
+    }
+
+    return status;
+}
+
+int16_t pos_cmd_axis_server_target_get(const pos_cmd_axis_server_t * p_server, uint8_t index)
+{
+    NRF_MESH_ASSERT(index < p_server->axis_count);
+    return p_server->state.target[index];
+}
+
+void pos_cmd_axis_server_present_update(pos_cmd_axis_server_t * p_server,
+                                        uint8_t index,
+                                        int16_t present,
+                                        int16_t velocity)
+{
+    NRF_MESH_ASSERT(index < p_server->axis_count);
+
+    p_server->state.present[index] = present;
+    p_server->state.velocity[index] = velocity;
+    int32_t deadband = (p_server->deadband > 0) ? p_server->deadband : 1;
+    if (abs(present - p_server->state.published[index]) >= deadband)
+    {
+        p_server->state.changed |= (uint16_t) (1u << index);
+    }
+}
+
+uint32_t pos_cmd_axis_server_status_publish(pos_cmd_axis_server_t * p_server)
+{
+    if (p_server == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (p_server->state.changed == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    uint16_t changed = p_server->state.changed;
+    uint32_t status = status_send(p_server, NULL, changed, p_server->state.tid);
+    if (status == NRF_SUCCESS)
+    {
+        for (uint8_t i = 0; i < p_server->axis_count; ++i)
+        {
+            if (changed & (1u << i))
+            {
+                p_server->state.published[i] = p_server->state.present[i];
+            }
+        }
+        p_server->state.changed = 0;
+    }
+    return status;
+}
+
+const pos_cmd_stats_t * pos_cmd_axis_server_stats_get(const pos_cmd_axis_server_t * p_server)
+{
+    return &p_server->state.stats;
+}
@@ -0,0 +1,158 @@
+#include "pos_cmd_capture.h"
+#include "pos_cmd_common.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if POS_CMD_CAPTURE_ENABLED
+#include "device_state_manager.h"
+#include "nrf_mesh.h"
+#include "timer.h"
+#endif
+
+#if POS_CMD_CAPTURE_ENABLED
+
+/*****************************************************************************
+ * Static variables
+ *****************************************************************************/
+
+static pos_cmd_capture_sink_t m_sink;
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+/** Gets the transaction number of a message, which follows the position in the messages that carry one. */
+static uint8_t message_tid_get(uint8_t opcode, const uint8_t * p_data, uint16_t length)
+{
+    uint16_t offset;
+    switch (opcode)
+    {
+        case POS_CMD_OPCODE_SET:
+        case POS_CMD_OPCODE_SET_UNRELIABLE:
+        case POS_CMD_OPCODE_STATUS:
+        case POS_CMD_OPCODE_SET_SCHEDULED:
+            offset = sizeof(struct position_t);
+            break;
+        default:
+            offset = 0;
+            break;
+    }
+    return (length > offset) ? p_data[offset] : 0;
+}
+
+static void record_write(uint16_t src,
+                         uint16_t dst,
+                         uint8_t opcode,
+                         uint8_t flags,
+                         const uint8_t * p_data,
+                         uint16_t length)
+{
+    pos_cmd_capture_sink_t sink = m_sink;
+    if (sink == NULL)
+    {
+        return;
+    }
+
+    uint8_t buffer[sizeof(pos_cmd_capture_record_t) + POS_CMD_CAPTURE_PAYLOAD_MAX];
+    pos_cmd_capture_record_t * p_record = (pos_cmd_capture_record_t *) buffer;
+    p_record->timestamp = timer_now();
+    p_record->src = src;
+    p_record->dst = dst;
+    p_record->opcode = opcode;
+    p_record->tid = message_tid_get(opcode, p_data, length);
+    p_record->flags = flags;
+    if (length > POS_CMD_CAPTURE_PAYLOAD_MAX)
+    {
+        length = POS_CMD_CAPTURE_PAYLOAD_MAX;
+        p_record->flags |= POS_CMD_CAPTURE_FLAG_TRUNCATED;
+    }
+    p_record->length = length;
+    memcpy(p_record->payload, p_data, length);
+
+    sink(buffer, (uint16_t) (sizeof(pos_cmd_capture_record_t) + length));
+}
+
+#endif /* POS_CMD_CAPTURE_ENABLED */
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+const pos_cmd_capture_record_t * pos_cmd_capture_record_next(const uint8_t ** pp_cursor, const uint8_t * p_end)
+{
+    const uint8_t * p_cursor = *pp_cursor;
+    if (p_end < p_cursor || (size_t) (p_end - p_cursor) < sizeof(pos_cmd_capture_record_t))
+    {
+        return NULL;
+    }
+
+    const pos_cmd_capture_record_t * p_record = (const pos_cmd_capture_record_t *) p_cursor;
+    size_t size = sizeof(pos_cmd_capture_record_t) + p_record->length;
+    if ((size_t) (p_end - p_cursor) < size)
+    {
+        return NULL;
+    }
+
+    *pp_cursor = p_cursor + size;
+    return p_record;
+}
+
+#if POS_CMD_CAPTURE_ENABLED
+
+void pos_cmd_capture_sink_set(pos_cmd_capture_sink_t sink)
+{
+    m_sink = sink;
+}
+
+void pos_cmd_capture_rx(const access_message_rx_t * p_message)
+{
+    record_write(p_message->meta_data.src.value,
+                 p_message->meta_data.dst.value,
+                 (uint8_t) p_message->opcode.opcode,
+                 0,
+                 p_message->p_data,
+                 p_message->length);
+}
+
+void pos_cmd_capture_tx(access_model_handle_t model_handle,
+                        const access_message_rx_t * p_request,
+                        const access_message_tx_t * p_message,
+                        uint32_t status)
+{
+    if (m_sink == NULL)
+    {
+        return;
+    }
+
+    uint16_t dst = NRF_MESH_ADDR_UNASSIGNED;
+    if (p_request != NULL)
+    {
+        dst = p_request->meta_data.src.value;
+    }
+    else
+    {
+        dsm_handle_t address_handle;
+        nrf_mesh_address_t address;
+        if (access_model_publish_address_get(model_handle, &address_handle) == NRF_SUCCESS &&
+            dsm_address_get(address_handle, &address) == NRF_SUCCESS)
+        {
+            dst = address.value;
+        }
+    }
+
+    uint8_t flags = POS_CMD_CAPTURE_FLAG_TX;
+    if (status != NRF_SUCCESS)
+    {
+        flags |= POS_CMD_CAPTURE_FLAG_FAILED;
+    }
+    record_write(NRF_MESH_ADDR_UNASSIGNED,
+                 dst,
+                 (uint8_t) p_message->opcode.opcode,
+                 flags,
+                 p_message->p_buffer,
+                 p_message->length);
+}
+
+#endif /* POS_CMD_CAPTURE_ENABLED */
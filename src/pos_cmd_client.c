@@ -1,9 +1,19 @@
-
 #include "pos_cmd_client.h"
 #include "pos_cmd_common.h"
+#include "pos_cmd_codec.h"
+#include "pos_cmd_trajectory.h"
+#include "pos_cmd_status_table.h"
+#include "pos_cmd_link.h"
+#include "pos_cmd_airtime.h"
+#include "pos_cmd_stats.h"
+#include "pos_cmd_trace.h"
+#include "pos_cmd_capture.h"
+#include "pos_cmd_tx_pool.h"
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "access.h"
 #include "access_config.h"
@@ -11,202 +21,1606 @@
 #include "device_state_manager.h"
 #include "nrf_mesh.h"
 #include "nrf_mesh_assert.h"
+#include "timer.h"
+#include "timer_scheduler.h"
 #include "log.h"
 
 /*****************************************************************************
- * Static variables
+ * Static functions
  *****************************************************************************/
 
-/** Keeps a single global TID for all transfers. */
-static uint8_t m_tid;
+/**
+ * Takes the transaction number of the next message. Whether it is a Set is remembered until the
+ * number comes round again, so a Status can be told to confirm one of this client's Sets.
+ */
+static uint8_t tid_take(pos_cmd_client_t * p_client, bool set)
+{
+    uint8_t tid = p_client->state.tid++;
+    uint32_t bit = (1u << (tid % 32));
+    if (set)
+    {
+        p_client->state.set_tids[tid / 32] |= bit;
+    }
+    else
+    {
+        p_client->state.set_tids[tid / 32] &= ~bit;
+    }
+    return tid;
+}
+
+static bool tid_is_set(const pos_cmd_client_t * p_client, uint8_t tid)
+{
+    return (p_client->state.set_tids[tid / 32] & (1u << (tid % 32))) != 0;
+}
 
-/*****************************************************************************
- * Static functions
- *****************************************************************************/
+/** Takes the estimated airtime of a message sent out of the budget, if pacing is enabled. */
+static void airtime_charge(pos_cmd_client_t * p_client, const access_message_tx_t * p_message)
+{
+    if (p_client->airtime.share_permille == 0)
+    {
+        return;
+    }
+
+    pos_cmd_airtime_refill(&p_client->state.airtime.bucket, timer_now(),
+                           p_client->airtime.share_permille, p_client->airtime.burst_us);
+    pos_cmd_airtime_consume(&p_client->state.airtime.bucket,
+                            pos_cmd_airtime_cost(p_message->length, 3, p_message->force_segmented));
+}
+
+static uint32_t publish_message(pos_cmd_client_t * p_client,
+                                pos_cmd_opcode_t opcode,
+                                uint8_t tid,
+                                const uint8_t * p_data,
+                                uint16_t length)
+{
+    access_message_tx_t message;
+    message.opcode.opcode = opcode;
+    message.opcode.company_id = POS_CMD_COMPANY_ID;
+    message.p_buffer = p_data;
+    message.length = length;
+    message.force_segmented = false;
+    message.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    message.access_token = nrf_mesh_unique_token_get();
+
+    pos_cmd_stats_opcode_count(p_client->state.stats.tx, opcode);
+    uint32_t status = access_model_publish(p_client->model_handle, &message);
+    POS_CMD_CAPTURE_TX(p_client->model_handle, NULL, &message, status);
+    if (status != NRF_SUCCESS)
+    {
+        p_client->state.stats.publish_failures++;
+    }
+    else
+    {
+        airtime_charge(p_client, &message);
+    }
+    POS_CMD_TRACE_TX(opcode, tid, length, status);
+    return status;
+}
+
+/** Schedules the retransmission timer for the earliest pending retransmission, if any. */
+static void transaction_timer_update(pos_cmd_client_t * p_client)
+{
+    bool any_active = false;
+    timestamp_t next = 0;
+
+    for (uint32_t i = 0; i < POS_CMD_CLIENT_TRANSACTION_COUNT; ++i)
+    {
+        const pos_cmd_client_transaction_t * p_transaction = &p_client->state.transactions[i];
+        if (p_transaction->active &&
+            (!any_active || TIMER_OLDER_THAN(p_transaction->next_retransmit, next)))
+        {
+            next = p_transaction->next_retransmit;
+            any_active = true;
+        }
+    }
+
+    timer_sch_abort(&p_client->state.timer);
+    if (any_active)
+    {
+        p_client->state.timer.timestamp = next;
+        timer_sch_schedule(&p_client->state.timer);
+    }
+}
+
+static pos_cmd_client_transaction_t * transaction_free_get(pos_cmd_client_t * p_client)
+{
+    for (uint32_t i = 0; i < POS_CMD_CLIENT_WINDOW_SIZE; ++i)
+    {
+        if (!p_client->state.transactions[i].active)
+        {
+            return &p_client->state.transactions[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Checks whether a message can be the reply to a transaction.
+ *
+ * TIDs are per client, and a published Status carries the TID the server applied last from any
+ * client. Only a message sent to this element is taken as a reply, and for a request to a unicast
+ * address only one from that address.
+ */
+static bool transaction_reply_matches(const pos_cmd_client_transaction_t * p_transaction,
+                                      const access_message_rx_t * p_message)
+{
+    if (p_message->meta_data.dst.type != NRF_MESH_ADDRESS_TYPE_UNICAST)
+    {
+        return false;
+    }
+
+    return (nrf_mesh_address_type_get(p_transaction->dst) != NRF_MESH_ADDRESS_TYPE_UNICAST ||
+            p_message->meta_data.src.value == p_transaction->dst);
+}
+
+/** Finds the outstanding transaction a message replies to. */
+static pos_cmd_client_transaction_t * transaction_find(pos_cmd_client_t * p_client,
+                                                       uint8_t tid,
+                                                       const access_message_rx_t * p_message)
+{
+    for (uint32_t i = 0; i < POS_CMD_CLIENT_TRANSACTION_COUNT; ++i)
+    {
+        pos_cmd_client_transaction_t * p_transaction = &p_client->state.transactions[i];
+        if (p_transaction->active && p_transaction->tid == tid &&
+            transaction_reply_matches(p_transaction, p_message))
+        {
+            return p_transaction;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t send_set(pos_cmd_client_t * p_client, struct position_t target);
+
+/** Gets the opcode of the reply that completes a request. */
+static pos_cmd_opcode_t reply_opcode_get(pos_cmd_opcode_t opcode)
+{
+    switch (opcode)
+    {
+        case POS_CMD_OPCODE_STATS_GET:
+            return POS_CMD_OPCODE_STATS_STATUS;
+        case POS_CMD_OPCODE_AXIS_SET:
+        case POS_CMD_OPCODE_AXIS_GET:
+            return POS_CMD_OPCODE_AXIS_STATUS;
+        default:
+            return POS_CMD_OPCODE_STATUS;
+    }
+}
+
+/** Tracks the reference position for Set Delta messages, the newest acknowledged Set. */
+static void delta_ref_update(pos_cmd_client_t * p_client,
+                             const pos_cmd_client_transaction_t * p_transaction,
+                             access_reliable_status_t status)
+{
+    if (p_transaction->opcode != POS_CMD_OPCODE_SET)
+    {
+        return;
+    }
+
+    if (p_client->state.delta.keyframe_pending && p_transaction->tid == p_client->state.delta.keyframe_tid)
+    {
+        p_client->state.delta.keyframe_pending = false;
+    }
+
+    if (status == ACCESS_RELIABLE_TRANSFER_SUCCESS &&
+        (!p_client->state.delta.ref_valid || (int8_t) (p_transaction->tid - p_client->state.delta.ref_tid) > 0))
+    {
+        const pos_cmd_msg_set_t * p_set = (const pos_cmd_msg_set_t *) p_transaction->p_data;
+        p_client->state.delta.ref = p_set->target;
+        p_client->state.delta.ref_tid = p_transaction->tid;
+        p_client->state.delta.ref_valid = true;
+        p_client->state.delta.count = 0;
+    }
+}
 
-static void reliable_status_cb(access_model_handle_t model_handle,
-                               void * p_args,
+static void reliable_status_cb(pos_cmd_client_t * p_client,
+                               pos_cmd_client_transaction_t * p_transaction,
                                access_reliable_status_t status)
 {
-    pos_cmd_client_t * p_client = p_args;
     NRF_MESH_ASSERT(p_client->status_cb != NULL);
 
-    p_client->state.reliable_transfer_active = false;
+    delta_ref_update(p_client, p_transaction, status);
+
+    /* Record the transaction while the slot still holds it, a new transaction may take the slot as
+     * soon as it is freed. */
+    pos_cmd_status_t reported = POS_CMD_STATUS_PRESENT;
     switch (status)
     {
         case ACCESS_RELIABLE_TRANSFER_SUCCESS:
-            /* Ignore */
+            pos_cmd_stats_rtt_record(&p_client->state.stats, TIMER_DIFF(timer_now(), p_transaction->sent));
             break;
         case ACCESS_RELIABLE_TRANSFER_TIMEOUT:
-            p_client->status_cb(p_client, POS_CMD_STATUS_ERROR_NO_REPLY, NRF_MESH_ADDR_UNASSIGNED);
+            p_client->state.stats.timeouts++;
+            POS_CMD_TRACE_EVENT(p_transaction->opcode, p_transaction->tid, p_transaction->length,
+                                POS_CMD_TRACE_STATUS_TIMEOUT);
+            reported = POS_CMD_STATUS_ERROR_NO_REPLY;
             break;
         case ACCESS_RELIABLE_TRANSFER_CANCELLED:
-            p_client->status_cb(p_client, POS_CMD_STATUS_CANCELLED, NRF_MESH_ADDR_UNASSIGNED);
+            p_client->state.stats.cancellations++;
+            POS_CMD_TRACE_EVENT(p_transaction->opcode, p_transaction->tid, p_transaction->length,
+                                POS_CMD_TRACE_STATUS_CANCELLED);
+            reported = POS_CMD_STATUS_CANCELLED;
             break;
         default:
             /* Should not be possible. */
             NRF_MESH_ASSERT(false);
             break;
     }
+
+    /* Free the slot before notifying, the application may start a new transaction from the callback. */
+    p_transaction->active = false;
+    if (p_transaction->p_data != p_client->state.stop_buffer)
+    {
+        pos_cmd_tx_pool_release(p_transaction->p_data);
+    }
+    p_transaction->p_data = NULL;
+
+    /* A successful transaction is reported with the Status that completed it. */
+    if (status != ACCESS_RELIABLE_TRANSFER_SUCCESS)
+    {
+        p_client->status_cb(p_client, reported, NULL, NRF_MESH_ADDR_UNASSIGNED);
+    }
+
+    /* A coalesced Set takes the freed slot once the transaction is reported. A Set issued from the
+     * status callback replaced it instead of overtaking it, and if another request took the slot
+     * the Set waits for the next one. */
+    if (p_client->state.pending_valid && transaction_free_get(p_client) != NULL)
+    {
+        p_client->state.pending_valid = false;
+        if (send_set(p_client, p_client->state.pending_target) != NRF_SUCCESS)
+        {
+            p_client->status_cb(p_client, POS_CMD_STATUS_CANCELLED, NULL, NRF_MESH_ADDR_UNASSIGNED);
+        }
+    }
 }
 
-static uint32_t send_reliable_message(const pos_cmd_client_t * p_client,
-                                      pos_cmd_opcode_t opcode,
-                                      const uint8_t * p_data,
-                                      uint16_t length)
+static void transaction_timer_cb(timestamp_t timestamp, void * p_context)
+{
+    pos_cmd_client_t * p_client = p_context;
+
+    for (uint32_t i = 0; i < POS_CMD_CLIENT_TRANSACTION_COUNT; ++i)
+    {
+        pos_cmd_client_transaction_t * p_transaction = &p_client->state.transactions[i];
+        if (!p_transaction->active || TIMER_OLDER_THAN(timestamp, p_transaction->next_retransmit))
+        {
+            continue;
+        }
+
+        if (!TIMER_OLDER_THAN(timestamp, p_transaction->deadline))
+        {
+            reliable_status_cb(p_client, p_transaction, ACCESS_RELIABLE_TRANSFER_TIMEOUT);
+            continue;
+        }
+
+        /* A failed retransmission is treated as a lost message, the next one may succeed. */
+        p_client->state.stats.retransmissions++;
+        (void) publish_message(p_client, p_transaction->opcode, p_transaction->tid,
+                               p_transaction->p_data, p_transaction->length);
+
+        p_transaction->retransmit_interval *= 2;
+        p_transaction->next_retransmit = timestamp + p_transaction->retransmit_interval;
+        if (TIMER_OLDER_THAN(p_transaction->deadline, p_transaction->next_retransmit))
+        {
+            p_transaction->next_retransmit = p_transaction->deadline;
+        }
+    }
+
+    transaction_timer_update(p_client);
+}
+
+/** Gets a pool buffer to encode an acknowledged request into, if a transaction slot is free. */
+static uint32_t request_buffer_alloc(pos_cmd_client_t * p_client, uint16_t length, uint8_t ** pp_buffer)
 {
-    access_reliable_t reliable;
-    reliable.model_handle = p_client->model_handle;
-    reliable.message.p_buffer = p_data;
-    reliable.message.length = length;
-    reliable.message.opcode.opcode = opcode;
-    reliable.message.opcode.company_id = POS_CMD_COMPANY_ID;
-    reliable.message.force_segmented = false;
-    reliable.message.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
-    reliable.message.access_token = nrf_mesh_unique_token_get();
-    reliable.reply_opcode.opcode = POS_CMD_OPCODE_STATUS;
-    reliable.reply_opcode.company_id = POS_CMD_COMPANY_ID;
-    reliable.timeout = POS_CMD_CLIENT_ACKED_TRANSACTION_TIMEOUT;
-    reliable.status_cb = reliable_status_cb;
+    if (transaction_free_get(p_client) == NULL)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
 
-    return access_model_reliable_publish(&reliable);
+    *pp_buffer = pos_cmd_tx_pool_alloc(length);
+    return (*pp_buffer != NULL) ? NRF_SUCCESS : NRF_ERROR_NO_MEM;
 }
 
-/*****************************************************************************
- * Opcode handler callback(s)
- *****************************************************************************/
+static uint32_t publish_address_get(const pos_cmd_client_t * p_client, uint16_t * p_address);
 
-static void handle_status_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+/** Starts tracking a transaction whose first copy has been sent, or is to be retried. */
+static void transaction_track(pos_cmd_client_t * p_client,
+                              pos_cmd_client_transaction_t * p_transaction,
+                              pos_cmd_opcode_t opcode,
+                              uint8_t tid,
+                              uint8_t * p_buffer,
+                              uint16_t length,
+                              uint32_t retransmit_interval)
 {
-    pos_cmd_client_t * p_client = p_args;
-    NRF_MESH_ASSERT(p_client->status_cb != NULL);
+    /* The publish address was checked by the publication, whether or not it found a buffer. */
+    uint16_t dst = NRF_MESH_ADDR_UNASSIGNED;
+    (void) publish_address_get(p_client, &dst);
 
-    pos_cmd_msg_status_t * p_status = (pos_cmd_msg_status_t *) p_message->p_data;
-    pos_cmd_status_t com_data = *p_status->present_state;
-    p_client->status_cb(p_client, com_data, p_message->meta_data.src.value);
+    timestamp_t now = timer_now();
+    p_transaction->active = true;
+    p_transaction->dst = dst;
+    p_transaction->opcode = opcode;
+    p_transaction->tid = tid;
+    p_transaction->sent = now;
+    p_transaction->p_data = p_buffer;
+    p_transaction->length = length;
+    p_transaction->deadline = now + POS_CMD_CLIENT_ACKED_TRANSACTION_TIMEOUT;
+    p_transaction->retransmit_interval = retransmit_interval;
+    p_transaction->next_retransmit = now + retransmit_interval;
+    transaction_timer_update(p_client);
 }
 
-static const access_opcode_handler_t m_opcode_handlers[] =
+/** Sends the first copy of an acknowledged request and starts its transaction. */
+static uint32_t transaction_start(pos_cmd_client_t * p_client,
+                                  pos_cmd_client_transaction_t * p_transaction,
+                                  pos_cmd_opcode_t opcode,
+                                  uint8_t tid,
+                                  uint8_t * p_buffer,
+                                  uint16_t length,
+                                  uint32_t retransmit_interval)
 {
-    {{POS_CMD_OPCODE_STATUS, POS_CMD_COMPANY_ID}, handle_status_cb}
-};
+    uint32_t status = publish_message(p_client, opcode, tid, p_buffer, length);
+    if (status == NRF_SUCCESS)
+    {
+        transaction_track(p_client, p_transaction, opcode, tid, p_buffer, length, retransmit_interval);
+    }
+    return status;
+}
 
-static void handle_publish_timeout(access_model_handle_t handle, void * p_args)
+/**
+ * Sends an acknowledged request encoded in a buffer from @ref request_buffer_alloc. The buffer is
+ * owned by the transaction from here on, and released when it ends or if it could not be started.
+ */
+static uint32_t send_reliable_message(pos_cmd_client_t * p_client,
+                                      pos_cmd_opcode_t opcode,
+                                      uint8_t tid,
+                                      uint8_t * p_buffer,
+                                      uint16_t length)
 {
-    pos_cmd_client_t * p_client = p_args;
+    pos_cmd_client_transaction_t * p_transaction = transaction_free_get(p_client);
+    NRF_MESH_ASSERT(p_transaction != NULL);
 
-    if (p_client->timeout_cb != NULL)
+    uint32_t status = transaction_start(p_client, p_transaction, opcode, tid, p_buffer, length,
+                                        POS_CMD_CLIENT_RETRANSMIT_INTERVAL);
+    if (status != NRF_SUCCESS)
     {
-        p_client->timeout_cb(handle, p_args);
+        pos_cmd_tx_pool_release(p_buffer);
     }
+    return status;
 }
-/*****************************************************************************
- * Public API
- *****************************************************************************/
 
-uint32_t pos_cmd_client_init(pos_cmd_client_t * p_client, uint16_t element_index)
+static uint32_t send_set(pos_cmd_client_t * p_client, struct position_t target)
 {
-    if (p_client == NULL ||
-        p_client->status_cb == NULL)
+    uint8_t * p_buffer;
+    uint32_t status = request_buffer_alloc(p_client, sizeof(pos_cmd_msg_set_t), &p_buffer);
+    if (status != NRF_SUCCESS)
     {
-        return NRF_ERROR_NULL;
+        return status;
     }
 
-    access_model_add_params_t init_params;
-    init_params.model_id.model_id = POS_CMD_CLIENT_MODEL_ID;
-    init_params.model_id.company_id = POS_CMD_COMPANY_ID;
-    init_params.element_index = element_index;
-    init_params.p_opcode_handlers = &m_opcode_handlers[0];
-    init_params.opcode_count = sizeof(m_opcode_handlers) / sizeof(m_opcode_handlers[0]);
-    init_params.p_args = p_client;
-    init_params.publish_timeout_cb = handle_publish_timeout;
-    return access_model_add(&init_params, &p_client->model_handle);
+    pos_cmd_msg_set_t * p_set = (pos_cmd_msg_set_t *) p_buffer;
+    p_set->target = target;
+    p_set->tid = tid_take(p_client, true);
+
+    return send_reliable_message(p_client,
+                                 POS_CMD_OPCODE_SET,
+                                 p_set->tid,
+                                 p_buffer,
+                                 sizeof(pos_cmd_msg_set_t));
 }
 
-uint32_t pos_cmd_client_set(pos_cmd_client_t * p_client, uint8_t * com_data)
+/** Gets the airtime of a queued message. */
+static uint32_t deferred_cost(const pos_cmd_client_deferred_t * p_deferred)
 {
-    if (p_client == NULL || p_client->status_cb == NULL)
+    return pos_cmd_airtime_cost(p_deferred->length, 3, false);
+}
+
+/** Removes the oldest queued message. */
+static void deferred_pop(pos_cmd_client_t * p_client)
+{
+    p_client->state.airtime.count--;
+    memmove(&p_client->state.airtime.queue[0], &p_client->state.airtime.queue[1],
+            p_client->state.airtime.count * sizeof(pos_cmd_client_deferred_t));
+}
+
+/** Removes every queued message with the given opcode. */
+static void deferred_drop(pos_cmd_client_t * p_client, pos_cmd_opcode_t opcode)
+{
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < p_client->state.airtime.count; ++i)
     {
-        return NRF_ERROR_NULL;
+        if (p_client->state.airtime.queue[i].opcode == opcode)
+        {
+            p_client->state.airtime.dropped++;
+        }
+        else
+        {
+            if (kept != i)
+            {
+                p_client->state.airtime.queue[kept] = p_client->state.airtime.queue[i];
+            }
+            kept++;
+        }
     }
-    else if (p_client->state.reliable_transfer_active)
+    p_client->state.airtime.count = kept;
+}
+
+/** Schedules the timer for the oldest queued message, unless it is scheduled already. */
+static void airtime_timer_schedule(pos_cmd_client_t * p_client, timestamp_t now)
+{
+    if (p_client->state.airtime.count == 0 || p_client->state.airtime.scheduled)
     {
-        return NRF_ERROR_INVALID_STATE;
+        return;
+    }
+
+    uint32_t wait = pos_cmd_airtime_wait(&p_client->state.airtime.bucket,
+                                         deferred_cost(&p_client->state.airtime.queue[0]),
+                                         p_client->airtime.share_permille,
+                                         p_client->airtime.burst_us);
+    if (wait < POS_CMD_CLIENT_REPEAT_INTERVAL)
+    {
+        wait = POS_CMD_CLIENT_REPEAT_INTERVAL;
     }
 
-    p_client->state.data.com_data = com_data;
-    p_client->state.data.tid = m_tid++;
+    p_client->state.airtime.timer.timestamp = now + wait;
+    p_client->state.airtime.scheduled = true;
+    timer_sch_schedule(&p_client->state.airtime.timer);
+}
 
-    uint32_t status = send_reliable_message(p_client,
-                                            POS_CMD_OPCODE_SET,
-                                            (const uint8_t *)&p_client->state.data,
-                                            sizeof(pos_cmd_msg_set_t));
-    if (status == NRF_SUCCESS)
+/** Sends one copy of the oldest queued message if the budget allows. */
+static void airtime_timer_cb(timestamp_t timestamp, void * p_context)
+{
+    pos_cmd_client_t * p_client = p_context;
+    p_client->state.airtime.scheduled = false;
+    if (p_client->state.airtime.count == 0)
     {
-        p_client->state.reliable_transfer_active = true;
+        return;
+    }
+
+    pos_cmd_client_deferred_t * p_deferred = &p_client->state.airtime.queue[0];
+    pos_cmd_airtime_refill(&p_client->state.airtime.bucket, timestamp,
+                           p_client->airtime.share_permille, p_client->airtime.burst_us);
+    if (pos_cmd_airtime_available(&p_client->state.airtime.bucket, deferred_cost(p_deferred),
+                                  p_client->airtime.burst_us))
+    {
+        uint32_t status = publish_message(p_client, p_deferred->opcode, p_deferred->tid,
+                                          p_deferred->data, p_deferred->length);
+        if (status == NRF_SUCCESS)
+        {
+            p_deferred->repeats--;
+        }
+
+        /* A full TX queue is retried on the next tick, other errors do not go away by waiting. */
+        if (p_deferred->repeats == 0 || (status != NRF_SUCCESS && status != NRF_ERROR_NO_MEM))
+        {
+            deferred_pop(p_client);
+        }
     }
-    return status;
 
+    airtime_timer_schedule(p_client, timestamp);
 }
 
-uint32_t pos_cmd_client_set_unreliable(pos_cmd_client_t * p_client, uint8_t * com_data, uint16_t len, uint8_t repeats)
+/**
+ * Sends the copies of an unreliable message as the airtime budget allows. Copies that can not be
+ * sent now are queued, and sent by the timer.
+ */
+static uint32_t publish_paced(pos_cmd_client_t * p_client,
+                              const access_message_tx_t * p_message,
+                              uint8_t tid,
+                              uint8_t repeats)
 {
+    if (repeats == 0)
+    {
+        return NRF_SUCCESS;
+    }
 
-    access_message_tx_t message;
-    message.opcode.opcode = POS_CMD_OPCODE_SET_UNRELIABLE;
-    message.opcode.company_id = POS_CMD_COMPANY_ID;
-    message.p_buffer = com_data;
-    message.length = len;
-    message.force_segmented = false;
-    message.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    /* A newer target makes the queued one pointless. */
+    if (p_message->opcode.opcode == POS_CMD_OPCODE_SET_UNRELIABLE)
+    {
+        deferred_drop(p_client, POS_CMD_OPCODE_SET_UNRELIABLE);
+    }
+
+    timestamp_t now = timer_now();
+    pos_cmd_airtime_refill(&p_client->state.airtime.bucket, now,
+                           p_client->airtime.share_permille, p_client->airtime.burst_us);
+
+    bool sent = false;
+    if (p_client->state.airtime.count == 0 &&
+        pos_cmd_airtime_available(&p_client->state.airtime.bucket,
+                                  pos_cmd_airtime_cost(p_message->length, 3, false),
+                                  p_client->airtime.burst_us))
+    {
+        uint32_t status = publish_message(p_client, p_message->opcode.opcode, tid,
+                                          p_message->p_buffer, p_message->length);
+        if (status == NRF_SUCCESS)
+        {
+            sent = true;
+            repeats--;
+        }
+        else if (status != NRF_ERROR_NO_MEM)
+        {
+            return status;
+        }
+    }
+
+    if (!sent)
+    {
+        p_client->state.airtime.deferred++;
+    }
+
+    if (repeats > 0)
+    {
+        if (p_client->state.airtime.count == POS_CMD_CLIENT_AIRTIME_QUEUE_SIZE)
+        {
+            p_client->state.airtime.dropped++;
+            return sent ? NRF_SUCCESS : NRF_ERROR_NO_MEM;
+        }
 
-    p_client->state.data.com_data = com_data;
-    p_client->state.data.tid = m_tid++;
+        pos_cmd_client_deferred_t * p_deferred = &p_client->state.airtime.queue[p_client->state.airtime.count++];
+        p_deferred->opcode = (pos_cmd_opcode_t) p_message->opcode.opcode;
+        p_deferred->tid = tid;
+        p_deferred->repeats = repeats;
+        p_deferred->length = p_message->length;
+        memcpy(p_deferred->data, p_message->p_buffer, p_message->length);
+        airtime_timer_schedule(p_client, now);
+    }
+
+    return NRF_SUCCESS;
+}
+
+static uint32_t publish_repeated(pos_cmd_client_t * p_client,
+                                 access_message_tx_t * p_message,
+                                 uint8_t tid,
+                                 uint8_t repeats)
+{
+    if (p_client->airtime.share_permille != 0 && p_message->length <= POS_CMD_CLIENT_AIRTIME_PAYLOAD_MAX)
+    {
+        return publish_paced(p_client, p_message, tid, repeats);
+    }
 
     uint32_t status = NRF_SUCCESS;
     for (uint8_t i = 0; i < repeats; ++i)
     {
-        message.access_token = nrf_mesh_unique_token_get();
-        status = access_model_publish(p_client->model_handle, &message);
+        p_message->access_token = nrf_mesh_unique_token_get();
+        pos_cmd_stats_opcode_count(p_client->state.stats.tx, p_message->opcode.opcode);
+        status = access_model_publish(p_client->model_handle, p_message);
+        POS_CMD_CAPTURE_TX(p_client->model_handle, NULL, p_message, status);
         if (status != NRF_SUCCESS)
         {
+            p_client->state.stats.publish_failures++;
             break;
         }
+        airtime_charge(p_client, p_message);
     }
-    
-    __LOG_XB(LOG_SRC_APP, LOG_LEVEL_INFO, "Raw", message.p_buffer, len);
+
+    POS_CMD_TRACE_TX(p_message->opcode.opcode, tid, p_message->length, status);
 
     return status;
 }
 
-uint32_t pos_cmd_client_get(pos_cmd_client_t * p_client)
+/**
+ * Checks whether an adaptive Set can be a probe. A server publishes no Status for a Set that
+ * moves it less than its deadband, the same as for a Set to where it is already.
+ */
+static bool set_is_probe(const pos_cmd_client_t * p_client, uint16_t address, struct position_t target)
 {
-    if (p_client == NULL || p_client->status_cb == NULL)
+    const pos_cmd_status_entry_t * p_entry = pos_cmd_status_table_find(&p_client->state.servers, address);
+    if (p_entry == NULL || !p_entry->reported)
     {
-        return NRF_ERROR_NULL;
-    }
-    else if (p_client->state.reliable_transfer_active)
-    {
-        return NRF_ERROR_INVALID_STATE;
+        return true;
     }
 
-    uint32_t status = send_reliable_message(p_client,
-                                            POS_CMD_OPCODE_GET,
-                                            NULL,
-                                            0);
+    int32_t deadband = (p_client->adaptive.deadband > 0) ? p_client->adaptive.deadband : 1;
+    return (abs(target.x - p_entry->present.x) >= deadband || abs(target.y - p_entry->present.y) >= deadband);
+}
+
+static uint16_t adaptive_target_get(const pos_cmd_client_t * p_client)
+{
+    return (uint16_t) (((uint32_t) p_client->adaptive.target_permille * POS_CMD_LINK_DELIVERY_ONE) / 1000);
+}
+
+static uint32_t publish_address_get(const pos_cmd_client_t * p_client, uint16_t * p_address)
+{
+    dsm_handle_t address_handle;
+    nrf_mesh_address_t address;
+    uint32_t status = access_model_publish_address_get(p_client->model_handle, &address_handle);
     if (status == NRF_SUCCESS)
     {
-        p_client->state.reliable_transfer_active = true;
+        status = dsm_address_get(address_handle, &address);
     }
-    return status;
+    if (status != NRF_SUCCESS || address.value == NRF_MESH_ADDR_UNASSIGNED)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    *p_address = address.value;
+    return NRF_SUCCESS;
 }
 
 /**
- * Cancel any ongoing reliable message transfer.
- *
- * @param[in] p_client Pointer to the client instance structure.
+ * Checks whether the last Status and estimated velocity of the server at the publish address
+ * predict a target well enough to skip sending it.
  */
-void pos_cmd_client_pending_msg_cancel(pos_cmd_client_t * p_client)
+static bool set_is_redundant(pos_cmd_client_t * p_client, struct position_t target, timestamp_t now)
+{
+    uint16_t address;
+    if (p_client->dead_reckoning.error_bound == 0 ||
+        publish_address_get(p_client, &address) != NRF_SUCCESS)
+    {
+        return false;
+    }
+
+    const pos_cmd_status_entry_t * p_entry = pos_cmd_status_table_find(&p_client->state.servers, address);
+    if (p_entry == NULL || !p_entry->reported || !p_entry->set_sent ||
+        TIMER_DIFF(now, p_entry->set_timestamp) >= p_client->dead_reckoning.refresh_interval ||
+        TIMER_DIFF(now, p_entry->timestamp) >= p_client->dead_reckoning.refresh_interval)
+    {
+        return false;
+    }
+
+    struct position_t predicted = pos_cmd_status_table_predict(p_entry, now);
+    return (abs(target.x - predicted.x) <= p_client->dead_reckoning.error_bound &&
+            abs(target.y - predicted.y) <= p_client->dead_reckoning.error_bound);
+}
+
+/** Notes the time a Set was sent to the server at the publish address, for @ref set_is_redundant. */
+static void set_sent_record(pos_cmd_client_t * p_client, timestamp_t now)
 {
-    (void)access_model_reliable_cancel(p_client->model_handle);
+    uint16_t address;
+    if (p_client->dead_reckoning.error_bound == 0 ||
+        publish_address_get(p_client, &address) != NRF_SUCCESS)
+    {
+        return;
+    }
+
+    pos_cmd_status_entry_t * p_entry = pos_cmd_status_table_find(&p_client->state.servers, address);
+    if (p_entry != NULL)
+    {
+        p_entry->set_sent = true;
+        p_entry->set_timestamp = now;
+    }
+}
+
+/** Completes the transaction a reply answers, if it is still outstanding. */
+static void transaction_reply_received(pos_cmd_client_t * p_client, uint8_t tid, const access_message_rx_t * p_message)
+{
+    pos_cmd_client_transaction_t * p_transaction = transaction_find(p_client, tid, p_message);
+    if (p_transaction != NULL && reply_opcode_get(p_transaction->opcode) == p_message->opcode.opcode)
+    {
+        reliable_status_cb(p_client, p_transaction, ACCESS_RELIABLE_TRANSFER_SUCCESS);
+        transaction_timer_update(p_client);
+    }
+}
+
+static bool axis_mask_valid(uint16_t mask)
+{
+    return (mask != 0 && (POS_CMD_AXES_MAX >= 16 || (mask >> POS_CMD_AXES_MAX) == 0));
+}
+
+/** Packs the targets of the axes selected by @p mask into an Axis Set message. */
+static uint16_t axis_set_encode(pos_cmd_msg_axis_set_t * p_set, uint8_t tid, uint16_t mask, const int16_t * p_targets)
+{
+    uint16_t count = 0;
+    p_set->tid = tid;
+    p_set->mask = mask;
+    for (uint8_t i = 0; i < POS_CMD_AXES_MAX; ++i)
+    {
+        if (mask & (1u << i))
+        {
+            p_set->targets[count++] = p_targets[i];
+        }
+    }
+    return sizeof(pos_cmd_msg_axis_set_t) + count * sizeof(int16_t);
+}
+
+/** Marks a path chunk as acknowledged, returns whether it was not already. */
+static bool path_chunk_ack(pos_cmd_client_t * p_client, uint16_t seq)
+{
+    uint32_t bit = (1u << (seq % 32));
+    if (p_client->state.path.acked[seq / 32] & bit)
+    {
+        return false;
+    }
+    p_client->state.path.acked[seq / 32] |= bit;
+    return true;
+}
+
+/** Ends the path transfer and reports the outcome. */
+static void path_finish(pos_cmd_client_t * p_client, bool delivered)
+{
+    p_client->state.path.active = false;
+    timer_sch_abort(&p_client->state.path.timer);
+    if (p_client->path_cb != NULL)
+    {
+        p_client->path_cb(p_client, delivered, p_client->state.path.dst);
+    }
+}
+
+static void path_cancel(pos_cmd_client_t * p_client)
+{
+    if (p_client->state.path.active)
+    {
+        p_client->state.stats.cancellations++;
+        POS_CMD_TRACE_EVENT(POS_CMD_OPCODE_PATH_CHUNK, p_client->state.path.tid, 0, POS_CMD_TRACE_STATUS_CANCELLED);
+        path_finish(p_client, false);
+    }
+}
+
+static uint32_t path_chunk_send(pos_cmd_client_t * p_client, uint16_t seq, bool ack_request)
+{
+    uint8_t buffer[sizeof(pos_cmd_msg_path_chunk_t) + POS_CMD_PATH_CHUNK_POINTS * sizeof(struct position_t)];
+    pos_cmd_msg_path_chunk_t * p_chunk = (pos_cmd_msg_path_chunk_t *) buffer;
+    p_chunk->tid = p_client->state.path.tid;
+    p_chunk->seq = (uint8_t) seq;
+    p_chunk->last = (uint8_t) (p_client->state.path.chunk_count - 1);
+    p_chunk->flags = ack_request ? POS_CMD_PATH_FLAG_ACK_REQUEST : 0;
+
+    uint16_t offset = seq * POS_CMD_PATH_CHUNK_POINTS;
+    uint16_t count = p_client->state.path.count - offset;
+    if (count > POS_CMD_PATH_CHUNK_POINTS)
+    {
+        count = POS_CMD_PATH_CHUNK_POINTS;
+    }
+    memcpy(p_chunk->points, &p_client->state.path.p_points[offset], count * sizeof(struct position_t));
+
+    return publish_message(p_client, POS_CMD_OPCODE_PATH_CHUNK, p_chunk->tid, buffer,
+                           sizeof(pos_cmd_msg_path_chunk_t) + count * sizeof(struct position_t));
+}
+
+/**
+ * Sends up to @ref POS_CMD_CLIENT_PATH_BURST chunks that are not acknowledged yet, asking for a
+ * Path Ack with the last one, and starts waiting for the Path Ack.
+ */
+static uint32_t path_burst_send(pos_cmd_client_t * p_client)
+{
+    /* Only send chunks a single Path Ack can report on: the first missing one and the 32 after it. */
+    uint16_t end = p_client->state.path.base + 33;
+    if (end > p_client->state.path.chunk_count)
+    {
+        end = p_client->state.path.chunk_count;
+    }
+
+    uint16_t burst[POS_CMD_CLIENT_PATH_BURST];
+    uint32_t count = 0;
+    for (uint16_t seq = p_client->state.path.base; seq < end && count < POS_CMD_CLIENT_PATH_BURST; ++seq)
+    {
+        if (!(p_client->state.path.acked[seq / 32] & (1u << (seq % 32))))
+        {
+            burst[count++] = seq;
+        }
+    }
+
+    /* A burst cut short by a full TX queue gets no Path Ack, it is sent again on the timeout. */
+    uint32_t status = NRF_SUCCESS;
+    uint32_t sent = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        status = path_chunk_send(p_client, burst[i], (i == count - 1));
+        if (status != NRF_SUCCESS)
+        {
+            break;
+        }
+        sent++;
+    }
+
+    timer_sch_abort(&p_client->state.path.timer);
+    p_client->state.path.timer.timestamp = timer_now() + POS_CMD_CLIENT_PATH_ACK_TIMEOUT;
+    timer_sch_schedule(&p_client->state.path.timer);
+
+    return (sent > 0) ? NRF_SUCCESS : status;
+}
+
+/** Sends the next burst of the path, or gives up after too many bursts without progress. */
+static void path_continue(pos_cmd_client_t * p_client, bool progress)
+{
+    if (progress)
+    {
+        p_client->state.path.attempts = 0;
+    }
+    else if (p_client->state.path.attempts >= POS_CMD_CLIENT_PATH_ATTEMPTS)
+    {
+        p_client->state.stats.timeouts++;
+        POS_CMD_TRACE_EVENT(POS_CMD_OPCODE_PATH_CHUNK, p_client->state.path.tid, 0, POS_CMD_TRACE_STATUS_TIMEOUT);
+        path_finish(p_client, false);
+        return;
+    }
+    else
+    {
+        p_client->state.stats.retransmissions++;
+    }
+
+    p_client->state.path.attempts++;
+    (void) path_burst_send(p_client);
+}
+
+static void path_timer_cb(timestamp_t timestamp, void * p_context)
+{
+    pos_cmd_client_t * p_client = p_context;
+    if (p_client->state.path.active)
+    {
+        path_continue(p_client, false);
+    }
+}
+
+/*****************************************************************************
+ * Opcode handler callback(s)
+ *****************************************************************************/
+
+static void handle_status_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_client_t * p_client = p_args;
+    NRF_MESH_ASSERT(p_client->status_cb != NULL);
+    pos_cmd_stats_opcode_count(p_client->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+
+    if (p_message->length != sizeof(pos_cmd_msg_status_t))
+    {
+        return;
+    }
+
+    const pos_cmd_msg_status_t * p_status = (const pos_cmd_msg_status_t *) p_message->p_data;
+    POS_CMD_TRACE_RX(p_message->opcode.opcode, p_status->tid, p_message->length);
+    pos_cmd_status_entry_t * p_entry = pos_cmd_status_table_add(&p_client->state.servers,
+                                                                p_message->meta_data.src.value);
+    if (p_entry != NULL)
+    {
+        pos_cmd_status_table_report(p_entry, p_status->tid, p_status->present, timer_now());
+        /* Replies to Gets and Stops, and Status messages after another client's Set, carry other
+         * transaction numbers and confirm none of this client's Sets. */
+        if (tid_is_set(p_client, p_status->tid))
+        {
+            pos_cmd_status_table_set_confirm(p_entry, p_status->tid);
+        }
+    }
+
+    /* A reply to a Get, Stop or other request of this client says nothing about the delivery of
+     * unacknowledged Sets, nor does a Status after a Set of another client. */
+    if (tid_is_set(p_client, p_status->tid) && transaction_find(p_client, p_status->tid, p_message) == NULL)
+    {
+        pos_cmd_link_status_received(&p_client->state.links, p_message->meta_data.src.value, p_status->tid,
+                                     timer_now(), adaptive_target_get(p_client), p_client->adaptive.repeats_max);
+    }
+
+    transaction_reply_received(p_client, p_status->tid, p_message);
+
+    p_client->status_cb(p_client, POS_CMD_STATUS_PRESENT, &p_status->present, p_message->meta_data.src.value);
+}
+
+static void handle_stats_status_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_client_t * p_client = p_args;
+    pos_cmd_stats_opcode_count(p_client->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+
+    if (p_message->length != sizeof(pos_cmd_msg_stats_status_t))
+    {
+        return;
+    }
+
+    const pos_cmd_msg_stats_status_t * p_status = (const pos_cmd_msg_stats_status_t *) p_message->p_data;
+    POS_CMD_TRACE_RX(p_message->opcode.opcode, p_status->tid, p_message->length);
+    transaction_reply_received(p_client, p_status->tid, p_message);
+
+    if (p_client->stats_cb != NULL)
+    {
+        /* Copy out of the packed message so the application gets an aligned structure. */
+        pos_cmd_stats_t stats = p_status->stats;
+        p_client->stats_cb(p_client, &stats, p_message->meta_data.src.value);
+    }
+}
+
+static void handle_axis_status_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_client_t * p_client = p_args;
+    pos_cmd_stats_opcode_count(p_client->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+
+    if (p_message->length < sizeof(pos_cmd_msg_axis_status_t))
+    {
+        return;
+    }
+
+    const pos_cmd_msg_axis_status_t * p_status = (const pos_cmd_msg_axis_status_t *) p_message->p_data;
+    uint16_t count = (uint16_t) __builtin_popcount(p_status->mask);
+    if (p_message->length != sizeof(pos_cmd_msg_axis_status_t) + count * sizeof(int16_t))
+    {
+        return;
+    }
+
+    POS_CMD_TRACE_RX(p_message->opcode.opcode, p_status->tid, p_message->length);
+    transaction_reply_received(p_client, p_status->tid, p_message);
+
+    if (p_client->axis_status_cb != NULL)
+    {
+        int16_t present[POS_CMD_AXES_MAX];
+        uint16_t n = 0;
+        for (uint8_t i = 0; i < POS_CMD_AXES_MAX; ++i)
+        {
+            present[i] = (p_status->mask & (1u << i)) ? p_status->present[n++] : 0;
+        }
+        p_client->axis_status_cb(p_client, p_status->mask, present, p_message->meta_data.src.value);
+    }
+}
+
+static void handle_path_ack_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_client_t * p_client = p_args;
+    pos_cmd_stats_opcode_count(p_client->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+
+    if (p_message->length != sizeof(pos_cmd_msg_path_ack_t))
+    {
+        return;
+    }
+
+    const pos_cmd_msg_path_ack_t * p_ack = (const pos_cmd_msg_path_ack_t *) p_message->p_data;
+    POS_CMD_TRACE_RX(p_message->opcode.opcode, p_ack->tid, p_message->length);
+    if (!p_client->state.path.active ||
+        p_ack->tid != p_client->state.path.tid ||
+        p_message->meta_data.src.value != p_client->state.path.dst)
+    {
+        return;
+    }
+
+    bool progress = false;
+    uint16_t chunk_count = p_client->state.path.chunk_count;
+    for (uint16_t seq = p_client->state.path.base; seq < p_ack->next && seq < chunk_count; ++seq)
+    {
+        progress |= path_chunk_ack(p_client, seq);
+    }
+    for (uint16_t i = 0; i < 32 && p_ack->next + 1 + i < chunk_count; ++i)
+    {
+        if (p_ack->received & (1u << i))
+        {
+            progress |= path_chunk_ack(p_client, p_ack->next + 1 + i);
+        }
+    }
+
+    while (p_client->state.path.base < chunk_count &&
+           (p_client->state.path.acked[p_client->state.path.base / 32] & (1u << (p_client->state.path.base % 32))))
+    {
+        p_client->state.path.base++;
+    }
+
+    if (p_client->state.path.base == chunk_count)
+    {
+        path_finish(p_client, true);
+    }
+    else
+    {
+        path_continue(p_client, progress);
+    }
+}
+
+static const access_opcode_handler_t m_opcode_handlers[] =
+{
+    {{POS_CMD_OPCODE_STATUS, POS_CMD_COMPANY_ID}, handle_status_cb},
+    {{POS_CMD_OPCODE_STATS_STATUS, POS_CMD_COMPANY_ID}, handle_stats_status_cb},
+    {{POS_CMD_OPCODE_AXIS_STATUS, POS_CMD_COMPANY_ID}, handle_axis_status_cb},
+    {{POS_CMD_OPCODE_PATH_ACK, POS_CMD_COMPANY_ID}, handle_path_ack_cb}
+};
+
+static void handle_publish_timeout(access_model_handle_t handle, void * p_args)
+{
+    pos_cmd_client_t * p_client = p_args;
+
+    if (p_client->timeout_cb != NULL)
+    {
+        p_client->timeout_cb(handle, p_args);
+    }
+}
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+uint32_t pos_cmd_client_init(pos_cmd_client_t * p_client, uint16_t element_index)
+{
+    if (p_client == NULL ||
+        p_client->status_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    memset(&p_client->state, 0, sizeof(p_client->state));
+    p_client->state.timer.cb = transaction_timer_cb;
+    p_client->state.timer.p_context = p_client;
+    p_client->state.path.timer.cb = path_timer_cb;
+    p_client->state.path.timer.p_context = p_client;
+    p_client->state.airtime.timer.cb = airtime_timer_cb;
+    p_client->state.airtime.timer.p_context = p_client;
+
+    access_model_add_params_t init_params;
+    init_params.model_id.model_id = POS_CMD_CLIENT_MODEL_ID;
+    init_params.model_id.company_id = POS_CMD_COMPANY_ID;
+    init_params.element_index = element_index;
+    init_params.p_opcode_handlers = &m_opcode_handlers[0];
+    init_params.opcode_count = sizeof(m_opcode_handlers) / sizeof(m_opcode_handlers[0]);
+    init_params.p_args = p_client;
+    init_params.publish_timeout_cb = handle_publish_timeout;
+    return access_model_add(&init_params, &p_client->model_handle);
+}
+
+uint32_t pos_cmd_client_set(pos_cmd_client_t * p_client, struct position_t target)
+{
+    if (p_client == NULL || p_client->status_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (p_client->coalesce &&
+        (p_client->state.pending_valid || transaction_free_get(p_client) == NULL))
+    {
+        /* Latest wins: replace whatever target is still waiting for a free slot. */
+        p_client->state.pending_target = target;
+        p_client->state.pending_valid = true;
+        return NRF_SUCCESS;
+    }
+
+    return send_set(p_client, target);
+}
+
+uint32_t pos_cmd_client_set_unreliable(pos_cmd_client_t * p_client, struct position_t target, uint8_t repeats)
+{
+    if (p_client == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    timestamp_t now = timer_now();
+    if (set_is_redundant(p_client, target, now))
+    {
+        return NRF_SUCCESS;
+    }
+
+    pos_cmd_msg_set_unreliable_t set_unreliable;
+    set_unreliable.target = target;
+    set_unreliable.tid = tid_take(p_client, true);
+
+    access_message_tx_t message;
+    message.opcode.opcode = POS_CMD_OPCODE_SET_UNRELIABLE;
+    message.opcode.company_id = POS_CMD_COMPANY_ID;
+    message.p_buffer = (const uint8_t *) &set_unreliable;
+    message.length = sizeof(set_unreliable);
+    message.force_segmented = false;
+    message.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+
+    uint32_t status = publish_repeated(p_client, &message, set_unreliable.tid, repeats);
+    if (status == NRF_SUCCESS)
+    {
+        set_sent_record(p_client, now);
+    }
+    return status;
+}
+
+uint32_t pos_cmd_client_set_unreliable_adaptive(pos_cmd_client_t * p_client, struct position_t target)
+{
+    if (p_client == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (p_client->adaptive.repeats_max == 0 || p_client->adaptive.target_permille > 1000)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint16_t address;
+    uint32_t status = publish_address_get(p_client, &address);
+    if (status != NRF_SUCCESS)
+    {
+        return status;
+    }
+
+    pos_cmd_link_t * p_link = pos_cmd_link_get(&p_client->state.links, address, p_client->adaptive.repeats_max);
+    uint8_t tid = p_client->state.tid;
+    status = pos_cmd_client_set_unreliable(p_client, target, p_link->repeats);
+    /* A Set suppressed by dead-reckoning took no transaction number and is not a probe either. */
+    if (status == NRF_SUCCESS && p_client->state.tid != tid)
+    {
+        pos_cmd_link_sent(p_link, tid, set_is_probe(p_client, address, target), timer_now(),
+                          adaptive_target_get(p_client), p_client->adaptive.repeats_max);
+    }
+    return status;
+}
+
+uint32_t pos_cmd_client_set_batch_unreliable(pos_cmd_client_t * p_client,
+                                             const struct position_t * p_targets,
+                                             uint8_t count,
+                                             uint8_t repeats)
+{
+    if (p_client == NULL || p_targets == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (count == 0 || count > POS_CMD_BATCH_POSITIONS_MAX)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t buffer[sizeof(pos_cmd_msg_set_batch_t) + POS_CMD_BATCH_POSITIONS_MAX * sizeof(struct position_t)];
+    pos_cmd_msg_set_batch_t * p_batch = (pos_cmd_msg_set_batch_t *) buffer;
+    p_batch->tid = tid_take(p_client, true);
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        p_batch->targets[i] = p_targets[i];
+    }
+
+    access_message_tx_t message;
+    message.opcode.opcode = POS_CMD_OPCODE_SET_BATCH_UNRELIABLE;
+    message.opcode.company_id = POS_CMD_COMPANY_ID;
+    message.p_buffer = buffer;
+    message.length = sizeof(pos_cmd_msg_set_batch_t) + count * sizeof(struct position_t);
+    message.force_segmented = false;
+    message.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+
+    return publish_repeated(p_client, &message, p_batch->tid, repeats);
+}
+
+uint32_t pos_cmd_client_set_delta_unreliable(pos_cmd_client_t * p_client,
+                                             const struct position_t * p_targets,
+                                             uint8_t count,
+                                             uint8_t repeats)
+{
+    if (p_client == NULL || p_client->status_cb == NULL || p_targets == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (count == 0 || count > POS_CMD_BATCH_POSITIONS_MAX ||
+             p_client->delta_shift > POS_CMD_CODEC_SHIFT_MAX)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t buffer[sizeof(pos_cmd_msg_set_delta_t) + POS_CMD_BATCH_POSITIONS_MAX * sizeof(pos_cmd_delta_t)];
+    pos_cmd_msg_set_delta_t * p_delta = (pos_cmd_msg_set_delta_t *) buffer;
+
+    if (p_client->state.delta.ref_valid &&
+        p_client->state.delta.count < POS_CMD_CLIENT_DELTA_KEYFRAME_INTERVAL &&
+        pos_cmd_codec_delta_encode(&p_client->state.delta.ref, p_targets, count, p_client->delta_shift, p_delta->deltas))
+    {
+        p_delta->tid = tid_take(p_client, true);
+        p_delta->ref_tid = p_client->state.delta.ref_tid;
+        p_delta->shift = p_client->delta_shift;
+        p_client->state.delta.count++;
+
+        access_message_tx_t message;
+        message.opcode.opcode = POS_CMD_OPCODE_SET_DELTA_UNRELIABLE;
+        message.opcode.company_id = POS_CMD_COMPANY_ID;
+        message.p_buffer = buffer;
+        message.length = sizeof(pos_cmd_msg_set_delta_t) + count * sizeof(pos_cmd_delta_t);
+        message.force_segmented = false;
+        message.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+
+        return publish_repeated(p_client, &message, p_delta->tid, repeats);
+    }
+    else if (!p_client->state.delta.keyframe_pending)
+    {
+        /* Keyframe: an acknowledged Set of the final target becomes the new reference. */
+        uint8_t tid = p_client->state.tid;
+        uint32_t status = send_set(p_client, p_targets[count - 1]);
+        if (status == NRF_SUCCESS)
+        {
+            p_client->state.delta.keyframe_pending = true;
+            p_client->state.delta.keyframe_tid = tid;
+        }
+        return status;
+    }
+    else
+    {
+        /* Keyframe still in flight, send the targets in full meanwhile. */
+        return pos_cmd_client_set_batch_unreliable(p_client, p_targets, count, repeats);
+    }
+}
+
+uint32_t pos_cmd_client_trajectory_unreliable(pos_cmd_client_t * p_client,
+                                              const struct position_t * p_waypoints,
+                                              uint8_t count,
+                                              uint16_t leg_time_ms,
+                                              uint8_t repeats)
+{
+    if (p_client == NULL || p_waypoints == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (count == 0 || count > POS_CMD_TRAJECTORY_WAYPOINTS_MAX)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t buffer[sizeof(pos_cmd_msg_trajectory_t) + POS_CMD_TRAJECTORY_WAYPOINTS_MAX * sizeof(struct position_t)];
+    pos_cmd_msg_trajectory_t * p_trajectory = (pos_cmd_msg_trajectory_t *) buffer;
+    p_trajectory->tid = tid_take(p_client, true);
+    p_trajectory->leg_time_ms = leg_time_ms;
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        p_trajectory->waypoints[i] = p_waypoints[i];
+    }
+
+    access_message_tx_t message;
+    message.opcode.opcode = POS_CMD_OPCODE_TRAJECTORY_UNRELIABLE;
+    message.opcode.company_id = POS_CMD_COMPANY_ID;
+    message.p_buffer = buffer;
+    message.length = sizeof(pos_cmd_msg_trajectory_t) + count * sizeof(struct position_t);
+    message.force_segmented = false;
+    message.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+
+    return publish_repeated(p_client, &message, p_trajectory->tid, repeats);
+}
+
+uint32_t pos_cmd_client_set_scheduled(pos_cmd_client_t * p_client,
+                                      struct position_t target,
+                                      uint16_t time_ms,
+                                      bool absolute)
+{
+    if (p_client == NULL || p_client->status_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    uint8_t * p_buffer;
+    uint32_t status = request_buffer_alloc(p_client, sizeof(pos_cmd_msg_set_scheduled_t), &p_buffer);
+    if (status != NRF_SUCCESS)
+    {
+        return status;
+    }
+
+    pos_cmd_msg_set_scheduled_t * p_set = (pos_cmd_msg_set_scheduled_t *) p_buffer;
+    p_set->target = target;
+    p_set->tid = tid_take(p_client, true);
+    p_set->time_ms = time_ms;
+    p_set->flags = absolute ? POS_CMD_SCHEDULED_FLAG_ABSOLUTE : 0;
+
+    return send_reliable_message(p_client,
+                                 POS_CMD_OPCODE_SET_SCHEDULED,
+                                 p_set->tid,
+                                 p_buffer,
+                                 sizeof(pos_cmd_msg_set_scheduled_t));
+}
+
+uint32_t pos_cmd_client_axis_set(pos_cmd_client_t * p_client, uint16_t mask, const int16_t * p_targets)
+{
+    if (p_client == NULL || p_client->status_cb == NULL || p_targets == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    uint16_t length = sizeof(pos_cmd_msg_axis_set_t) + __builtin_popcount(mask) * sizeof(int16_t);
+    if (!axis_mask_valid(mask) || length > POS_CMD_UNSEGMENTED_PARAMS_MAX)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t * p_buffer;
+    uint32_t status = request_buffer_alloc(p_client, length, &p_buffer);
+    if (status != NRF_SUCCESS)
+    {
+        return status;
+    }
+
+    uint8_t tid = tid_take(p_client, false);
+    (void) axis_set_encode((pos_cmd_msg_axis_set_t *) p_buffer, tid, mask, p_targets);
+
+    return send_reliable_message(p_client, POS_CMD_OPCODE_AXIS_SET, tid, p_buffer, length);
+}
+
+uint32_t pos_cmd_client_axis_set_unreliable(pos_cmd_client_t * p_client,
+                                            uint16_t mask,
+                                            const int16_t * p_targets,
+                                            uint8_t repeats)
+{
+    if (p_client == NULL || p_targets == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (!axis_mask_valid(mask))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t buffer[sizeof(pos_cmd_msg_axis_set_t) + POS_CMD_AXES_MAX * sizeof(int16_t)];
+    uint8_t tid = tid_take(p_client, false);
+
+    access_message_tx_t message;
+    message.opcode.opcode = POS_CMD_OPCODE_AXIS_SET_UNRELIABLE;
+    message.opcode.company_id = POS_CMD_COMPANY_ID;
+    message.p_buffer = buffer;
+    message.length = axis_set_encode((pos_cmd_msg_axis_set_t *) buffer, tid, mask, p_targets);
+    message.force_segmented = false;
+    message.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+
+    return publish_repeated(p_client, &message, tid, repeats);
+}
+
+uint32_t pos_cmd_client_axis_get(pos_cmd_client_t * p_client, uint16_t mask)
+{
+    if (p_client == NULL || p_client->status_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (!axis_mask_valid(mask))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t * p_buffer;
+    uint32_t status = request_buffer_alloc(p_client, sizeof(pos_cmd_msg_axis_get_t), &p_buffer);
+    if (status != NRF_SUCCESS)
+    {
+        return status;
+    }
+
+    pos_cmd_msg_axis_get_t * p_get = (pos_cmd_msg_axis_get_t *) p_buffer;
+    p_get->tid = tid_take(p_client, false);
+    p_get->mask = mask;
+
+    return send_reliable_message(p_client,
+                                 POS_CMD_OPCODE_AXIS_GET,
+                                 p_get->tid,
+                                 p_buffer,
+                                 sizeof(pos_cmd_msg_axis_get_t));
+}
+
+uint32_t pos_cmd_client_path_send(pos_cmd_client_t * p_client, const struct position_t * p_points, uint16_t count)
+{
+    if (p_client == NULL || p_points == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (count == 0 || count > POS_CMD_PATH_POINTS_MAX)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    else if (p_client->state.path.active)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    uint16_t dst;
+    uint32_t status = publish_address_get(p_client, &dst);
+    if (status != NRF_SUCCESS)
+    {
+        return status;
+    }
+    else if (nrf_mesh_address_type_get(dst) != NRF_MESH_ADDRESS_TYPE_UNICAST)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    memset(p_client->state.path.acked, 0, sizeof(p_client->state.path.acked));
+    p_client->state.path.active = true;
+    p_client->state.path.tid = tid_take(p_client, true);
+    p_client->state.path.attempts = 1;
+    p_client->state.path.dst = dst;
+    p_client->state.path.p_points = p_points;
+    p_client->state.path.count = count;
+    p_client->state.path.chunk_count = (count + POS_CMD_PATH_CHUNK_POINTS - 1) / POS_CMD_PATH_CHUNK_POINTS;
+    p_client->state.path.base = 0;
+
+    status = path_burst_send(p_client);
+    if (status != NRF_SUCCESS)
+    {
+        p_client->state.path.active = false;
+        timer_sch_abort(&p_client->state.path.timer);
+    }
+    return status;
+}
+
+uint32_t pos_cmd_client_stop(pos_cmd_client_t * p_client)
+{
+    if (p_client == NULL || p_client->status_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    pos_cmd_client_transaction_t * p_stop = &p_client->state.transactions[POS_CMD_CLIENT_WINDOW_SIZE];
+    if (p_stop->active)
+    {
+        reliable_status_cb(p_client, p_stop, ACCESS_RELIABLE_TRANSFER_CANCELLED);
+        if (p_stop->active)
+        {
+            /* The application issued a Stop from the status callback already. */
+            return NRF_SUCCESS;
+        }
+    }
+
+    pos_cmd_msg_stop_t * p_msg = (pos_cmd_msg_stop_t *) p_client->state.stop_buffer;
+    p_msg->tid = tid_take(p_client, false);
+    uint32_t status = publish_message(p_client, POS_CMD_OPCODE_STOP, p_msg->tid,
+                                      p_client->state.stop_buffer, sizeof(pos_cmd_msg_stop_t));
+    /* Without a free buffer the Stop is retried by the retransmission timer like a lost copy, it
+     * is not given up while the Sets it cancels are. */
+    if (status != NRF_SUCCESS && status != NRF_ERROR_NO_MEM)
+    {
+        return status;
+    }
+    transaction_track(p_client, p_stop, POS_CMD_OPCODE_STOP, p_msg->tid, p_client->state.stop_buffer,
+                      sizeof(pos_cmd_msg_stop_t), POS_CMD_CLIENT_STOP_RETRANSMIT_INTERVAL);
+
+    /* Unreliable messages still waiting for the budget would move the server after the Stop. */
+    p_client->state.airtime.dropped += p_client->state.airtime.count;
+    p_client->state.airtime.count = 0;
+    timer_sch_abort(&p_client->state.airtime.timer);
+    p_client->state.airtime.scheduled = false;
+
+    /* Drop the coalesced Set before the slots are freed below, or it would take one of them. */
+    if (p_client->state.pending_valid)
+    {
+        p_client->state.pending_valid = false;
+        p_client->status_cb(p_client, POS_CMD_STATUS_CANCELLED, NULL, NRF_MESH_ADDR_UNASSIGNED);
+    }
+
+    /* Only cancel the Sets sent before the Stop, not those started from the status callback. */
+    bool path_superseded = p_client->state.path.active;
+    uint32_t superseded = 0;
+    for (uint32_t i = 0; i < POS_CMD_CLIENT_WINDOW_SIZE; ++i)
+    {
+        if (p_client->state.transactions[i].active &&
+            (p_client->state.transactions[i].opcode == POS_CMD_OPCODE_SET ||
+             p_client->state.transactions[i].opcode == POS_CMD_OPCODE_SET_SCHEDULED))
+        {
+            superseded |= (1u << i);
+        }
+    }
+
+    for (uint32_t i = 0; i < POS_CMD_CLIENT_WINDOW_SIZE; ++i)
+    {
+        if (superseded & (1u << i))
+        {
+            reliable_status_cb(p_client, &p_client->state.transactions[i], ACCESS_RELIABLE_TRANSFER_CANCELLED);
+        }
+    }
+    transaction_timer_update(p_client);
+    if (path_superseded)
+    {
+        path_cancel(p_client);
+    }
+
+    return NRF_SUCCESS;
+}
+
+uint32_t pos_cmd_client_get(pos_cmd_client_t * p_client)
+{
+    if (p_client == NULL || p_client->status_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    uint16_t address;
+    if (p_client->get_cache_ttl != 0 && publish_address_get(p_client, &address) == NRF_SUCCESS)
+    {
+        const pos_cmd_status_entry_t * p_entry = pos_cmd_status_table_find(&p_client->state.servers, address);
+        if (p_entry != NULL && p_entry->reported &&
+            TIMER_DIFF(timer_now(), p_entry->timestamp) < p_client->get_cache_ttl)
+        {
+            /* Copy, the status callback may change the table. */
+            struct position_t present = p_entry->present;
+            p_client->status_cb(p_client, POS_CMD_STATUS_PRESENT, &present, address);
+            return NRF_SUCCESS;
+        }
+    }
+
+    uint8_t * p_buffer;
+    uint32_t status = request_buffer_alloc(p_client, sizeof(pos_cmd_msg_get_t), &p_buffer);
+    if (status != NRF_SUCCESS)
+    {
+        return status;
+    }
+
+    pos_cmd_msg_get_t * p_get = (pos_cmd_msg_get_t *) p_buffer;
+    p_get->tid = tid_take(p_client, false);
+
+    return send_reliable_message(p_client,
+                                 POS_CMD_OPCODE_GET,
+                                 p_get->tid,
+                                 p_buffer,
+                                 sizeof(pos_cmd_msg_get_t));
+}
+
+uint32_t pos_cmd_client_stats_request(pos_cmd_client_t * p_client)
+{
+    if (p_client == NULL || p_client->status_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    uint8_t * p_buffer;
+    uint32_t status = request_buffer_alloc(p_client, sizeof(pos_cmd_msg_stats_get_t), &p_buffer);
+    if (status != NRF_SUCCESS)
+    {
+        return status;
+    }
+
+    pos_cmd_msg_stats_get_t * p_stats_get = (pos_cmd_msg_stats_get_t *) p_buffer;
+    p_stats_get->tid = tid_take(p_client, false);
+
+    return send_reliable_message(p_client,
+                                 POS_CMD_OPCODE_STATS_GET,
+                                 p_stats_get->tid,
+                                 p_buffer,
+                                 sizeof(pos_cmd_msg_stats_get_t));
+}
+
+const pos_cmd_stats_t * pos_cmd_client_stats_get(const pos_cmd_client_t * p_client)
+{
+    return &p_client->state.stats;
+}
+
+void pos_cmd_client_stats_reset(pos_cmd_client_t * p_client)
+{
+    memset(&p_client->state.stats, 0, sizeof(p_client->state.stats));
+}
+
+uint32_t pos_cmd_client_server_add(pos_cmd_client_t * p_client, uint16_t address)
+{
+    if (p_client == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    else if (address == NRF_MESH_ADDR_UNASSIGNED)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    return (pos_cmd_status_table_add(&p_client->state.servers, address) != NULL) ? NRF_SUCCESS : NRF_ERROR_NO_MEM;
+}
+
+const pos_cmd_status_table_t * pos_cmd_client_status_table_get(const pos_cmd_client_t * p_client)
+{
+    return &p_client->state.servers;
+}
+
+void pos_cmd_client_airtime_usage_get(const pos_cmd_client_t * p_client, pos_cmd_client_airtime_usage_t * p_usage)
+{
+    pos_cmd_airtime_bucket_t bucket = p_client->state.airtime.bucket;
+    if (p_client->airtime.share_permille != 0)
+    {
+        pos_cmd_airtime_refill(&bucket, timer_now(), p_client->airtime.share_permille, p_client->airtime.burst_us);
+    }
+
+    p_usage->available_us = bucket.tokens;
+    p_usage->used_us = bucket.used;
+    p_usage->queued = p_client->state.airtime.count;
+    p_usage->deferred = p_client->state.airtime.deferred;
+    p_usage->dropped = p_client->state.airtime.dropped;
+}
+
+uint8_t pos_cmd_client_last_tid_get(const pos_cmd_client_t * p_client)
+{
+    return (uint8_t) (p_client->state.tid - 1);
+}
+
+/**
+ * Cancel any ongoing reliable message transfer.
+ *
+ * @param[in] p_client Pointer to the client instance structure.
+ */
+void pos_cmd_client_pending_msg_cancel(pos_cmd_client_t * p_client)
+{
+    if (p_client->state.pending_valid)
+    {
+        p_client->state.pending_valid = false;
+        p_client->status_cb(p_client, POS_CMD_STATUS_CANCELLED, NULL, NRF_MESH_ADDR_UNASSIGNED);
+    }
+
+    /* Only cancel what is pending now, not transactions started from the status callback. */
+    bool path_pending = p_client->state.path.active;
+    uint32_t pending = 0;
+    for (uint32_t i = 0; i < POS_CMD_CLIENT_TRANSACTION_COUNT; ++i)
+    {
+        if (p_client->state.transactions[i].active)
+        {
+            pending |= (1u << i);
+        }
+    }
+
+    for (uint32_t i = 0; i < POS_CMD_CLIENT_TRANSACTION_COUNT; ++i)
+    {
+        if (pending & (1u << i))
+        {
+            reliable_status_cb(p_client, &p_client->state.transactions[i], ACCESS_RELIABLE_TRANSFER_CANCELLED);
+        }
+    }
+    transaction_timer_update(p_client);
+    if (path_pending)
+    {
+        path_cancel(p_client);
+    }
 }
@@ -0,0 +1,79 @@
+#include "pos_cmd_codec.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_mesh_assert.h"
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static bool coordinate_encode(int16_t ref, int16_t target, uint8_t shift, int8_t * p_delta)
+{
+    int32_t diff = (int32_t) target - ref;
+    int32_t half = (shift > 0) ? (1 << (shift - 1)) : 0;
+    /* Round to nearest, symmetrically around zero. */
+    int32_t quantized = (diff >= 0) ? ((diff + half) >> shift) : -((-diff + half) >> shift);
+
+    if (quantized < INT8_MIN || quantized > INT8_MAX)
+    {
+        return false;
+    }
+
+    *p_delta = (int8_t) quantized;
+    return true;
+}
+
+static int16_t coordinate_decode(int16_t ref, int8_t delta, uint8_t shift)
+{
+    int32_t value = (int32_t) ref + (int32_t) delta * (1 << shift);
+
+    if (value < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    else if (value > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    return (int16_t) value;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+bool pos_cmd_codec_delta_encode(const struct position_t * p_ref,
+                                const struct position_t * p_targets,
+                                uint16_t count,
+                                uint8_t shift,
+                                pos_cmd_delta_t * p_deltas)
+{
+    NRF_MESH_ASSERT(shift <= POS_CMD_CODEC_SHIFT_MAX);
+
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        if (!coordinate_encode(p_ref->x, p_targets[i].x, shift, &p_deltas[i].dx) ||
+            !coordinate_encode(p_ref->y, p_targets[i].y, shift, &p_deltas[i].dy))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void pos_cmd_codec_delta_decode(const struct position_t * p_ref,
+                                const pos_cmd_delta_t * p_deltas,
+                                uint16_t count,
+                                uint8_t shift,
+                                struct position_t * p_targets)
+{
+    NRF_MESH_ASSERT(shift <= POS_CMD_CODEC_SHIFT_MAX);
+
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        p_targets[i].x = coordinate_decode(p_ref->x, p_deltas[i].dx, shift);
+        p_targets[i].y = coordinate_decode(p_ref->y, p_deltas[i].dy, shift);
+    }
+}
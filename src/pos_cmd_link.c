@@ -0,0 +1,123 @@
+#include "pos_cmd_link.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "nrf_mesh.h"
+#include "nrf_mesh_assert.h"
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+/** Updates the delivery ratio with one probe outcome and adjusts the repeat count. */
+static void outcome_record(pos_cmd_link_t * p_link, bool delivered, uint16_t target, uint8_t repeats_max)
+{
+    p_link->probe_pending = false;
+
+    /* Exponential moving average with weight 1/8, about the last 8 probes. */
+    int32_t sample = delivered ? POS_CMD_LINK_DELIVERY_ONE : 0;
+    p_link->delivery = (uint16_t) ((int32_t) p_link->delivery + (sample - (int32_t) p_link->delivery) / 8);
+
+    if (p_link->samples < UINT8_MAX)
+    {
+        p_link->samples++;
+    }
+
+    if (p_link->delivery < target)
+    {
+        if (p_link->samples >= POS_CMD_LINK_HOLD_SAMPLES && p_link->repeats < repeats_max)
+        {
+            p_link->repeats++;
+            p_link->samples = 0;
+            /* Start the new repeat count from the target, so the old losses do not raise it again. */
+            p_link->delivery = target;
+        }
+    }
+    else if (p_link->samples >= POS_CMD_LINK_BACKOFF_SAMPLES && p_link->repeats > 1)
+    {
+        p_link->repeats--;
+        p_link->samples = 0;
+        p_link->delivery = target;
+    }
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+pos_cmd_link_t * pos_cmd_link_get(pos_cmd_link_table_t * p_table, uint16_t address, uint8_t repeats_max)
+{
+    NRF_MESH_ASSERT(address != NRF_MESH_ADDR_UNASSIGNED);
+
+    for (uint32_t i = 0; i < POS_CMD_LINK_TABLE_SIZE; ++i)
+    {
+        if (p_table->links[i].address == address)
+        {
+            pos_cmd_link_t * p_link = &p_table->links[i];
+            if (p_link->repeats > repeats_max)
+            {
+                p_link->repeats = repeats_max;
+            }
+            return p_link;
+        }
+    }
+
+    pos_cmd_link_t * p_link = &p_table->links[p_table->next];
+    p_table->next = (p_table->next + 1) % POS_CMD_LINK_TABLE_SIZE;
+
+    memset(p_link, 0, sizeof(*p_link));
+    p_link->address = address;
+    p_link->delivery = POS_CMD_LINK_DELIVERY_ONE;
+    p_link->repeats = repeats_max;
+    return p_link;
+}
+
+void pos_cmd_link_sent(pos_cmd_link_t * p_link,
+                       uint8_t tid,
+                       bool probe,
+                       timestamp_t now,
+                       uint16_t target,
+                       uint8_t repeats_max)
+{
+    if (p_link->probe_pending &&
+        !TIMER_OLDER_THAN(now, p_link->probe_sent + POS_CMD_LINK_PROBE_TIMEOUT))
+    {
+        outcome_record(p_link, false, target, repeats_max);
+    }
+
+    if (probe && !p_link->probe_pending)
+    {
+        p_link->probe_pending = true;
+        p_link->probe_tid = tid;
+        p_link->probe_sent = now;
+    }
+}
+
+void pos_cmd_link_status_received(pos_cmd_link_table_t * p_table,
+                                  uint16_t src,
+                                  uint8_t tid,
+                                  timestamp_t now,
+                                  uint16_t target,
+                                  uint8_t repeats_max)
+{
+    for (uint32_t i = 0; i < POS_CMD_LINK_TABLE_SIZE; ++i)
+    {
+        pos_cmd_link_t * p_link = &p_table->links[i];
+        if (!p_link->probe_pending ||
+            (nrf_mesh_address_type_get(p_link->address) == NRF_MESH_ADDRESS_TYPE_UNICAST && p_link->address != src))
+        {
+            continue;
+        }
+
+        /* The server publishes the newest Set it applied, which is often past the probe. A later
+         * Set that got through after the probe was lost counts too, the repeat count is then
+         * still high enough to reach the server. */
+        if ((int8_t) (tid - p_link->probe_tid) >= 0)
+        {
+            bool in_time = TIMER_OLDER_THAN(now, p_link->probe_sent + POS_CMD_LINK_PROBE_TIMEOUT);
+            outcome_record(p_link, in_time, target, repeats_max);
+        }
+    }
+}
@@ -4,31 +4,41 @@
 //                  Credit is given where credit is due.
 // Purpose: 
 //                  pos_cmd_server is a minimalistic communication server
-//                  model. It is fully embedded into BLE Mesh and sends
-//                  an array of uint8_t by any desires.
+//                  model. It is fully embedded into BLE Mesh and receives
+//                  target positions and reports the present position.
 //
 /***********************************************************************/
 
 #include "pos_cmd_server.h"
 #include "pos_cmd_common.h"
+#include "pos_cmd_codec.h"
+#include "pos_cmd_stats.h"
+#include "pos_cmd_trace.h"
+#include "pos_cmd_capture.h"
 
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "access.h"
 #include "nrf_mesh_assert.h"
+#include "timer.h"
+#include "timer_scheduler.h"
+#include "toolchain.h"
 #include "log.h"
 
 /*****************************************************************************
  * Static functions
  *****************************************************************************/
 
-static void reply_status(const pos_cmd_server_t * p_server,
+static void reply_status(pos_cmd_server_t * p_server,
                          const access_message_rx_t * p_message,
-                         uint8_t * present_state)
+                         struct position_t present,
+                         uint8_t tid)
 {
     pos_cmd_msg_status_t status;
-    status.present_state = present_state;
+    status.present = present;
+    status.tid = tid;
     access_message_tx_t reply;
     reply.opcode.opcode = POS_CMD_OPCODE_STATUS;
     reply.opcode.company_id = POS_CMD_COMPANY_ID;
@@ -38,49 +48,712 @@ static void reply_status(const pos_cmd_server_t * p_server,
     reply.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
     reply.access_token = nrf_mesh_unique_token_get();
 
-    (void) access_model_reply(p_server->model_handle, p_message, &reply);
+    pos_cmd_stats_opcode_count(p_server->state.stats.tx, POS_CMD_OPCODE_STATUS);
+    uint32_t error_code = access_model_reply(p_server->model_handle, p_message, &reply);
+    POS_CMD_CAPTURE_TX(p_server->model_handle, p_message, &reply, error_code);
+    if (error_code != NRF_SUCCESS)
+    {
+        p_server->state.stats.publish_failures++;
+    }
+    POS_CMD_TRACE_TX(POS_CMD_OPCODE_STATUS, tid, reply.length, error_code);
+}
+
+/**
+ * Checks whether a message was already received within @ref POS_CMD_SERVER_TID_CACHE_WINDOW,
+ * and remembers it if not.
+ *
+ * Every Set variant and Stop pass each received copy through here, so this is also where they are traced.
+ */
+static bool tid_is_duplicate(pos_cmd_server_t * p_server, const access_message_rx_t * p_message, uint8_t tid)
+{
+    return pos_cmd_server_tid_is_duplicate(p_server->state.tid_cache, &p_server->state.tid_cache_next,
+                                           &p_server->state.stats, p_message, tid);
+}
+
+/** Remembers the target of a Set as the Set Delta reference of its client. */
+static void delta_ref_store(pos_cmd_server_t * p_server, uint16_t src, uint8_t tid, struct position_t position)
+{
+    pos_cmd_server_delta_ref_t * p_slot = NULL;
+
+    for (uint32_t i = 0; i < POS_CMD_SERVER_DELTA_REF_COUNT; ++i)
+    {
+        pos_cmd_server_delta_ref_t * p_entry = &p_server->state.delta_refs[i];
+        if (p_entry->src == src)
+        {
+            p_slot = p_entry;
+            break;
+        }
+        else if (p_slot == NULL || p_entry->src == NRF_MESH_ADDR_UNASSIGNED ||
+                 (p_slot->src != NRF_MESH_ADDR_UNASSIGNED && TIMER_OLDER_THAN(p_entry->timestamp, p_slot->timestamp)))
+        {
+            p_slot = p_entry;
+        }
+    }
+
+    p_slot->src = src;
+    p_slot->tid = tid;
+    p_slot->position = position;
+    p_slot->timestamp = timer_now();
+}
+
+/** Gets the Set Delta reference of a client, or NULL if it is not the one the client refers to. */
+static const pos_cmd_server_delta_ref_t * delta_ref_find(const pos_cmd_server_t * p_server, uint16_t src, uint8_t tid)
+{
+    for (uint32_t i = 0; i < POS_CMD_SERVER_DELTA_REF_COUNT; ++i)
+    {
+        const pos_cmd_server_delta_ref_t * p_entry = &p_server->state.delta_refs[i];
+        if (p_entry->src == src && src != NRF_MESH_ADDR_UNASSIGNED)
+        {
+            return (p_entry->tid == tid) ? p_entry : NULL;
+        }
+    }
+    return NULL;
+}
+
+static bool present_changed(const pos_cmd_server_t * p_server, struct position_t present)
+{
+    struct position_t last = p_server->state.published;
+    int32_t dx = (int32_t) present.x - last.x;
+    int32_t dy = (int32_t) present.y - last.y;
+    int32_t deadband = (p_server->publish_config.deadband > 0) ? p_server->publish_config.deadband : 1;
+
+    return (dx >= deadband || -dx >= deadband || dy >= deadband || -dy >= deadband);
+}
+
+static void present_publish(pos_cmd_server_t * p_server, timestamp_t now)
+{
+    (void) pos_cmd_server_status_publish(p_server, p_server->state.present);
+    p_server->state.published = p_server->state.present;
+    p_server->state.published_once = true;
+    p_server->state.publish_pending = false;
+    p_server->state.publish_timestamp = now;
+
+    timer_sch_abort(&p_server->state.publish_timer);
+    if (p_server->publish_config.max_interval > 0)
+    {
+        p_server->state.publish_timer.timestamp = now + p_server->publish_config.max_interval;
+        timer_sch_schedule(&p_server->state.publish_timer);
+    }
+}
+
+static void trajectory_stop(pos_cmd_server_t * p_server)
+{
+    if (p_server->state.trajectory.active)
+    {
+        p_server->state.trajectory.active = false;
+        timer_sch_abort(&p_server->state.control_timer);
+    }
+}
+
+/** Present position to reply with, without calling into the application in deferred mode. */
+static struct position_t present_get(const pos_cmd_server_t * p_server)
+{
+    return p_server->deferred ? p_server->state.present : p_server->get_cb(p_server);
+}
+
+/** Hands a target to the application, or queues it in deferred mode. */
+static void target_apply(pos_cmd_server_t * p_server, struct position_t target)
+{
+    if (p_server->deferred)
+    {
+        p_server->state.queue.target = target;
+        p_server->state.queue.target_valid = true;
+    }
+    else
+    {
+        pos_cmd_server_present_update(p_server, p_server->set_cb(p_server, target));
+    }
+}
+
+/** Makes the application hold its position, and returns the present position. */
+static struct position_t stop_apply(const pos_cmd_server_t * p_server)
+{
+    return (p_server->stop_cb != NULL) ?
+           p_server->stop_cb(p_server) :
+           p_server->set_cb(p_server, p_server->get_cb(p_server));
+}
+
+static void control_timer_cb(timestamp_t timestamp, void * p_context)
+{
+    pos_cmd_server_t * p_server = p_context;
+    struct position_t setpoint;
+
+    if (!pos_cmd_trajectory_sample(&p_server->state.trajectory, timestamp, &setpoint))
+    {
+        timer_sch_abort(&p_server->state.control_timer);
+    }
+    target_apply(p_server, setpoint);
+}
+
+/** Schedules the timer for the earliest scheduled Set, if any. */
+static void schedule_timer_update(pos_cmd_server_t * p_server)
+{
+    const pos_cmd_server_scheduled_t * p_next = NULL;
+
+    for (uint32_t i = 0; i < POS_CMD_SERVER_SCHEDULE_SIZE; ++i)
+    {
+        const pos_cmd_server_scheduled_t * p_entry = &p_server->state.scheduled[i];
+        if (p_entry->active && (p_next == NULL || TIMER_OLDER_THAN(p_entry->timestamp, p_next->timestamp)))
+        {
+            p_next = p_entry;
+        }
+    }
+
+    timer_sch_abort(&p_server->state.schedule_timer);
+    if (p_next != NULL)
+    {
+        p_server->state.schedule_timer.timestamp = p_next->timestamp;
+        timer_sch_schedule(&p_server->state.schedule_timer);
+    }
+}
+
+/** Stores a Set until its execution time, replacing the one scheduled last if all entries are taken. */
+static void schedule_add(pos_cmd_server_t * p_server, struct position_t target, uint8_t tid, timestamp_t timestamp)
+{
+    pos_cmd_server_scheduled_t * p_slot = NULL;
+
+    for (uint32_t i = 0; i < POS_CMD_SERVER_SCHEDULE_SIZE; ++i)
+    {
+        pos_cmd_server_scheduled_t * p_entry = &p_server->state.scheduled[i];
+        if (!p_entry->active)
+        {
+            p_slot = p_entry;
+            break;
+        }
+        else if (p_slot == NULL || TIMER_OLDER_THAN(p_slot->timestamp, p_entry->timestamp))
+        {
+            p_slot = p_entry;
+        }
+    }
+
+    p_slot->active = true;
+    p_slot->tid = tid;
+    p_slot->target = target;
+    p_slot->timestamp = timestamp;
+    schedule_timer_update(p_server);
+}
+
+static void schedule_clear(pos_cmd_server_t * p_server)
+{
+    for (uint32_t i = 0; i < POS_CMD_SERVER_SCHEDULE_SIZE; ++i)
+    {
+        p_server->state.scheduled[i].active = false;
+    }
+    timer_sch_abort(&p_server->state.schedule_timer);
+}
+
+/** Applies every scheduled Set that is due, in order of execution time. */
+static void schedule_timer_cb(timestamp_t timestamp, void * p_context)
+{
+    pos_cmd_server_t * p_server = p_context;
+
+    for (;;)
+    {
+        pos_cmd_server_scheduled_t * p_due = NULL;
+        for (uint32_t i = 0; i < POS_CMD_SERVER_SCHEDULE_SIZE; ++i)
+        {
+            pos_cmd_server_scheduled_t * p_entry = &p_server->state.scheduled[i];
+            if (p_entry->active && !TIMER_OLDER_THAN(timestamp, p_entry->timestamp) &&
+                (p_due == NULL || TIMER_OLDER_THAN(p_entry->timestamp, p_due->timestamp)))
+            {
+                p_due = p_entry;
+            }
+        }
+
+        if (p_due == NULL)
+        {
+            break;
+        }
+
+        p_due->active = false;
+        p_server->state.tid = p_due->tid;
+        trajectory_stop(p_server);
+        target_apply(p_server, p_due->target);
+    }
+
+    schedule_timer_update(p_server);
+}
+
+/** Hands a list of targets to the application and reports the resulting present position. */
+static void targets_apply(pos_cmd_server_t * p_server, const struct position_t * p_targets, uint16_t count)
+{
+    if (p_server->set_batch_cb != NULL)
+    {
+        p_server->set_batch_cb(p_server, p_targets, count);
+    }
+    else
+    {
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            (void) p_server->set_cb(p_server, p_targets[i]);
+        }
+    }
+    pos_cmd_server_present_update(p_server, p_server->get_cb(p_server));
+}
+
+/** Hands a list of targets to the application, or queues the last one in deferred mode. */
+static void targets_dispatch(pos_cmd_server_t * p_server, const struct position_t * p_targets, uint16_t count)
+{
+    trajectory_stop(p_server);
+    if (p_server->deferred)
+    {
+        target_apply(p_server, p_targets[count - 1]);
+        return;
+    }
+    targets_apply(p_server, p_targets, count);
+}
+
+/** In deferred mode a completed path holds the reassembly buffer until it has been applied. */
+static bool path_held(const pos_cmd_server_t * p_server)
+{
+    return (p_server->state.queue.path_valid || p_server->state.queue.path_busy);
+}
+
+/** Replies to a Path Chunk with the chunks of the path received so far. */
+static void path_ack_send(pos_cmd_server_t * p_server, const access_message_rx_t * p_message)
+{
+    pos_cmd_msg_path_ack_t ack;
+    ack.tid = p_server->state.path.tid;
+    ack.received = 0;
+
+    uint16_t next = 0;
+    while (next <= p_server->state.path.last &&
+           (p_server->state.path.received[next / 32] & (1u << (next % 32))))
+    {
+        next++;
+    }
+    ack.next = (uint8_t) next;
+
+    for (uint16_t i = 0; i < 32 && next + 1 + i <= p_server->state.path.last; ++i)
+    {
+        uint16_t seq = next + 1 + i;
+        if (p_server->state.path.received[seq / 32] & (1u << (seq % 32)))
+        {
+            ack.received |= (1u << i);
+        }
+    }
+
+    access_message_tx_t reply;
+    reply.opcode.opcode = POS_CMD_OPCODE_PATH_ACK;
+    reply.opcode.company_id = POS_CMD_COMPANY_ID;
+    reply.p_buffer = (const uint8_t *) &ack;
+    reply.length = sizeof(ack);
+    reply.force_segmented = false;
+    reply.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    reply.access_token = nrf_mesh_unique_token_get();
+
+    pos_cmd_stats_opcode_count(p_server->state.stats.tx, POS_CMD_OPCODE_PATH_ACK);
+    uint32_t error_code = access_model_reply(p_server->model_handle, p_message, &reply);
+    POS_CMD_CAPTURE_TX(p_server->model_handle, p_message, &reply, error_code);
+    if (error_code != NRF_SUCCESS)
+    {
+        p_server->state.stats.publish_failures++;
+    }
+    POS_CMD_TRACE_TX(POS_CMD_OPCODE_PATH_ACK, ack.tid, reply.length, error_code);
+}
+
+/** Fires when a publication held back by the minimum interval is due, or the maximum interval expires. */
+static void publish_timer_cb(timestamp_t timestamp, void * p_context)
+{
+    present_publish(p_context, timestamp);
 }
 
 /*****************************************************************************
  * Opcode handler callbacks
  *****************************************************************************/
 
+static void handle_stop_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+    NRF_MESH_ASSERT(p_server->set_cb != NULL);
+
+    if (p_message->length != sizeof(pos_cmd_msg_stop_t))
+    {
+        return;
+    }
+
+    const pos_cmd_msg_stop_t * p_stop = (const pos_cmd_msg_stop_t *) p_message->p_data;
+    if (tid_is_duplicate(p_server, p_message, p_stop->tid))
+    {
+        /* A late copy must not stop a motion commanded after the Stop. */
+        reply_status(p_server, p_message, present_get(p_server), p_stop->tid);
+        return;
+    }
+
+    p_server->state.tid = p_stop->tid;
+    trajectory_stop(p_server);
+    schedule_clear(p_server);
+    /* Drop a path still being reassembled, it must not complete and move the server later. */
+    p_server->state.path.active = false;
+    if (p_server->deferred)
+    {
+        p_server->state.queue.stop = true;
+        p_server->state.queue.target_valid = false;
+        p_server->state.queue.path_valid = false;
+        reply_status(p_server, p_message, p_server->state.present, p_stop->tid);
+        return;
+    }
+
+    struct position_t present = stop_apply(p_server);
+    reply_status(p_server, p_message, present, p_stop->tid);
+    pos_cmd_server_present_update(p_server, present);
+}
+
 static void handle_set_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
 {
     pos_cmd_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
     NRF_MESH_ASSERT(p_server->set_cb != NULL);
 
-    uint8_t * value = ((pos_cmd_msg_set_t*) &p_message->p_data)->com_data;
-    uint16_t len = p_message->length;
-    value = p_server->set_cb(p_server, value, len);
-    reply_status(p_server, p_message, value);
-    (void) pos_cmd_server_status_publish(p_server, value); /* We don't care about status */
+    if (p_message->length != sizeof(pos_cmd_msg_set_t))
+    {
+        return;
+    }
+
+    const pos_cmd_msg_set_t * p_set = (const pos_cmd_msg_set_t *) p_message->p_data;
+    if (tid_is_duplicate(p_server, p_message, p_set->tid))
+    {
+        /* The client retransmits until it hears a reply, so answer without applying the Set again. */
+        reply_status(p_server, p_message, present_get(p_server), p_set->tid);
+        return;
+    }
+
+    p_server->state.tid = p_set->tid;
+    delta_ref_store(p_server, p_message->meta_data.src.value, p_set->tid, p_set->target);
+    trajectory_stop(p_server);
+    if (p_server->deferred)
+    {
+        target_apply(p_server, p_set->target);
+        reply_status(p_server, p_message, p_server->state.present, p_set->tid);
+        return;
+    }
+
+    struct position_t present = p_server->set_cb(p_server, p_set->target);
+    reply_status(p_server, p_message, present, p_set->tid);
+    pos_cmd_server_present_update(p_server, present);
+}
+
+static void handle_set_scheduled_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+    NRF_MESH_ASSERT(p_server->set_cb != NULL);
+
+    if (p_message->length != sizeof(pos_cmd_msg_set_scheduled_t))
+    {
+        return;
+    }
+
+    const pos_cmd_msg_set_scheduled_t * p_set = (const pos_cmd_msg_set_scheduled_t *) p_message->p_data;
+    if (tid_is_duplicate(p_server, p_message, p_set->tid))
+    {
+        reply_status(p_server, p_message, present_get(p_server), p_set->tid);
+        return;
+    }
+
+    bool absolute = (p_set->flags & POS_CMD_SCHEDULED_FLAG_ABSOLUTE);
+    if (absolute && p_server->time_base_cb == NULL)
+    {
+        /* Refuse it with the present position right away, so the client does not retransmit
+         * until the transaction times out. */
+        reply_status(p_server, p_message, present_get(p_server), p_set->tid);
+        return;
+    }
+
+    uint32_t delay_ms = p_set->time_ms;
+    if (absolute)
+    {
+        /* Times in the past are late copies, they are applied right away. */
+        int16_t ahead = (int16_t) (p_set->time_ms - (uint16_t) p_server->time_base_cb(p_server));
+        delay_ms = (ahead > 0) ? (uint32_t) ahead : 0;
+    }
+
+    schedule_add(p_server, p_set->target, p_set->tid, timer_now() + MS_TO_US(delay_ms));
+    reply_status(p_server, p_message, present_get(p_server), p_set->tid);
 }
 
 static void handle_get_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
 {
     pos_cmd_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
     NRF_MESH_ASSERT(p_server->get_cb != NULL);
-    reply_status(p_server, p_message, p_server->get_cb(p_server));
+
+    if (p_message->length != sizeof(pos_cmd_msg_get_t))
+    {
+        return;
+    }
+
+    const pos_cmd_msg_get_t * p_get = (const pos_cmd_msg_get_t *) p_message->p_data;
+    POS_CMD_TRACE_RX(p_message->opcode.opcode, p_get->tid, p_message->length);
+    reply_status(p_server, p_message, present_get(p_server), p_get->tid);
 }
 
 static void handle_set_unreliable_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
 {
     pos_cmd_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+    NRF_MESH_ASSERT(p_server->set_cb != NULL);
+
+    if (p_message->length != sizeof(pos_cmd_msg_set_unreliable_t))
+    {
+        return;
+    }
+
+    const pos_cmd_msg_set_unreliable_t * p_set = (const pos_cmd_msg_set_unreliable_t *) p_message->p_data;
+    if (tid_is_duplicate(p_server, p_message, p_set->tid))
+    {
+        return;
+    }
+
+    p_server->state.tid = p_set->tid;
+    trajectory_stop(p_server);
+    target_apply(p_server, p_set->target);
+}
+
+static void handle_set_batch_unreliable_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
     NRF_MESH_ASSERT(p_server->set_cb != NULL);
 
-    uint8_t * data = p_message->p_data;
-    uint16_t len = p_message->length;
-    p_server->set_cb(p_server, data, len);
-    /* Don't care at the moment */
-    //(void) pos_cmd_server_status_publish(p_server, value);
+    if (p_message->length <= sizeof(pos_cmd_msg_set_batch_t) ||
+        (p_message->length - sizeof(pos_cmd_msg_set_batch_t)) % sizeof(struct position_t) != 0)
+    {
+        return;
+    }
+
+    const pos_cmd_msg_set_batch_t * p_batch = (const pos_cmd_msg_set_batch_t *) p_message->p_data;
+    if (tid_is_duplicate(p_server, p_message, p_batch->tid))
+    {
+        return;
+    }
+
+    uint16_t count = (p_message->length - sizeof(pos_cmd_msg_set_batch_t)) / sizeof(struct position_t);
+    p_server->state.tid = p_batch->tid;
+    targets_dispatch(p_server, p_batch->targets, count);
+}
+
+static void handle_set_delta_unreliable_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+    NRF_MESH_ASSERT(p_server->set_cb != NULL);
+
+    if (p_message->length <= sizeof(pos_cmd_msg_set_delta_t) ||
+        (p_message->length - sizeof(pos_cmd_msg_set_delta_t)) % sizeof(pos_cmd_delta_t) != 0 ||
+        (p_message->length - sizeof(pos_cmd_msg_set_delta_t)) / sizeof(pos_cmd_delta_t) > POS_CMD_BATCH_POSITIONS_MAX)
+    {
+        return;
+    }
+
+    const pos_cmd_msg_set_delta_t * p_delta = (const pos_cmd_msg_set_delta_t *) p_message->p_data;
+    const pos_cmd_server_delta_ref_t * p_ref = delta_ref_find(p_server, p_message->meta_data.src.value,
+                                                              p_delta->ref_tid);
+    if (p_delta->shift > POS_CMD_CODEC_SHIFT_MAX ||
+        p_ref == NULL ||
+        tid_is_duplicate(p_server, p_message, p_delta->tid))
+    {
+        /* Without the client's reference the targets can't be reconstructed. The client is not told,
+         * its deltas are dropped until its next keyframe, at most
+         * POS_CMD_CLIENT_DELTA_KEYFRAME_INTERVAL messages later. */
+        return;
+    }
+
+    uint16_t count = (p_message->length - sizeof(pos_cmd_msg_set_delta_t)) / sizeof(pos_cmd_delta_t);
+    struct position_t targets[POS_CMD_BATCH_POSITIONS_MAX];
+    pos_cmd_codec_delta_decode(&p_ref->position, p_delta->deltas, count, p_delta->shift, targets);
+
+    p_server->state.tid = p_delta->tid;
+    targets_dispatch(p_server, targets, count);
+}
+
+static void handle_trajectory_unreliable_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+    NRF_MESH_ASSERT(p_server->set_cb != NULL);
+
+    if (p_message->length <= sizeof(pos_cmd_msg_trajectory_t) ||
+        (p_message->length - sizeof(pos_cmd_msg_trajectory_t)) % sizeof(struct position_t) != 0 ||
+        (p_message->length - sizeof(pos_cmd_msg_trajectory_t)) / sizeof(struct position_t) > POS_CMD_TRAJECTORY_WAYPOINTS_MAX)
+    {
+        return;
+    }
+
+    const pos_cmd_msg_trajectory_t * p_trajectory = (const pos_cmd_msg_trajectory_t *) p_message->p_data;
+    if (tid_is_duplicate(p_server, p_message, p_trajectory->tid))
+    {
+        return;
+    }
+
+    uint8_t count = (p_message->length - sizeof(pos_cmd_msg_trajectory_t)) / sizeof(struct position_t);
+    timestamp_t now = timer_now();
+    p_server->state.tid = p_trajectory->tid;
+
+    trajectory_stop(p_server);
+    pos_cmd_trajectory_start(&p_server->state.trajectory,
+                             present_get(p_server),
+                             p_trajectory->waypoints,
+                             count,
+                             MS_TO_US((uint32_t) p_trajectory->leg_time_ms),
+                             now);
+
+    p_server->state.control_timer.timestamp = now + POS_CMD_SERVER_CONTROL_INTERVAL;
+    p_server->state.control_timer.interval = POS_CMD_SERVER_CONTROL_INTERVAL;
+    timer_sch_schedule(&p_server->state.control_timer);
+}
+
+static void handle_path_chunk_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+    NRF_MESH_ASSERT(p_server->set_cb != NULL);
+
+    if (p_message->length <= sizeof(pos_cmd_msg_path_chunk_t) ||
+        (p_message->length - sizeof(pos_cmd_msg_path_chunk_t)) % sizeof(struct position_t) != 0)
+    {
+        return;
+    }
+
+    const pos_cmd_msg_path_chunk_t * p_chunk = (const pos_cmd_msg_path_chunk_t *) p_message->p_data;
+    uint16_t count = (p_message->length - sizeof(pos_cmd_msg_path_chunk_t)) / sizeof(struct position_t);
+    uint16_t offset = p_chunk->seq * POS_CMD_PATH_CHUNK_POINTS;
+    if (p_chunk->seq > p_chunk->last ||
+        p_chunk->last >= POS_CMD_PATH_CHUNKS_MAX ||
+        count > POS_CMD_PATH_CHUNK_POINTS ||
+        (p_chunk->seq != p_chunk->last && count != POS_CMD_PATH_CHUNK_POINTS) ||
+        offset + count > POS_CMD_PATH_POINTS_MAX)
+    {
+        return;
+    }
+
+    POS_CMD_TRACE_RX(p_message->opcode.opcode, p_chunk->tid, p_message->length);
+    uint16_t src = p_message->meta_data.src.value;
+    if (!p_server->state.path.active ||
+        p_server->state.path.src != src ||
+        p_server->state.path.tid != p_chunk->tid)
+    {
+        if (path_held(p_server))
+        {
+            /* Leave it unacknowledged, the client retries until the queued path has been applied. */
+            return;
+        }
+
+        /* A new path replaces the one being reassembled. */
+        p_server->state.path.active = true;
+        p_server->state.path.src = src;
+        p_server->state.path.tid = p_chunk->tid;
+        p_server->state.path.last = p_chunk->last;
+        p_server->state.path.chunks = 0;
+        p_server->state.path.count = 0;
+        memset(p_server->state.path.received, 0, sizeof(p_server->state.path.received));
+    }
+    else if (p_chunk->last != p_server->state.path.last)
+    {
+        return;
+    }
+
+    uint32_t bit = (1u << (p_chunk->seq % 32));
+    bool completed = false;
+    if (!(p_server->state.path.received[p_chunk->seq / 32] & bit))
+    {
+        p_server->state.path.received[p_chunk->seq / 32] |= bit;
+        memcpy(&p_server->state.path.points[offset], p_chunk->points, count * sizeof(struct position_t));
+        if (p_chunk->seq == p_chunk->last)
+        {
+            p_server->state.path.count = offset + count;
+        }
+        p_server->state.path.chunks++;
+        completed = (p_server->state.path.chunks == p_server->state.path.last + 1);
+    }
+    else
+    {
+        p_server->state.stats.duplicates++;
+    }
+
+    /* Acknowledge before the application gets the path, the client is waiting for it. */
+    if (completed || (p_chunk->flags & POS_CMD_PATH_FLAG_ACK_REQUEST))
+    {
+        path_ack_send(p_server, p_message);
+    }
+
+    if (completed)
+    {
+        p_server->state.tid = p_chunk->tid;
+        trajectory_stop(p_server);
+        if (p_server->deferred)
+        {
+            /* The path replaces any target not yet applied, and is applied whole. */
+            p_server->state.queue.target_valid = false;
+            p_server->state.queue.path_valid = true;
+        }
+        else
+        {
+            targets_apply(p_server, p_server->state.path.points, p_server->state.path.count);
+        }
+    }
+}
+
+static void handle_stats_get_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    pos_cmd_server_t * p_server = p_args;
+    pos_cmd_stats_opcode_count(p_server->state.stats.rx, p_message->opcode.opcode);
+    POS_CMD_CAPTURE_RX(p_message);
+
+    if (p_message->length != sizeof(pos_cmd_msg_stats_get_t))
+    {
+        return;
+    }
+
+    /* Count the reply before taking the snapshot, so the numbers are consistent with what was sent. */
+    pos_cmd_stats_opcode_count(p_server->state.stats.tx, POS_CMD_OPCODE_STATS_STATUS);
+
+    pos_cmd_msg_stats_status_t status;
+    status.tid = ((const pos_cmd_msg_stats_get_t *) p_message->p_data)->tid;
+    POS_CMD_TRACE_RX(p_message->opcode.opcode, status.tid, p_message->length);
+    status.stats = p_server->state.stats;
+
+    access_message_tx_t reply;
+    reply.opcode.opcode = POS_CMD_OPCODE_STATS_STATUS;
+    reply.opcode.company_id = POS_CMD_COMPANY_ID;
+    reply.p_buffer = (const uint8_t *) &status;
+    reply.length = sizeof(status);
+    reply.force_segmented = false;
+    reply.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    reply.access_token = nrf_mesh_unique_token_get();
+
+    uint32_t error_code = access_model_reply(p_server->model_handle, p_message, &reply);
+    POS_CMD_CAPTURE_TX(p_server->model_handle, p_message, &reply, error_code);
+    if (error_code != NRF_SUCCESS)
+    {
+        p_server->state.stats.publish_failures++;
+    }
+    POS_CMD_TRACE_TX(POS_CMD_OPCODE_STATS_STATUS, status.tid, reply.length, error_code);
 }
 
 static const access_opcode_handler_t m_opcode_handlers[] =
 {
+    /* Stop first, it is the most time critical opcode to look up. */
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_STOP,           POS_CMD_COMPANY_ID), handle_stop_cb},
     {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_SET,            POS_CMD_COMPANY_ID), handle_set_cb},
     {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_GET,            POS_CMD_COMPANY_ID), handle_get_cb},
-    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_SET_UNRELIABLE, POS_CMD_COMPANY_ID), handle_set_unreliable_cb}
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_SET_SCHEDULED,  POS_CMD_COMPANY_ID), handle_set_scheduled_cb},
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_SET_UNRELIABLE, POS_CMD_COMPANY_ID), handle_set_unreliable_cb},
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_SET_BATCH_UNRELIABLE, POS_CMD_COMPANY_ID), handle_set_batch_unreliable_cb},
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_SET_DELTA_UNRELIABLE, POS_CMD_COMPANY_ID), handle_set_delta_unreliable_cb},
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_TRAJECTORY_UNRELIABLE, POS_CMD_COMPANY_ID), handle_trajectory_unreliable_cb},
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_PATH_CHUNK,           POS_CMD_COMPANY_ID), handle_path_chunk_cb},
+    {ACCESS_OPCODE_VENDOR(POS_CMD_OPCODE_STATS_GET,            POS_CMD_COMPANY_ID), handle_stats_get_cb}
 };
 
 /*****************************************************************************
@@ -99,6 +772,14 @@ uint32_t pos_cmd_server_init(pos_cmd_server_t * p_server, uint16_t element_index
         return NRF_ERROR_NULL;
     }
 
+    memset(&p_server->state, 0, sizeof(p_server->state));
+    p_server->state.publish_timer.cb = publish_timer_cb;
+    p_server->state.publish_timer.p_context = p_server;
+    p_server->state.control_timer.cb = control_timer_cb;
+    p_server->state.control_timer.p_context = p_server;
+    p_server->state.schedule_timer.cb = schedule_timer_cb;
+    p_server->state.schedule_timer.p_context = p_server;
+
     access_model_add_params_t init_params;
     init_params.element_index =  element_index;
     init_params.model_id.model_id = POS_CMD_SERVER_MODEL_ID;
@@ -118,10 +799,16 @@ uint32_t pos_cmd_server_init(pos_cmd_server_t * p_server, uint16_t element_index
 
 }
 
-uint32_t pos_cmd_server_status_publish(pos_cmd_server_t * p_server, uint8_t * value)
+uint32_t pos_cmd_server_status_publish(pos_cmd_server_t * p_server, struct position_t present)
 {
+    if (p_server == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
     pos_cmd_msg_status_t status;
-    status.present_state = value;
+    status.present = present;
+    status.tid = p_server->state.tid;
     access_message_tx_t msg;
     msg.opcode.opcode = POS_CMD_OPCODE_STATUS;
     msg.opcode.company_id = POS_CMD_COMPANY_ID;
@@ -130,5 +817,115 @@ uint32_t pos_cmd_server_status_publish(pos_cmd_server_t * p_server, uint8_t * va
     msg.force_segmented = false;
     msg.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
     msg.access_token = nrf_mesh_unique_token_get();
-    return access_model_publish(p_server->model_handle, &msg);
+
+    pos_cmd_stats_opcode_count(p_server->state.stats.tx, POS_CMD_OPCODE_STATUS);
+    uint32_t error_code = access_model_publish(p_server->model_handle, &msg);
+    POS_CMD_CAPTURE_TX(p_server->model_handle, NULL, &msg, error_code);
+    if (error_code != NRF_SUCCESS)
+    {
+        p_server->state.stats.publish_failures++;
+    }
+    POS_CMD_TRACE_TX(POS_CMD_OPCODE_STATUS, status.tid, msg.length, error_code);
+    return error_code;
+}
+
+void pos_cmd_server_present_update(pos_cmd_server_t * p_server, struct position_t present)
+{
+    p_server->state.present = present;
+    if (p_server->state.published_once && !present_changed(p_server, present))
+    {
+        return;
+    }
+
+    timestamp_t now = timer_now();
+    if (!p_server->state.published_once ||
+        TIMER_DIFF(now, p_server->state.publish_timestamp) >= p_server->publish_config.min_interval)
+    {
+        present_publish(p_server, now);
+    }
+    else if (!p_server->state.publish_pending)
+    {
+        /* Publish the latest present position once the minimum interval has passed. */
+        p_server->state.publish_pending = true;
+        timer_sch_abort(&p_server->state.publish_timer);
+        p_server->state.publish_timer.timestamp = p_server->state.publish_timestamp + p_server->publish_config.min_interval;
+        timer_sch_schedule(&p_server->state.publish_timer);
+    }
+}
+
+bool pos_cmd_server_tid_is_duplicate(pos_cmd_server_tid_entry_t * p_cache,
+                                     uint8_t * p_next,
+                                     pos_cmd_stats_t * p_stats,
+                                     const access_message_rx_t * p_message,
+                                     uint8_t tid)
+{
+    uint16_t src = p_message->meta_data.src.value;
+    POS_CMD_TRACE_RX(p_message->opcode.opcode, tid, p_message->length);
+
+    timestamp_t now = timer_now();
+
+    for (uint32_t i = 0; i < POS_CMD_SERVER_TID_CACHE_SIZE; ++i)
+    {
+        const pos_cmd_server_tid_entry_t * p_entry = &p_cache[i];
+        if (p_entry->src == src &&
+            p_entry->tid == tid &&
+            TIMER_DIFF(now, p_entry->timestamp) < POS_CMD_SERVER_TID_CACHE_WINDOW)
+        {
+            p_stats->duplicates++;
+            POS_CMD_TRACE_EVENT(p_message->opcode.opcode, tid, p_message->length, POS_CMD_TRACE_STATUS_DUPLICATE);
+            return true;
+        }
+    }
+
+    pos_cmd_server_tid_entry_t * p_entry = &p_cache[*p_next];
+    p_entry->src = src;
+    p_entry->tid = tid;
+    p_entry->timestamp = now;
+    *p_next = (*p_next + 1) % POS_CMD_SERVER_TID_CACHE_SIZE;
+    return false;
+}
+
+const pos_cmd_stats_t * pos_cmd_server_stats_get(const pos_cmd_server_t * p_server)
+{
+    return &p_server->state.stats;
+}
+
+void pos_cmd_server_stats_reset(pos_cmd_server_t * p_server)
+{
+    memset(&p_server->state.stats, 0, sizeof(p_server->state.stats));
+}
+
+bool pos_cmd_server_process(pos_cmd_server_t * p_server)
+{
+    /* The opcode handlers preempt the main loop, take the queue in one go. */
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    bool stop = p_server->state.queue.stop;
+    bool path_valid = p_server->state.queue.path_valid;
+    bool target_valid = p_server->state.queue.target_valid;
+    struct position_t target = p_server->state.queue.target;
+    p_server->state.queue.stop = false;
+    p_server->state.queue.path_valid = false;
+    /* Keep new paths out of the reassembly buffer until the application is done with it. */
+    p_server->state.queue.path_busy = path_valid;
+    p_server->state.queue.target_valid = false;
+    _ENABLE_IRQS(was_masked);
+
+    if (stop)
+    {
+        pos_cmd_server_present_update(p_server, stop_apply(p_server));
+    }
+
+    if (path_valid)
+    {
+        targets_apply(p_server, p_server->state.path.points, p_server->state.path.count);
+        __atomic_store_n(&p_server->state.queue.path_busy, false, __ATOMIC_RELEASE);
+    }
+
+    if (target_valid)
+    {
+        pos_cmd_server_present_update(p_server, p_server->set_cb(p_server, target));
+    }
+
+    return (stop || path_valid || target_valid);
 }
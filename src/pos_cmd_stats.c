@@ -0,0 +1,21 @@
+#include "pos_cmd_stats.h"
+
+#include <stdint.h>
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void pos_cmd_stats_rtt_record(pos_cmd_stats_t * p_stats, uint32_t rtt_us)
+{
+    uint32_t rtt_ms = rtt_us / 1000;
+    uint32_t bound = POS_CMD_STATS_RTT_BUCKET_FIRST_MS;
+    uint32_t bucket = 0;
+
+    while (bucket < POS_CMD_STATS_RTT_BUCKETS - 1 && rtt_ms >= bound)
+    {
+        bound *= 2;
+        bucket++;
+    }
+    p_stats->rtt[bucket]++;
+}
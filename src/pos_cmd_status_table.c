@@ -0,0 +1,181 @@
+#include "pos_cmd_status_table.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "nrf_mesh.h"
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+/**
+ * Finds the bucket holding an address, or the empty bucket where it would be inserted.
+ * Returns NULL if the address is absent and the table is full.
+ */
+static pos_cmd_status_entry_t * bucket_get(const pos_cmd_status_table_t * p_table, uint16_t address)
+{
+    uint32_t index = address & (POS_CMD_STATUS_TABLE_SIZE - 1);
+
+    for (uint32_t i = 0; i < POS_CMD_STATUS_TABLE_SIZE; ++i)
+    {
+        const pos_cmd_status_entry_t * p_entry = &p_table->entries[index];
+        if (p_entry->address == address || p_entry->address == NRF_MESH_ADDR_UNASSIGNED)
+        {
+            return (pos_cmd_status_entry_t *) p_entry;
+        }
+        index = (index + 1) & (POS_CMD_STATUS_TABLE_SIZE - 1);
+    }
+    return NULL;
+}
+
+static int16_t coordinate_saturate(int64_t value)
+{
+    if (value > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    else if (value < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    return (int16_t) value;
+}
+
+/** Checks whether a server has applied a Set, or is at its target already. */
+static bool entry_caught_up(const pos_cmd_status_entry_t * p_entry, uint8_t tid, const struct position_t * p_target)
+{
+    if (!p_entry->reported)
+    {
+        return false;
+    }
+
+    /* The server reports the newest Set it applied, which may be past the one checked. */
+    if (p_entry->set_confirmed && (int8_t) (p_entry->set_tid - tid) >= 0)
+    {
+        return true;
+    }
+
+    return (p_target != NULL && p_entry->present.x == p_target->x && p_entry->present.y == p_target->y);
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void pos_cmd_status_table_clear(pos_cmd_status_table_t * p_table)
+{
+    memset(p_table, 0, sizeof(*p_table));
+}
+
+pos_cmd_status_entry_t * pos_cmd_status_table_add(pos_cmd_status_table_t * p_table, uint16_t address)
+{
+    NRF_MESH_ASSERT(address != NRF_MESH_ADDR_UNASSIGNED);
+
+    pos_cmd_status_entry_t * p_entry = bucket_get(p_table, address);
+    if (p_entry != NULL && p_entry->address == NRF_MESH_ADDR_UNASSIGNED)
+    {
+        memset(p_entry, 0, sizeof(*p_entry));
+        p_entry->address = address;
+        p_table->count++;
+    }
+    return p_entry;
+}
+
+pos_cmd_status_entry_t * pos_cmd_status_table_find(const pos_cmd_status_table_t * p_table, uint16_t address)
+{
+    if (address == NRF_MESH_ADDR_UNASSIGNED)
+    {
+        return NULL;
+    }
+
+    pos_cmd_status_entry_t * p_entry = bucket_get(p_table, address);
+    if (p_entry != NULL && p_entry->address == address)
+    {
+        return p_entry;
+    }
+    return NULL;
+}
+
+void pos_cmd_status_table_report(pos_cmd_status_entry_t * p_entry,
+                                 uint8_t tid,
+                                 struct position_t present,
+                                 timestamp_t timestamp)
+{
+    if (!p_entry->reported)
+    {
+        p_entry->velocity_x = 0;
+        p_entry->velocity_y = 0;
+    }
+    else
+    {
+        uint32_t interval = TIMER_DIFF(timestamp, p_entry->timestamp);
+        if (interval >= POS_CMD_STATUS_TABLE_VELOCITY_MIN_INTERVAL)
+        {
+            p_entry->velocity_x = (int32_t) (((int64_t) present.x - p_entry->present.x) * SEC_TO_US(1) / interval);
+            p_entry->velocity_y = (int32_t) (((int64_t) present.y - p_entry->present.y) * SEC_TO_US(1) / interval);
+        }
+    }
+
+    p_entry->reported = true;
+    p_entry->tid = tid;
+    p_entry->present = present;
+    p_entry->timestamp = timestamp;
+}
+
+void pos_cmd_status_table_set_confirm(pos_cmd_status_entry_t * p_entry, uint8_t tid)
+{
+    /* A late copy of an older confirmation does not undo a newer one. */
+    if (!p_entry->set_confirmed || (int8_t) (tid - p_entry->set_tid) > 0)
+    {
+        p_entry->set_confirmed = true;
+        p_entry->set_tid = tid;
+    }
+}
+
+struct position_t pos_cmd_status_table_predict(const pos_cmd_status_entry_t * p_entry, timestamp_t timestamp)
+{
+    NRF_MESH_ASSERT(p_entry->reported);
+
+    int64_t elapsed = TIMER_DIFF(timestamp, p_entry->timestamp);
+    struct position_t position;
+    position.x = coordinate_saturate(p_entry->present.x + (int64_t) p_entry->velocity_x * elapsed / SEC_TO_US(1));
+    position.y = coordinate_saturate(p_entry->present.y + (int64_t) p_entry->velocity_y * elapsed / SEC_TO_US(1));
+    return position;
+}
+
+void pos_cmd_status_table_foreach(const pos_cmd_status_table_t * p_table, pos_cmd_status_table_cb_t cb, void * p_context)
+{
+    for (uint32_t i = 0; i < POS_CMD_STATUS_TABLE_SIZE; ++i)
+    {
+        if (p_table->entries[i].address != NRF_MESH_ADDR_UNASSIGNED)
+        {
+            cb(&p_table->entries[i], p_context);
+        }
+    }
+}
+
+uint16_t pos_cmd_status_table_stragglers_get(const pos_cmd_status_table_t * p_table,
+                                             uint8_t tid,
+                                             const struct position_t * p_target,
+                                             uint16_t * p_addresses,
+                                             uint16_t max)
+{
+    uint16_t count = 0;
+
+    for (uint32_t i = 0; i < POS_CMD_STATUS_TABLE_SIZE; ++i)
+    {
+        const pos_cmd_status_entry_t * p_entry = &p_table->entries[i];
+        if (p_entry->address != NRF_MESH_ADDR_UNASSIGNED && !entry_caught_up(p_entry, tid, p_target))
+        {
+            if (count < max)
+            {
+                p_addresses[count] = p_entry->address;
+            }
+            count++;
+        }
+    }
+    return count;
+}
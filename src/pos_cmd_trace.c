@@ -0,0 +1,85 @@
+#include "pos_cmd_trace.h"
+
+#if POS_CMD_TRACE_LEVEL > POS_CMD_TRACE_LEVEL_NONE
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "timer.h"
+#include "log.h"
+#include "toolchain.h"
+
+/*****************************************************************************
+ * Static variables
+ *****************************************************************************/
+
+static pos_cmd_trace_record_t m_records[POS_CMD_TRACE_BUFFER_SIZE];
+/** Number of records written, only modified by the producers with interrupts masked. */
+static uint32_t m_head;
+/** Number of records read, only modified by the consumer. */
+static uint32_t m_tail;
+/** Number of records dropped, only modified by the producers with interrupts masked. */
+static uint32_t m_dropped;
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void pos_cmd_trace_record(uint8_t opcode, uint8_t tid, uint16_t length, uint32_t status)
+{
+    /* Records come from API calls, timers and opcode handlers, which may preempt each other. Claim
+     * and fill the slot in one go, the record is only a few stores. */
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+
+    uint32_t head = m_head;
+    if (head - __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE) == POS_CMD_TRACE_BUFFER_SIZE)
+    {
+        __atomic_store_n(&m_dropped, m_dropped + 1, __ATOMIC_RELAXED);
+        _ENABLE_IRQS(was_masked);
+        return;
+    }
+
+    pos_cmd_trace_record_t * p_record = &m_records[head & (POS_CMD_TRACE_BUFFER_SIZE - 1)];
+    p_record->timestamp = timer_now();
+    p_record->opcode = opcode;
+    p_record->tid = tid;
+    p_record->length = (length > UINT8_MAX) ? UINT8_MAX : (uint8_t) length;
+    p_record->status = (status > UINT8_MAX) ? UINT8_MAX : (uint8_t) status;
+
+    /* Publish the record only after it is completely written. */
+    __atomic_store_n(&m_head, head + 1, __ATOMIC_RELEASE);
+    _ENABLE_IRQS(was_masked);
+}
+
+bool pos_cmd_trace_read(pos_cmd_trace_record_t * p_record)
+{
+    uint32_t tail = m_tail;
+    if (tail == __atomic_load_n(&m_head, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+
+    *p_record = m_records[tail & (POS_CMD_TRACE_BUFFER_SIZE - 1)];
+
+    /* Hand the slot back only after the record is copied out. */
+    __atomic_store_n(&m_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t pos_cmd_trace_dropped_get(void)
+{
+    return __atomic_load_n(&m_dropped, __ATOMIC_RELAXED);
+}
+
+void pos_cmd_trace_flush(void)
+{
+    pos_cmd_trace_record_t record;
+    while (pos_cmd_trace_read(&record))
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "PosCmd %u: op 0x%02x tid %u len %u status 0x%02x\n",
+              record.timestamp, record.opcode, record.tid, record.length, record.status);
+    }
+}
+
+#endif /* POS_CMD_TRACE_LEVEL > POS_CMD_TRACE_LEVEL_NONE */
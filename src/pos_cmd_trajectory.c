@@ -0,0 +1,68 @@
+#include "pos_cmd_trajectory.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_mesh_assert.h"
+#include "timer.h"
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static int16_t interpolate(int16_t from, int16_t to, uint32_t elapsed, uint32_t duration)
+{
+    return (int16_t) (from + ((int64_t) (to - from) * elapsed) / duration);
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void pos_cmd_trajectory_start(pos_cmd_trajectory_t * p_trajectory,
+                              struct position_t start,
+                              const struct position_t * p_waypoints,
+                              uint8_t count,
+                              uint32_t leg_time,
+                              timestamp_t now)
+{
+    NRF_MESH_ASSERT(count > 0 && count <= POS_CMD_TRAJECTORY_WAYPOINTS_MAX);
+
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        p_trajectory->waypoints[i] = p_waypoints[i];
+    }
+    p_trajectory->count = count;
+    p_trajectory->index = 0;
+    p_trajectory->from = start;
+    p_trajectory->leg_start = now;
+    p_trajectory->leg_time = leg_time;
+    p_trajectory->active = true;
+}
+
+bool pos_cmd_trajectory_sample(pos_cmd_trajectory_t * p_trajectory,
+                               timestamp_t now,
+                               struct position_t * p_setpoint)
+{
+    NRF_MESH_ASSERT(p_trajectory->active);
+
+    while (TIMER_DIFF(now, p_trajectory->leg_start) >= p_trajectory->leg_time)
+    {
+        p_trajectory->from = p_trajectory->waypoints[p_trajectory->index];
+        p_trajectory->leg_start += p_trajectory->leg_time;
+        p_trajectory->index++;
+
+        if (p_trajectory->index == p_trajectory->count)
+        {
+            *p_setpoint = p_trajectory->from;
+            p_trajectory->active = false;
+            return false;
+        }
+    }
+
+    const struct position_t * p_to = &p_trajectory->waypoints[p_trajectory->index];
+    uint32_t elapsed = TIMER_DIFF(now, p_trajectory->leg_start);
+    p_setpoint->x = interpolate(p_trajectory->from.x, p_to->x, elapsed, p_trajectory->leg_time);
+    p_setpoint->y = interpolate(p_trajectory->from.y, p_to->y, elapsed, p_trajectory->leg_time);
+    return true;
+}
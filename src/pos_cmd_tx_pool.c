@@ -0,0 +1,61 @@
+#include "pos_cmd_tx_pool.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "nrf_mesh_assert.h"
+#include "toolchain.h"
+
+/*****************************************************************************
+ * Static variables
+ *****************************************************************************/
+
+static uint8_t m_buffers[POS_CMD_TX_POOL_SLOT_COUNT][POS_CMD_TX_POOL_SLOT_SIZE];
+/** Bit n is set while buffer n is allocated. Only modified with interrupts masked. */
+static uint32_t m_allocated;
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+uint8_t * pos_cmd_tx_pool_alloc(uint16_t length)
+{
+    if (length > POS_CMD_TX_POOL_SLOT_SIZE)
+    {
+        return NULL;
+    }
+
+    /* Clients may be driven from different interrupt contexts, test and set the bit in one go. */
+    uint8_t * p_buffer = NULL;
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    for (uint32_t i = 0; i < POS_CMD_TX_POOL_SLOT_COUNT; ++i)
+    {
+        if (!(m_allocated & (1u << i)))
+        {
+            m_allocated |= (1u << i);
+            p_buffer = m_buffers[i];
+            break;
+        }
+    }
+    _ENABLE_IRQS(was_masked);
+    return p_buffer;
+}
+
+void pos_cmd_tx_pool_release(uint8_t * p_buffer)
+{
+    uint32_t index = (uint32_t) (p_buffer - &m_buffers[0][0]) / POS_CMD_TX_POOL_SLOT_SIZE;
+    NRF_MESH_ASSERT(index < POS_CMD_TX_POOL_SLOT_COUNT && p_buffer == m_buffers[index]);
+
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    NRF_MESH_ASSERT(m_allocated & (1u << index));
+    m_allocated &= ~(1u << index);
+    _ENABLE_IRQS(was_masked);
+}
+
+uint32_t pos_cmd_tx_pool_available(void)
+{
+    uint32_t allocated = __atomic_load_n(&m_allocated, __ATOMIC_RELAXED);
+    return POS_CMD_TX_POOL_SLOT_COUNT - (uint32_t) __builtin_popcount(allocated);
+}